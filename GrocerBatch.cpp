@@ -0,0 +1,684 @@
+/**
+ * GrocerBatch.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Runs one Corner Grocer report from command-line arguments instead of the interactive menu, so
+ * reports can be scripted (e.g. from cron) over any number of purchase files. Nothing is read
+ * from cin and no menu is printed. Commands:
+ * - list           Print each item and its number of purchases, as menu option one.
+ * - count ITEM...  Print "ITEM<tab>COUNT" for each named item, one per line. An argument @FILE
+ *                  names every item listed in FILE, one per line, so hundreds of items can be
+ *                  counted in one run. Each input file is read once however many items are named.
+ * - chart OUT      Write a histogram of purchases to file OUT, as menu option three, or as CSV 
+ *                  or binary (see HistogramWriter.cpp). The chart is not printed.
+ * - top K          Print the K best-selling items, as menu option four. Counted in fixed memory
+ *                  by a TopKSketch of SetTopKCapacity() items, whichever engine is set.
+ *
+ * Inputs may be files, directories, or wildcards (see PurchaseAggregator::ExpandInputs()). With
+ * more than one input file, each file's report is preceded by a "== FILE ==" line, in stdout or 
+ * in the chart file. SetRollup(true) adds a last report of all the files' purchases together,
+ * headed "== rollup of N files ==". Errors are printed to cerr, and files that can't be read are
+ * skipped. Run() returns EXIT_OK, EXIT_FAILED if any file couldn't be read or written, or
+ * EXIT_USAGE if the command is malformed.
+ *
+ * Counting is done by a PurchaseAggregator, which counts several files at once, or by the 
+ * functions in PythonCode.py through a PyInterface if the native engine is off. The Python engine
+ * counts one file at a time, can only chart one file, can't roll files up, and also prints the 
+ * chart, as in the menu. With SetPyWorkerPool(), the Python engine's list and count commands 
+ * call the Python functions for all the files at once, in the pool's worker processes (see
+ * PyWorkerPool.cpp), and print each file's report in order. A file whose call fails in Python
+ * (e.g. the worker can't import PythonCode) is reported as such, and counts as a failure.
+ *
+ * SetPipeline(true) reads all the inputs at once through an IngestPipeline instead, one thread
+ * per input, and reports their purchases together as one report, headed by nothing. Inputs may
+ * then also be FIFOs, or - for standard input, e.g. to merge the live feeds of a store's lanes.
+ * It needs the native engine and replaces the rollup. With LatencyStats enabled, the pipeline's
+ * backpressure summary (see IngestPipeline::FormatStats()) is printed to cerr after the report.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "GrocerBatch.h"
+#include "LatencyStats.h"
+#include "LineScanner.h"
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Constructor. A PyInterface is only needed if the native engine will be turned off.
+ *
+ * @param pyInterface PyInterface* to the Python functions, or nullptr.
+ */
+GrocerBatch::GrocerBatch(PyInterface* pyInterface) {
+	m_pyInterface = pyInterface;
+	m_pyWorkerPool = nullptr;
+	m_useNativeEngine = true;
+	m_rollup = false;
+	m_usePipeline = false;
+	m_topKCapacity = TopKSketch::DEFAULT_CAPACITY;
+}
+
+/**
+ * Run one command over a list of inputs.
+ *
+ * @param inputs Purchase files to report on, in order. Directories and wildcards are expanded 
+ * by PurchaseAggregator::ExpandInputs().
+ * @param command Command name followed by its arguments, e.g. { "count", "Peas", "Onions" }.
+ *
+ * @return EXIT_OK on success, EXIT_FAILED if any file couldn't be read or written, EXIT_USAGE
+ * if the command is unknown or has the wrong arguments.
+ */
+int GrocerBatch::Run(const vector<string>& inputs, const vector<string>& command) {
+	if (inputs.empty() || command.empty()) {
+		cerr << "No input files or no command given." << endl;
+		return EXIT_USAGE;
+	}
+	if (!m_useNativeEngine && m_pyInterface == nullptr) {
+		cerr << "The Python engine isn't available." << endl;
+		return EXIT_FAILED;
+	}
+	if (!m_useNativeEngine && m_rollup) {
+		cerr << "Rollups need the native engine." << endl;
+		return EXIT_USAGE;
+	}
+	if (m_usePipeline && (!m_useNativeEngine || m_rollup)) {
+		cerr << "The pipeline needs the native engine, and already reports all inputs together."
+			 << endl;
+		return EXIT_USAGE;
+	}
+
+	vector<string> inputFileNames;
+	string unmatchedInput;
+	if (!PurchaseAggregator::ExpandInputs(inputs, inputFileNames, unmatchedInput)) {
+		cerr << "No files match " << unmatchedInput << "." << endl;
+		return EXIT_FAILED;
+	}
+
+	const string& commandName = command.at(0);
+	if (commandName == "list" && command.size() == 1) {
+		return RunList(inputFileNames);
+	}
+	if (commandName == "count" && command.size() > 1) {
+		vector<string> itemNames;
+		if (!ReadItemNames(vector<string>(command.begin() + 1, command.end()), itemNames)) {
+			return EXIT_FAILED;
+		}
+		if (itemNames.empty()) {
+			cerr << "No items to count." << endl;
+			return EXIT_USAGE;
+		}
+		return RunCount(inputFileNames, itemNames);
+	}
+	if (commandName == "chart" && command.size() == 2) {
+		if (!m_useNativeEngine && inputFileNames.size() > 1) {
+			cerr << "The Python engine can only chart one input file." << endl;
+			return EXIT_USAGE;
+		}
+		return RunChart(inputFileNames, command.at(1));
+	}
+	if (commandName == "top" && command.size() == 2) {
+		return RunTop(inputFileNames, command.at(1));
+	}
+
+	cerr << "Didn't recognize command " << commandName << " with " << command.size() - 1
+		 << " argument(s)." << endl;
+	return EXIT_USAGE;
+}
+
+/**
+ * Print each item in each input file and its number of purchases.
+ *
+ * @param inputFileNames Names of the purchase files.
+ *
+ * @return EXIT_OK, or EXIT_FAILED if any file couldn't be read.
+ */
+int GrocerBatch::RunList(const vector<string>& inputFileNames) {
+	bool sections = HasSections(inputFileNames);
+	bool allLoaded = true;
+
+	if (!m_useNativeEngine && m_pyWorkerPool != nullptr) {
+		vector<future<PyWorkerReply<int>>> replies;
+		for (const string& inputFileName : inputFileNames) {
+			replies.push_back(m_pyWorkerPool->Submit<int>("CountItems", inputFileName));
+		}
+		for (size_t i = 0; i < inputFileNames.size(); ++i) {
+			if (sections) {
+				cout << SectionHeader(inputFileNames[i]);
+			}
+			PyWorkerReply<int> reply = replies[i].get();
+			cout << reply.output;
+			if (!reply.succeeded) {
+				cerr << "Python couldn't list " << inputFileNames[i] << "." << endl;
+				allLoaded = false;
+			}
+			else if (reply.value < 0) {
+				cerr << "Couldn't open " << inputFileNames[i] << "." << endl;
+				allLoaded = false;
+			}
+		}
+		cout.flush();
+		return allLoaded ? EXIT_OK : EXIT_FAILED;
+	}
+	if (!m_useNativeEngine) {
+		for (const string& inputFileName : inputFileNames) {
+			if (sections) {
+				cout << SectionHeader(inputFileName);
+			}
+			cout.flush();
+			int result = m_pyInterface->Call<int>("CountItems", inputFileName);
+			m_pyInterface->FlushOutput();
+			if (result < 0) {
+				cerr << "Couldn't open " << inputFileName << "." << endl;
+				allLoaded = false;
+			}
+		}
+		return allLoaded ? EXIT_OK : EXIT_FAILED;
+	}
+
+	allLoaded = CountInputs(inputFileNames, 
+		[&](const string& inputFileName, const PurchaseIndex* index) {
+			if (sections) {
+				cout << SectionHeader(inputFileName);
+			}
+			if (index == nullptr) {
+				cerr << "Couldn't open " << inputFileName << "." << endl;
+				return;
+			}
+			cout << index->FormatItemCounts();
+		});
+	if (m_rollup) {
+		cout << SectionHeader(RollupTitle()) << m_aggregator.GetRollup().FormatItemCounts();
+	}
+	cout.flush();
+	return allLoaded ? EXIT_OK : EXIT_FAILED;
+}
+
+/**
+ * Print the number of purchases of each named item in each input file. All the items are counted
+ * with one lookup per item in the file's index, or one call to the Python function 
+ * CountManyItems per file if the native engine is off (in the worker pool, if one is set).
+ *
+ * @param inputFileNames Names of the purchase files.
+ * @param itemNames Names of the items to count, as read by ReadItemNames().
+ *
+ * @return EXIT_OK, or EXIT_FAILED if any file couldn't be read.
+ */
+int GrocerBatch::RunCount(const vector<string>& inputFileNames, const vector<string>& itemNames) {
+	bool sections = HasSections(inputFileNames);
+	bool allLoaded = true;
+
+	if (!m_useNativeEngine) {
+		// With a worker pool, every file is counted at once and the counts are printed in order.
+		vector<future<PyWorkerReply<vector<unsigned long long>>>> replies;
+		for (const string& inputFileName : inputFileNames) {
+			if (m_pyWorkerPool != nullptr) {
+				replies.push_back(m_pyWorkerPool->Submit<vector<unsigned long long>>(
+					"CountManyItems", inputFileName, itemNames));
+			}
+		}
+		for (size_t i = 0; i < inputFileNames.size(); ++i) {
+			const string& inputFileName = inputFileNames[i];
+			if (sections) {
+				cout << SectionHeader(inputFileName);
+			}
+			vector<unsigned long long> counts;
+			if (m_pyWorkerPool != nullptr) {
+				PyWorkerReply<vector<unsigned long long>> reply = replies[i].get();
+				if (!reply.succeeded) {
+					// E.g. the worker couldn't import the module; not a problem with the file.
+					cerr << "Python couldn't count " << inputFileName << "." << endl;
+					allLoaded = false;
+					continue;
+				}
+				counts = move(reply.value);
+			}
+			else {
+				counts = m_pyInterface->Call<vector<unsigned long long>>("CountManyItems",
+																		 inputFileName, itemNames);
+			}
+			if (counts.size() != itemNames.size()) {
+				cerr << "Couldn't open " << inputFileName << "." << endl;
+				allLoaded = false;
+				continue;
+			}
+			for (size_t item = 0; item < itemNames.size(); ++item) {
+				cout << itemNames[item] << '\t' << counts[item] << '\n';
+			}
+		}
+		cout.flush();
+		return allLoaded ? EXIT_OK : EXIT_FAILED;
+	}
+
+	auto printCounts = [&](const PurchaseIndex& index) {
+		vector<unsigned long long> counts = index.CountMany(itemNames);
+		for (size_t i = 0; i < itemNames.size(); ++i) {
+			cout << itemNames[i] << '\t' << counts[i] << '\n';
+		}
+	};
+	allLoaded = CountInputs(inputFileNames,
+		[&](const string& inputFileName, const PurchaseIndex* index) {
+			if (sections) {
+				cout << SectionHeader(inputFileName);
+			}
+			if (index == nullptr) {
+				cerr << "Couldn't open " << inputFileName << "." << endl;
+				return;
+			}
+			printCounts(*index);
+		});
+	if (m_rollup) {
+		cout << SectionHeader(RollupTitle());
+		printCounts(m_aggregator.GetRollup());
+	}
+	cout.flush();
+	return allLoaded ? EXIT_OK : EXIT_FAILED;
+}
+
+/**
+ * Write a histogram of the purchases in each input file to a file.
+ *
+ * @param inputFileNames Names of the purchase files. Only one with the Python engine.
+ * @param outputFileName Name of the file to write (or overwrite).
+ *
+ * @return EXIT_OK, or EXIT_FAILED if any file couldn't be read or the chart couldn't be written.
+ */
+int GrocerBatch::RunChart(const vector<string>& inputFileNames, const string& outputFileName) {
+	if (!m_useNativeEngine) {
+		cout.flush();
+		int result = m_pyInterface->Call<int>("ChartItems", inputFileNames.at(0), outputFileName);
+		m_pyInterface->FlushOutput();
+		if (result < 0) {
+			cerr << "Couldn't chart " << inputFileNames.at(0) << " to " << outputFileName << "."
+				 << endl;
+			return EXIT_FAILED;
+		}
+		return EXIT_OK;
+	}
+
+	// Build the whole chart before opening the output file, so a failed run doesn't leave it
+	// half written. Files that can't be read get an empty section.
+	PurchaseIndex noPurchases;
+	m_histogramWriter.Clear();
+	m_histogramWriter.SetSectionHeaders(HasSections(inputFileNames));
+	bool allLoaded = CountInputs(inputFileNames,
+		[&](const string& inputFileName, const PurchaseIndex* index) {
+			if (index == nullptr) {
+				cerr << "Couldn't open " << inputFileName << "." << endl;
+			}
+			m_histogramWriter.AddSection(inputFileName, index != nullptr ? *index : noPurchases);
+		});
+	if (m_rollup) {
+		m_histogramWriter.AddSection(RollupTitle(), m_aggregator.GetRollup());
+	}
+
+	if (!m_histogramWriter.WriteFile(outputFileName)) {
+		cerr << "Couldn't write to " << outputFileName << "." << endl;
+		return EXIT_FAILED;
+	}
+	return allLoaded ? EXIT_OK : EXIT_FAILED;
+}
+
+/**
+ * Print the best-selling items in each input file, highest count first. Each file is read once,
+ * in fixed memory; a rollup sketch is filled from the same read. With the pipeline, the sketch is
+ * filled from the pipeline's counts of all the inputs.
+ *
+ * @param inputFileNames Names of the purchase files.
+ * @param itemCount Number of items to print per file, as given on the command line.
+ *
+ * @return EXIT_OK, EXIT_FAILED if any file couldn't be read, or EXIT_USAGE if itemCount isn't a
+ * positive number.
+ */
+int GrocerBatch::RunTop(const vector<string>& inputFileNames, const string& itemCount) {
+	size_t topCount = 0;
+	try {
+		topCount = stoul(itemCount);
+	}
+	// stoul throws invalid_argument or out_of_range for anything but a reasonable number.
+	catch (logic_error& excpt) {
+		topCount = 0;
+	}
+	if (topCount == 0) {
+		cerr << "Didn't recognize number of items " << itemCount << "." << endl;
+		return EXIT_USAGE;
+	}
+
+	bool sections = HasSections(inputFileNames);
+	bool allLoaded = true;
+	TopKSketch fileItems(m_topKCapacity);
+	if (m_usePipeline) {
+		allLoaded = CountInputs(inputFileNames,
+			[&](const string& inputFileName, const PurchaseIndex* index) {
+				if (index == nullptr) {
+					cerr << "Couldn't open " << inputFileName << "." << endl;
+					return;
+				}
+				for (uint32_t id = 0; id < index->ItemCount(); ++id) {
+					fileItems.Add(index->ItemAt(id), index->CountAt(id));
+				}
+			});
+		cout << fileItems.FormatTopItems(topCount);
+		cout.flush();
+		return allLoaded ? EXIT_OK : EXIT_FAILED;
+	}
+
+	TopKSketch rollupItems(m_topKCapacity);
+	size_t rollupFileCount = 0;
+	for (const string& inputFileName : inputFileNames) {
+		if (sections) {
+			cout << SectionHeader(inputFileName);
+		}
+		fileItems.Clear();
+		if (!fileItems.AddFile(inputFileName, m_rollup ? &rollupItems : nullptr)) {
+			cerr << "Couldn't open " << inputFileName << "." << endl;
+			allLoaded = false;
+			continue;
+		}
+		++rollupFileCount;
+		cout << fileItems.FormatTopItems(topCount);
+	}
+	if (m_rollup) {
+		cout << SectionHeader("rollup of " + to_string(rollupFileCount) + " files") 
+			 << rollupItems.FormatTopItems(topCount);
+	}
+	cout.flush();
+	return allLoaded ? EXIT_OK : EXIT_FAILED;
+}
+
+/**
+ * Count the input files with the PurchaseAggregator, or all together through the pipeline if it
+ * is set. With the pipeline, onFile is called once per input that couldn't be read, then once
+ * with the counts of all the inputs, titled by PipelineTitle().
+ *
+ * @param inputFileNames Names of the purchase files (or, with the pipeline, FIFOs or -).
+ * @param onFile Called on this thread with each file's counts. See PurchaseAggregator.
+ *
+ * @return true if every input was read, false if any couldn't be.
+ */
+bool GrocerBatch::CountInputs(const vector<string>& inputFileNames,
+							  const PurchaseAggregator::FileCallback& onFile) {
+	if (!m_usePipeline) {
+		return m_aggregator.CountFiles(inputFileNames, onFile);
+	}
+
+	PurchaseIndex index;
+	bool allRead = m_pipeline.Run(inputFileNames, index);
+	for (const IngestPipeline::SourceStats& source : m_pipeline.GetStats().sources) {
+		if (!source.read) {
+			onFile(source.name, nullptr);
+		}
+	}
+	onFile(PipelineTitle(inputFileNames), &index);
+	if (LatencyStats::IsEnabled()) {
+		cerr << m_pipeline.FormatStats();
+	}
+	return allRead;
+}
+
+/**
+ * Read the item names given to the count command. Whitespace around each name is ignored. An
+ * argument starting with @ names a file listing one item per line; blank lines are skipped.
+ *
+ * @param arguments Arguments of the count command: item names and @FILE arguments.
+ * @param itemNames Receives the item names, in order.
+ *
+ * @return true, or false if a listed file couldn't be read.
+ */
+bool GrocerBatch::ReadItemNames(const vector<string>& arguments, vector<string>& itemNames) {
+	itemNames.clear();
+	for (const string& argument : arguments) {
+		if (argument.size() < 2 || argument.at(0) != '@') {
+			itemNames.push_back(string(LineScanner::Trim(argument)));
+			continue;
+		}
+
+		string listFileName = argument.substr(1);
+		ifstream listFS(listFileName);
+		if (!listFS.is_open()) {
+			cerr << "Couldn't open " << listFileName << "." << endl;
+			return false;
+		}
+		string line;
+		while (getline(listFS, line)) {
+			string_view item = LineScanner::Trim(line);
+			if (!item.empty()) {
+				itemNames.push_back(string(item));
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @param inputFileNames Names of the purchase files.
+ *
+ * @return true if each report needs a section header: more than one file, or a rollup, and not
+ * the pipeline's single report.
+ */
+bool GrocerBatch::HasSections(const vector<string>& inputFileNames) {
+	return (inputFileNames.size() > 1 || m_rollup) && !m_usePipeline;
+}
+
+/**
+ * @param title File name or other title of a report section.
+ *
+ * @return Header line for the section, "== title ==".
+ */
+string GrocerBatch::SectionHeader(const string& title) {
+	return "== " + title + " ==\n";
+}
+
+/**
+ * @return Title of the rollup section, naming how many files were rolled up.
+ */
+string GrocerBatch::RollupTitle() {
+	return "rollup of " + to_string(m_aggregator.GetRollupFileCount()) + " files";
+}
+
+/**
+ * @param inputFileNames Names of the inputs read through the pipeline.
+ *
+ * @return Title of the pipeline's report (e.g. the source of its rows in a CSV chart).
+ */
+string GrocerBatch::PipelineTitle(const vector<string>& inputFileNames) {
+	return "pipeline of " + to_string(inputFileNames.size()) + " sources";
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * Accessor for whether purchases are counted natively.
+ *
+ * @return true if counting is done by the native PurchaseIndex, false if by Python functions.
+ */
+bool GrocerBatch::GetNativeEngine() {
+	return m_useNativeEngine;
+}
+/**
+ * Mutator for whether purchases are counted natively.
+ *
+ * @param useNativeEngine true to count with PurchaseIndex, false to call the Python functions
+ * through the PyInterface given to the constructor.
+ */
+void GrocerBatch::SetNativeEngine(bool useNativeEngine) {
+	this->m_useNativeEngine = useNativeEngine;
+}
+
+/**
+ * Accessor for the pool of Python worker processes.
+ *
+ * @return Pool used by the Python engine's list and count commands, or nullptr.
+ */
+PyWorkerPool* GrocerBatch::GetPyWorkerPool() {
+	return m_pyWorkerPool;
+}
+/**
+ * Mutator for the pool of Python worker processes. Only used if the native engine is off.
+ *
+ * @param pyWorkerPool Pool to run the Python functions for list and count in, so files are 
+ * counted in parallel, or nullptr to call them one file at a time through the PyInterface.
+ */
+void GrocerBatch::SetPyWorkerPool(PyWorkerPool* pyWorkerPool) {
+	this->m_pyWorkerPool = pyWorkerPool;
+}
+
+/**
+ * Accessor for the maximum number of threads used to count a file.
+ *
+ * @return Thread count as set, 0 meaning one per hardware thread.
+ */
+unsigned int GrocerBatch::GetThreadCount() {
+	return m_aggregator.GetThreadCount();
+}
+/**
+ * Mutator for the maximum number of threads used to count a file. See PurchaseIndex.
+ *
+ * @param threadCount Maximum number of scan threads. 0 uses every hardware thread.
+ */
+void GrocerBatch::SetThreadCount(unsigned int threadCount) {
+	m_aggregator.SetThreadCount(threadCount);
+}
+
+/**
+ * Accessor for whether count snapshots are used.
+ *
+ * @return true if each file's counts are loaded from and saved to a snapshot next to it.
+ */
+bool GrocerBatch::GetUseSnapshots() {
+	return m_aggregator.GetUseSnapshots();
+}
+/**
+ * Mutator for whether count snapshots are used.
+ *
+ * @param useSnapshots true to load each file's counts from a valid snapshot next to it and to
+ * save one after each scan, false to always scan the input files.
+ */
+void GrocerBatch::SetUseSnapshots(bool useSnapshots) {
+	m_aggregator.SetUseSnapshots(useSnapshots);
+}
+
+/**
+ * Accessor for the number of files counted at once.
+ *
+ * @return Job count as set, 0 meaning one per hardware thread.
+ */
+unsigned int GrocerBatch::GetJobCount() {
+	return m_aggregator.GetJobCount();
+}
+/**
+ * Mutator for the number of files counted at once. See PurchaseAggregator.
+ *
+ * @param jobCount Maximum number of files counted at once. 0 uses one per hardware thread.
+ */
+void GrocerBatch::SetJobCount(unsigned int jobCount) {
+	m_aggregator.SetJobCount(jobCount);
+}
+
+/**
+ * Accessor for whether a rollup of all input files is reported.
+ *
+ * @return true if the files' purchases are also reported together after the per-file reports.
+ */
+bool GrocerBatch::GetRollup() {
+	return m_rollup;
+}
+/**
+ * Mutator for whether a rollup of all input files is reported. Needs the native engine.
+ *
+ * @param rollup true to also report all the files' purchases together, after the per-file 
+ * reports.
+ */
+void GrocerBatch::SetRollup(bool rollup) {
+	this->m_rollup = rollup;
+}
+
+/**
+ * Accessor for the number of items the best-sellers sketch monitors.
+ *
+ * @return Capacity used for the top command.
+ */
+size_t GrocerBatch::GetTopKCapacity() {
+	return m_topKCapacity;
+}
+/**
+ * Mutator for the number of items the best-sellers sketch monitors. See TopKSketch.
+ *
+ * @param capacity Number of items monitored for the top command.
+ */
+void GrocerBatch::SetTopKCapacity(size_t capacity) {
+	this->m_topKCapacity = capacity;
+}
+
+/**
+ * Accessor for the format of charts written by the chart command.
+ *
+ * @return Chart format.
+ */
+HistogramWriter::Format GrocerBatch::GetChartFormat() {
+	return m_histogramWriter.GetFormat();
+}
+/**
+ * Mutator for the format of charts written by the chart command.
+ *
+ * @param format Text (as menu option three), Csv, or Binary. See HistogramWriter.
+ */
+void GrocerBatch::SetChartFormat(HistogramWriter::Format format) {
+	m_histogramWriter.SetFormat(format);
+}
+
+/**
+ * Accessor for the longest bar in a text chart.
+ *
+ * @return Bar width in characters, 0 if bars are never scaled.
+ */
+size_t GrocerBatch::GetChartWidth() {
+	return m_histogramWriter.GetBarWidth();
+}
+/**
+ * Mutator for the longest bar in a text chart. Charts with larger counts are scaled to fit.
+ *
+ * @param barWidth Bar width in characters. 0 never scales: one * per purchase.
+ */
+void GrocerBatch::SetChartWidth(size_t barWidth) {
+	m_histogramWriter.SetBarWidth(barWidth);
+}
+
+/**
+ * Accessor for whether inputs are read together through the pipeline.
+ *
+ * @return true if all inputs are read at once by an IngestPipeline and reported together.
+ */
+bool GrocerBatch::GetPipeline() {
+	return m_usePipeline;
+}
+/**
+ * Mutator for whether inputs are read together through the pipeline. Needs the native engine,
+ * and no rollup.
+ *
+ * @param usePipeline true to read every input at once, one thread each, through an
+ * IngestPipeline, and print one report of all their purchases; false to report each file.
+ */
+void GrocerBatch::SetPipeline(bool usePipeline) {
+	this->m_usePipeline = usePipeline;
+}
+
+/**
+ * Accessor for the number of blocks in the pipeline's queue.
+ *
+ * @return Blocks as set. See IngestPipeline.
+ */
+size_t GrocerBatch::GetPipelineBlocks() {
+	return m_pipeline.GetQueueBlocks();
+}
+/**
+ * Mutator for the number of blocks in the pipeline's queue. See IngestPipeline.
+ *
+ * @param queueBlocks Blocks the inputs may be read ahead of the counting by, in total.
+ */
+void GrocerBatch::SetPipelineBlocks(size_t queueBlocks) {
+	m_pipeline.SetQueueBlocks(queueBlocks);
+}
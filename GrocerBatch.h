@@ -0,0 +1,84 @@
+/**
+ * GrocerBatch.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See GrocerBatch.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef GROCERBATCH_H
+#define GROCERBATCH_H
+
+#include "PyInterface.h"
+#include "PyWorkerPool.h"
+#include "PurchaseAggregator.h"
+#include "TopKSketch.h"
+#include "HistogramWriter.h"
+#include "IngestPipeline.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class GrocerBatch {
+public:
+	/* Exit codes returned by Run(). */
+	static const int EXIT_OK = 0;
+	static const int EXIT_FAILED = 1;
+	static const int EXIT_USAGE = 2;
+
+	GrocerBatch(PyInterface* pyInterface = nullptr);
+
+	int Run(const vector<string>& inputFileNames, const vector<string>& command);
+
+	bool GetNativeEngine();
+	void SetNativeEngine(bool useNativeEngine);
+	PyWorkerPool* GetPyWorkerPool();
+	void SetPyWorkerPool(PyWorkerPool* pyWorkerPool);
+	unsigned int GetThreadCount();
+	void SetThreadCount(unsigned int threadCount);
+	bool GetUseSnapshots();
+	void SetUseSnapshots(bool useSnapshots);
+	unsigned int GetJobCount();
+	void SetJobCount(unsigned int jobCount);
+	bool GetRollup();
+	void SetRollup(bool rollup);
+	size_t GetTopKCapacity();
+	void SetTopKCapacity(size_t capacity);
+	HistogramWriter::Format GetChartFormat();
+	void SetChartFormat(HistogramWriter::Format format);
+	size_t GetChartWidth();
+	void SetChartWidth(size_t barWidth);
+	bool GetPipeline();
+	void SetPipeline(bool usePipeline);
+	size_t GetPipelineBlocks();
+	void SetPipelineBlocks(size_t queueBlocks);
+
+private:
+	int RunList(const vector<string>& inputFileNames);
+	int RunCount(const vector<string>& inputFileNames, const vector<string>& itemNames);
+	int RunChart(const vector<string>& inputFileNames, const string& outputFileName);
+	int RunTop(const vector<string>& inputFileNames, const string& itemCount);
+	bool CountInputs(const vector<string>& inputFileNames,
+					 const PurchaseAggregator::FileCallback& onFile);
+	bool ReadItemNames(const vector<string>& arguments, vector<string>& itemNames);
+	bool HasSections(const vector<string>& inputFileNames);
+	string SectionHeader(const string& title);
+	string RollupTitle();
+	string PipelineTitle(const vector<string>& inputFileNames);
+
+	PyInterface* m_pyInterface;
+	PyWorkerPool* m_pyWorkerPool;
+	bool m_useNativeEngine;
+	bool m_rollup;
+	bool m_usePipeline;
+	size_t m_topKCapacity;
+	PurchaseAggregator m_aggregator;
+	HistogramWriter m_histogramWriter;
+	IngestPipeline m_pipeline;
+};
+
+#endif
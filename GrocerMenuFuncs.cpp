@@ -4,64 +4,118 @@
  *    Author: James Furman
  *    Date: 2022-12-11
  *
- * Interface specific to the Corner Grocer purchase analysis app. Takes a pointer to a PyInterface
+ * Interface specific to the Corner Grocer purchase analysis app. Takes a pointer to a PyExecutor
  * object to access attached Python code for data analysis and display functionality. 
  *
+ * By default, purchase counting is done natively by a PurchaseIndex (see PurchaseIndex.cpp),
+ * which reads the input file once per menu selection and prints the same output as the Python
+ * functions. SetNativeEngine(false) routes menu options one to three back through the Python 
+ * functions in PythonCode.py.
+ *
+ * Python functions run on the PyExecutor's thread (see PyExecutor.cpp). Menu options one and
+ * three are reports that need nothing from the user, so if the Python engine's report takes 
+ * longer than PROGRESS_INTERVAL, the menu comes back while it runs, and the report (captured 
+ * from Python's output) is printed when it is done: before the menu is next shown, or when the
+ * next option is picked. Every option but four also needs Python, and calls run one at a time,
+ * so those options first wait for the report. The menu still reads input with a blocking cin,
+ * so a report that finishes while the user is typing is printed after the next selection. 
+ * Other calls, whose results the option needs at once, are waited for; if one takes longer than
+ * PROGRESS_INTERVAL, a line of dots is printed to cerr until it finishes, so the console doesn't
+ * look frozen and the report on cout is unchanged.
+ *
+ * With SetFollowInput(true), the index is refreshed rather than reloaded for each menu selection,
+ * so only purchases appended to the input file since the last selection are read.
+ *
+ * Menu option four lists the best sellers with a TopKSketch (see TopKSketch.cpp), which reads the
+ * input file in fixed memory however many distinct items it has. Counts are exact unless the file
+ * has more distinct items than the sketch's capacity (SetTopKCapacity()).
+ *
+ * Menu option two finds items by name ignoring case, and lists the closest matches when a name
+ * isn't found, with an ItemSearchIndex (see ItemSearchIndex.cpp) that is rebuilt only when the
+ * item list changes.
+ *
+ * With SetUseSnapshots(true), the index is loaded from a snapshot file saved next to the input 
+ * file (see PurchaseIndex::SaveSnapshot()) when the snapshot still matches it, and the snapshot is
+ * rewritten whenever the input file had to be scanned.
+ *
+ * Each menu option is timed with LatencyStats (see LatencyStats.cpp) when timing is enabled, 
+ * leaving out the time spent waiting for the user's typing. Menu option five prints the timings.
+ *
  * Comments in Javadoc style for compatibility with various C++ API tools.
  */
 
 
 #include "GrocerMenuFuncs.h"
-//#include "PyInterface.h"	// included in GrocerMenuFuncs.h
+#include "LineScanner.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <fstream>
+//#include "PyExecutor.h"	// included in GrocerMenuFuncs.h
 //#include "UserMenu.h"		// included in GrocerMenuFuncs.h
 //#include <sstream>		// included in GrocerMenuFuncs.h
 
 using namespace std;
 
+/* How long a Python call may run before progress dots are printed, and the time between dots. */
+static const chrono::milliseconds PROGRESS_INTERVAL(500);
+/* Menu option two prints the whole item list if it has at most this many items. */
+static const size_t SEARCH_LIST_LIMIT = 100;
+/* Most closest matches menu option two prints for a name it doesn't find. */
+static const size_t SEARCH_MATCH_LIMIT = 10;
+
 /**
  * Default constructor. Useless. All member fields must be manually set by mutator functions 
  * before the object will be usable at all. 
  */
 GrocerMenuFuncs::GrocerMenuFuncs() {
-	m_pyInterface = nullptr;
+	m_pyExecutor = nullptr;
 	m_userMenu = nullptr;
 
 	m_inputFileName = "";
 	m_outputFileName = "";
+	m_useNativeEngine = true;
+	m_followInput = false;
+	m_useSnapshots = false;
 }
 
 /**
- * Constructor that receives pointers to a PyInterface object and a UserMenu object. 
+ * Constructor that receives pointers to a PyExecutor object and a UserMenu object. 
  * m_inputFileName and m_outputFileName must be set by their mutator functions before
  * the object will be usable at all. 
  * 
- * @param pyInterface PyInterface* to an interface class object making Python code usable.
+ * @param pyExecutor PyExecutor* to an executor class object running Python code on its thread.
  * @param userMenu UserMenu* to a linked list class object for storing and printing menu options.
  */
-GrocerMenuFuncs::GrocerMenuFuncs(PyInterface* pyInterface, UserMenu* userMenu) {
-	m_pyInterface = pyInterface;
+GrocerMenuFuncs::GrocerMenuFuncs(PyExecutor* pyExecutor, UserMenu* userMenu) {
+	m_pyExecutor = pyExecutor;
 	m_userMenu = userMenu;
 
 	m_inputFileName = "";
 	m_outputFileName = "";
+	m_useNativeEngine = true;
+	m_followInput = false;
+	m_useSnapshots = false;
 }
 
 /**
  * Constructor that receives and sets all member fields. If correctly set, this object is
  * fully functional. 
  * 
- * @param pyInterface PyInterface* to an interface class object making Python code usable.
+ * @param pyExecutor PyExecutor* to an executor class object running Python code on its thread.
  * @param userMenu UserMenu* to a linked list class object for storing and printing menu options.
  * @param inputFileName Name of file to read purchase data from.
  * @param outputFileName Name of file to write purchase data to. 
  */
-GrocerMenuFuncs::GrocerMenuFuncs(PyInterface* pyInterface, UserMenu* userMenu,
+GrocerMenuFuncs::GrocerMenuFuncs(PyExecutor* pyExecutor, UserMenu* userMenu,
 								string inputFileName, string outputFileName) {
-	m_pyInterface = pyInterface;
+	m_pyExecutor = pyExecutor;
 	m_userMenu = userMenu;
 
 	m_inputFileName = inputFileName;
 	m_outputFileName = outputFileName;
+	m_useNativeEngine = true;
+	m_followInput = false;
+	m_useSnapshots = false;
 }
 
 /* ------------------------- Menu option function definitions ------------------------- */
@@ -74,12 +128,24 @@ GrocerMenuFuncs::GrocerMenuFuncs(PyInterface* pyInterface, UserMenu* userMenu,
 
 /* -------------------- Menu Option One -------------------- */
 /**
- * Calls to m_pyInterface to call Python function CountItems. Counts the number of times each item
- * is purchased in m_inputFileName and prints a list of each item and the number of times it was
- * purchased. 
+ * Counts the number of times each item is purchased in m_inputFileName and prints a list of each
+ * item and the number of times it was purchased. Uses m_purchaseIndex, or calls to m_pyExecutor 
+ * to call Python function CountItems if the native engine is off (in the background if it runs
+ * long; see StartReport()).
  */
 void GrocerMenuFuncs::OptListItems() {
-	m_pyInterface->CallIntFunc("CountItems", m_inputFileName);
+	ScopedTimer timer(LatencyStats::Metric::MenuList);
+	if (!m_useNativeEngine) {
+		string inputFileName = m_inputFileName;
+		StartReport("Item list", [inputFileName](PyInterface& pyInterface) {
+			return pyInterface.Call<int>("CountItems", inputFileName);
+		});
+		return;
+	}
+
+	if (LoadPurchaseIndex()) {
+		cout << m_purchaseIndex.FormatItemCounts();
+	}
 }
 
 /* -------------------- Menu Option Two -------------------- */
@@ -90,98 +156,194 @@ void GrocerMenuFuncs::OptListItems() {
  * selection is found, prints the name of the selected item and the number of times it was 
  * purchased in m_inputFileName.
  * 
- * Calls to m_pyInterface to get the list of items and to search for the selected item; printing
- * the item list, getting the user's selection, and printing the returned number is all handled in
- * this function.
+ * Names are matched ignoring case, through m_itemSearch (see ItemSearchIndex.cpp). If no item
+ * has the name typed, the closest matches are listed with their counts: items that start with
+ * what was typed, or are a typing error or two from it. Catalogs of more than SEARCH_LIST_LIMIT
+ * items aren't printed, as printing them would take longer than the search; the user types the
+ * name, or the start of it, and gets the closest matches.
+ * 
+ * Gets the list of items and searches for the selected item with GetItemsList() and 
+ * CountPurchases(); printing the item list, getting the user's selection, and printing the 
+ * returned number is all handled in this function.
  */
 void GrocerMenuFuncs::OptSearchItem() {
+	ScopedTimer timer(LatencyStats::Metric::MenuSearchList);
 	// Declares a vector<string> and assigns it with strings of all items in input file.
-	vector<string> itemsList = m_pyInterface->CallListFunc("GetItems", m_inputFileName);
+	vector<string> itemsList = GetItemsList();
 
 	// Print numbered list and prompt user to make a selection.
-	cout << "Select an item:" << endl;
-	for (int i = 0; i < itemsList.size(); ++i) {
-		cout << i + 1 << ": " << itemsList.at(i) << endl;
+	if (itemsList.size() <= SEARCH_LIST_LIMIT) {
+		cout << "Select an item:" << endl;
+		for (int i = 0; i < itemsList.size(); ++i) {
+			cout << i + 1 << ": " << itemsList.at(i) << endl;
+		}
+		cout << "Type the item's number or name: ";
 	}
-	cout << "Type the item's number or name: ";
+	else {
+		cout << itemsList.size() << " items. Type the item's name or the start of it: ";
+	}
+	timer.Stop();
 
 	// Get user's selection. They may enter an int or a string. 
 	string searchItem;
 	cin.ignore();
 	cin.clear();
 	cin >> searchItem;
+	timer.Next(LatencyStats::Metric::MenuSearchCount);
 
 	// If user's selection begins with a digit.
 	if (isdigit(searchItem.at(0))) {
-		// If user enters an int greater than the highest list number
-		if (stoi(searchItem) >= itemsList.size()) {
+		// Numbers too large for unsigned long long read as ULLONG_MAX, so are out of range too.
+		unsigned long long itemNumber = strtoull(searchItem.c_str(), nullptr, 10);
+		// If user enters 0 or an int greater than the highest list number
+		if (itemNumber == 0 || itemNumber > itemsList.size()) {
 			cout << "Didn't find that item." << endl;
 		}
-		// Uf user enters an int in the range of the list's length
-		else if (stoi(searchItem) > 0) {
-			// Get string of item at the position the user requested 
+		// If user enters an int in the range of the list's length
+		else {
+			// Get position of the item the user requested 
 			// (converted between [1, ...] and [0, ...].)
-			searchItem = itemsList.at(stoi(searchItem) - 1);
-			/* Call Python function to calculate and return the number of times that item
-			 * was purchased in the input file. */
-			int searchResult = m_pyInterface->CallIntFunc("CountOneItem", m_inputFileName, 
-														 searchItem);
-			
-			// Various messages depending on 0 purchases, 1 purchase, or multiple purchases.
-			if (searchResult == 0) {
-				cout << "No " << searchItem << " purchased this day." << endl;
-			}
-			else {
-				cout << searchItem << ": " << searchResult;
-				if (searchResult == 1) {
-					cout << " purchase";
-				}
-				else {
-					cout << " purchases";
-				}
-				cout << " this day." << endl;
-			}
+			size_t itemPosition = itemNumber - 1;
+			int searchResult = CountListedItem(itemsList, itemPosition);
+			PrintPurchaseCount(itemsList.at(itemPosition), searchResult);
 		}
 	}
 	// If user's selection does not begin with a digit
 	else {
-		// Erase any spaces at end of user input
-		while (searchItem.at(searchItem.size() - 1) == ' ') {
-			searchItem.erase(searchItem.size() - 1, 1);
+		// Erase any whitespace around user input
+		searchItem = string(LineScanner::Trim(searchItem));
+
+		if (!m_itemSearch.IsBuiltFrom(itemsList)) {
+			m_itemSearch.Build(itemsList);
+		}
+		if (m_useNativeEngine) {
+			m_itemSearch.SetWeights(m_purchaseIndex.GetCounts());
 		}
 
-		/* Call Python function to calculate and return the number of times that item
-		 * was purchased in the input file. */
-		int searchResult = m_pyInterface->CallIntFunc("CountOneItem", m_inputFileName, searchItem);
+		// Print the count of the item with that name, or of the closest matches if there isn't one.
+		uint32_t itemId = m_itemSearch.FindName(searchItem);
+		if (itemId != ItemSearchIndex::NO_ITEM) {
+			PrintPurchaseCount(itemsList.at(itemId), CountListedItem(itemsList, itemId));
+			return;
+		}
 
-		// Various messages depending on 0 purchases, 1 purchase, or multiple purchases.
-		if (searchResult == 0) {
-			cout << "No " << searchItem << " purchased this day." << endl;
+		vector<ItemSearchIndex::Match> matches;
+		matches = m_itemSearch.Search(searchItem, SEARCH_MATCH_LIMIT);
+		PrintPurchaseCount(searchItem, 0);
+		if (!matches.empty()) {
+			cout << "Closest matches:" << endl;
 		}
-		else {
-			cout << searchItem << ": " << searchResult;
-			if (searchResult == 1) {
-				cout << " purchase";
-			}
-			else {
-				cout << " purchases";
-			}
-			cout << " this day." << endl;
+		for (const ItemSearchIndex::Match& match : matches) {
+			PrintPurchaseCount(itemsList.at(match.id), CountListedItem(itemsList, match.id));
 		}
 	}
 }
 
 /* -------------------- Menu Option Three -------------------- */
 /**
- * Call "ChartItems" function from associated Python file through PyInterface m_pyInterface,
- * getting data from file named m_inputFileName, printing a histogram to console, and writing a 
- * histogram to file named m_outputFileName.
+ * Get data from file named m_inputFileName, print a histogram to console, and write a histogram
+ * to file named m_outputFileName. Uses m_purchaseIndex and m_histogramWriter, or calls 
+ * "ChartItems" function from associated Python file through PyExecutor m_pyExecutor if the 
+ * native engine is off (in the background if it runs long; see StartReport()).
+ * 
+ * Bars are scaled to the chart width when counts are larger (see HistogramWriter.cpp). If the 
+ * chart format is CSV or binary, the histogram is still printed as text but the file is written
+ * in that format.
  */
 void GrocerMenuFuncs::OptChartItems() {
-	m_pyInterface->CallIntFunc("ChartItems", m_inputFileName, m_outputFileName);
+	ScopedTimer timer(LatencyStats::Metric::MenuChart);
+	if (!m_useNativeEngine) {
+		string inputFileName = m_inputFileName;
+		string outputFileName = m_outputFileName;
+		StartReport("Chart", [inputFileName, outputFileName](PyInterface& pyInterface) {
+			return pyInterface.Call<int>("ChartItems", inputFileName, outputFileName);
+		});
+		return;
+	}
+
+	if (!LoadPurchaseIndex()) {
+		return;
+	}
+	if (m_purchaseIndex.ItemCount() == 0) {
+		cout << "No purchases to chart." << endl;
+		return;
+	}
+
+	m_histogramWriter.Clear();
+	m_histogramWriter.AddSection(m_inputFileName, m_purchaseIndex);
+	if (m_histogramWriter.GetFormat() == HistogramWriter::Format::Text) {
+		const string& histogram = m_histogramWriter.GetOutput();
+		cout.write(histogram.data(), histogram.size());
+	}
+	else {
+		HistogramWriter textWriter(HistogramWriter::Format::Text, m_histogramWriter.GetBarWidth());
+		textWriter.AddSection(m_inputFileName, m_purchaseIndex);
+		cout.write(textWriter.GetOutput().data(), textWriter.GetOutput().size());
+	}
+
+	if (!m_histogramWriter.WriteFile(m_outputFileName)) {
+		cout << "Couldn't write to " << m_outputFileName << "." << endl;
+	}
 }
 
 /* -------------------- Menu Option Four -------------------- */
+/**
+ * Prompts the user for a number of items and prints that many of the best-selling items in 
+ * m_inputFileName, highest count first, as the dotted lines of menu option one. Counted by 
+ * m_topItems in fixed memory; if the file has more distinct items than its capacity, counts are
+ * estimates and the least each item may have sold is printed beside it.
+ */
+void GrocerMenuFuncs::OptTopItems() {
+	cout << "How many best sellers? ";
+	string countInput;
+	cin >> countInput;
+
+	size_t itemCount = 0;
+	try {
+		itemCount = stoul(countInput);
+	}
+	// stoul throws invalid_argument or out_of_range for anything but a reasonable number.
+	catch (logic_error& excpt) {
+		itemCount = 0;
+	}
+	if (itemCount == 0) {
+		cout << "Didn't recognize that number." << endl;
+		return;
+	}
+
+	ScopedTimer timer(LatencyStats::Metric::MenuTop);
+	m_topItems.Clear();
+	if (!m_topItems.AddFile(m_inputFileName)) {
+		cout << "Couldn't open " << m_inputFileName << "." << endl;
+		return;
+	}
+	cout << m_topItems.FormatTopItems(itemCount);
+}
+
+/* -------------------- Menu Option Five -------------------- */
+/**
+ * Prints how long each timed phase of the menu options and Python calls has taken so far: count,
+ * p50, p99, and maximum (see LatencyStats.cpp). Timing is only collected when the app is started
+ * with --stats or --stats-json. With the Python engine's result cache on (--py-cache), also 
+ * prints how many Python calls the cache answered.
+ */
+void GrocerMenuFuncs::OptStatistics() {
+	cout << LatencyStats::FormatTable();
+	if (m_useNativeEngine) {
+		return;
+	}
+
+	pair<unsigned long long, unsigned long long> cacheCounts = AwaitResult(
+		m_pyExecutor->Run([](PyInterface& pyInterface) {
+			return make_pair(pyInterface.GetCacheHits(), pyInterface.GetCacheMisses());
+		}));
+	if (cacheCounts.first + cacheCounts.second > 0) {
+		cout << "Python result cache: " << cacheCounts.first << " hits, " << cacheCounts.second
+			 << " misses." << endl;
+	}
+}
+
+/* -------------------- Menu Option Six -------------------- */
 /**
  * Print exit message if user chooses to exit. 
  */
@@ -221,6 +383,193 @@ int GrocerMenuFuncs::GetIntInput(int& menuSelect) {
 
 /* ------------------------- End menu option function definitions ------------------------- */
 
+/* -------------------- Counting helpers -------------------- */
+
+/**
+ * Read m_inputFileName into m_purchaseIndex, or only its new purchases if following the input
+ * file. If using snapshots, a valid snapshot is loaded instead of scanning the file, and the 
+ * snapshot is saved again after a scan. Prints an error message if the file can't be read.
+ * 
+ * @return true if the index was loaded, false otherwise.
+ */
+bool GrocerMenuFuncs::LoadPurchaseIndex() {
+	ScopedTimer timer(LatencyStats::Metric::LoadCounts);
+	string snapshotName = PurchaseIndex::SnapshotName(m_inputFileName);
+	bool following = m_followInput && m_purchaseIndex.GetSourceName() == m_inputFileName;
+	if (m_useSnapshots && !following && 
+		m_purchaseIndex.LoadSnapshot(snapshotName, m_inputFileName)) {
+		ShareCounts();
+		return true;
+	}
+
+	bool loaded = m_followInput ? m_purchaseIndex.RefreshFile(m_inputFileName) 
+								: m_purchaseIndex.LoadFile(m_inputFileName);
+	if (!loaded) {
+		cout << "Couldn't open " << m_inputFileName << "." << endl;
+		return false;
+	}
+
+	// A snapshot that can't be written only costs a rescan next time, so failures are ignored.
+	if (m_useSnapshots && m_purchaseIndex.HasUnsavedScan()) {
+		m_purchaseIndex.SaveSnapshot(snapshotName);
+	}
+	ShareCounts();
+	return true;
+}
+
+/**
+ * Share m_purchaseIndex with Python code through the "grocer" module, so Python functions can
+ * use the counts already loaded (see GrocerPyModule.cpp).
+ */
+void GrocerMenuFuncs::ShareCounts() {
+	if (m_pyExecutor != nullptr) {
+		m_pyExecutor->SetPurchaseIndex(&m_purchaseIndex);
+	}
+}
+
+/**
+ * Get the name of each item in m_inputFileName exactly once, in the order first purchased. Uses
+ * m_purchaseIndex, or the Python function GetItems if the native engine is off. 
+ * 
+ * @return vector<string> of item names. Empty if the file can't be read.
+ */
+vector<string> GrocerMenuFuncs::GetItemsList() {
+	if (!m_useNativeEngine) {
+		return AwaitResult(m_pyExecutor->Submit<vector<string>>("GetItems", m_inputFileName));
+	}
+
+	if (!LoadPurchaseIndex()) {
+		return {};
+	}
+	return m_purchaseIndex.GetItems();
+}
+
+/**
+ * Get the number of times an item was purchased in m_inputFileName. Uses m_purchaseIndex as 
+ * loaded by the last GetItemsList() call, or the Python function CountOneItem if the native 
+ * engine is off. 
+ * 
+ * @param searchItem Name of the item to count.
+ * @return int number of purchases of searchItem.
+ */
+int GrocerMenuFuncs::CountPurchases(const string& searchItem) {
+	if (!m_useNativeEngine) {
+		return AwaitResult(m_pyExecutor->Submit<int>("CountOneItem", m_inputFileName, searchItem));
+	}
+
+	return static_cast<int>(m_purchaseIndex.CountOf(searchItem));
+}
+
+/**
+ * Print the number of times an item was purchased, as menu option two reports it.
+ * 
+ * @param itemName Name of the item.
+ * @param purchases Number of purchases of the item.
+ */
+void GrocerMenuFuncs::PrintPurchaseCount(const string& itemName, int purchases) {
+	// Various messages depending on 0 purchases, 1 purchase, or multiple purchases.
+	if (purchases == 0) {
+		cout << "No " << itemName << " purchased this day." << endl;
+	}
+	else {
+		cout << itemName << ": " << purchases;
+		if (purchases == 1) {
+			cout << " purchase";
+		}
+		else {
+			cout << " purchases";
+		}
+		cout << " this day." << endl;
+	}
+}
+
+/**
+ * Get the number of times an item from the list returned by GetItemsList() was purchased. With
+ * the native engine the list position is the item's ID in m_purchaseIndex, so no name lookup is
+ * needed; otherwise calls the Python function CountOneItem with the item's name. 
+ * 
+ * @param itemsList List returned by the last GetItemsList() call.
+ * @param itemPosition Zero-based position of the item in itemsList.
+ * @return int number of purchases of the item.
+ */
+int GrocerMenuFuncs::CountListedItem(const vector<string>& itemsList, size_t itemPosition) {
+	if (!m_useNativeEngine) {
+		return CountPurchases(itemsList.at(itemPosition));
+	}
+
+	return static_cast<int>(m_purchaseIndex.CountAt(static_cast<uint32_t>(itemPosition)));
+}
+
+/**
+ * Wait for a call submitted to m_pyExecutor to finish. If it runs longer than PROGRESS_INTERVAL,
+ * prints "Working" and a dot per interval to cerr until it does, so a long Python call doesn't 
+ * look like a frozen console.
+ * 
+ * @param result Future returned by m_pyExecutor->Submit().
+ * @return The call's result.
+ */
+template <typename R>
+R GrocerMenuFuncs::AwaitResult(future<R> result) {
+	bool showingProgress = false;
+	while (result.wait_for(PROGRESS_INTERVAL) != future_status::ready) {
+		if (!showingProgress) {
+			cerr << "Working";
+			showingProgress = true;
+		}
+		cerr << '.' << flush;
+	}
+	if (showingProgress) {
+		cerr << endl;
+	}
+	return result.get();
+}
+
+/**
+ * Run a Python report on m_pyExecutor without keeping the menu waiting for it. Waits up to 
+ * PROGRESS_INTERVAL, and prints the report if it is done by then, as if it ran on this thread.
+ * Otherwise says so and returns to the menu; the report is kept in m_pendingReport and printed
+ * by CollectReport(). Python's output is captured while the report runs, so it doesn't print in
+ * the middle of the menu. Any earlier report is collected first.
+ * 
+ * @param reportName Name to print when the report is collected, e.g. "Chart".
+ * @param call Makes the report's Python call(s) with the executor's PyInterface.
+ */
+void GrocerMenuFuncs::StartReport(const string& reportName, function<int(PyInterface&)> call) {
+	CollectReport(true);
+
+	m_pendingReportName = reportName;
+	m_pendingReport = m_pyExecutor->Run([call](PyInterface& pyInterface) {
+		pyInterface.CaptureOutput();
+		int result = call(pyInterface);
+		return make_pair(result, pyInterface.ReleaseOutput());
+	});
+	if (m_pendingReport.wait_for(PROGRESS_INTERVAL) == future_status::ready) {
+		string output = m_pendingReport.get().second;
+		cout.write(output.data(), output.size());
+		return;
+	}
+	cout << reportName << " is running in Python. It will be printed when it's done." << endl;
+}
+
+/**
+ * Print the report started by StartReport(), if there is one and it is done.
+ * 
+ * @param wait true to wait for the report to finish (printing dots, see AwaitResult()), false to
+ * leave it running if it isn't done yet.
+ */
+void GrocerMenuFuncs::CollectReport(bool wait) {
+	if (!m_pendingReport.valid()) {
+		return;
+	}
+	if (!wait && m_pendingReport.wait_for(chrono::seconds(0)) != future_status::ready) {
+		return;
+	}
+
+	string output = AwaitResult(move(m_pendingReport)).second;
+	cout << "-------------------- " << m_pendingReportName << " --------------------" << endl;
+	cout.write(output.data(), output.size());
+}
+
 /**
  * Gets user's input 
  * 
@@ -241,6 +590,7 @@ bool GrocerMenuFuncs::MenuSelection() {
 	int menuSelect;
 	cin.exceptions(ios::failbit);
 
+	CollectReport(false);
 	m_userMenu->PrintMenu();
 	cout << "Enter your selection as a number: ";
 
@@ -251,6 +601,12 @@ bool GrocerMenuFuncs::MenuSelection() {
 		return true;
 	}
 
+	// Option four is the only one that doesn't call Python, so the others must wait for a
+	// report still running in Python, and should print it first.
+	if (menuSelect != 4) {
+		CollectReport(true);
+	}
+
 	/* ----- Function calls ----- */
 	// Count Items
 	if (menuSelect == 1) {
@@ -264,8 +620,16 @@ bool GrocerMenuFuncs::MenuSelection() {
 	else if (menuSelect == 3) {
 		OptChartItems();
 	}
-	// Exit
+	// Best sellers
 	else if (menuSelect == 4) {
+		OptTopItems();
+	}
+	// Timing statistics
+	else if (menuSelect == 5) {
+		OptStatistics();
+	}
+	// Exit
+	else if (menuSelect == 6) {
 		OptExit();
 		return false;
 	}
@@ -273,27 +637,27 @@ bool GrocerMenuFuncs::MenuSelection() {
 		cout << "Didn't recognize that input. Try again." << endl;
 	}
 
-	// This return statement is reached if !(menuSelect == 4)
+	// This return statement is reached if !(menuSelect == 6)
 	return true;
 }
 
 /* -------------------- Accessors & Mutators -------------------- */
 
 /**
- * Accessor for the PyInterface* member field. 
+ * Accessor for the PyExecutor* member field. 
  * 
- * @return Pointer to a PyInterface class object.
+ * @return Pointer to a PyExecutor class object.
  */
-PyInterface* GrocerMenuFuncs::GetPyInterface() {
-	return this->m_pyInterface;
+PyExecutor* GrocerMenuFuncs::GetPyExecutor() {
+	return this->m_pyExecutor;
 }
 /**
- * Mutator for the PyInterface* member field.
+ * Mutator for the PyExecutor* member field.
  * 
- * @param Pointer to a PyInterface class object.
+ * @param Pointer to a PyExecutor class object.
  */
-void GrocerMenuFuncs::SetPyInterface(PyInterface* pyInterface) {
-	this->m_pyInterface = pyInterface;
+void GrocerMenuFuncs::SetPyExecutor(PyExecutor* pyExecutor) {
+	this->m_pyExecutor = pyExecutor;
 }
 
 /**
@@ -346,4 +710,127 @@ string GrocerMenuFuncs::GetOutputFilename() {
  */
 void GrocerMenuFuncs::SetOutputFilename(string outputFileName) {
 	this->m_outputFileName = outputFileName;
-}
\ No newline at end of file
+}
+
+/**
+ * Accessor for whether menu options count purchases natively or through Python.
+ *
+ * @return true if m_purchaseIndex is used, false if PythonCode.py functions are called.
+ */
+bool GrocerMenuFuncs::GetNativeEngine() {
+	return m_useNativeEngine;
+}
+/**
+ * Mutator for whether menu options count purchases natively or through Python.
+ *
+ * @param useNativeEngine true to use m_purchaseIndex, false to call PythonCode.py functions.
+ */
+void GrocerMenuFuncs::SetNativeEngine(bool useNativeEngine) {
+	this->m_useNativeEngine = useNativeEngine;
+}
+
+/**
+ * Accessor for the number of threads used to count purchases in the input file.
+ *
+ * @return Maximum number of scan threads used by m_purchaseIndex.
+ */
+unsigned int GrocerMenuFuncs::GetThreadCount() {
+	return m_purchaseIndex.GetThreadCount();
+}
+/**
+ * Mutator for the number of threads used to count purchases in the input file.
+ *
+ * @param threadCount Maximum number of scan threads. 0 uses every hardware thread.
+ */
+void GrocerMenuFuncs::SetThreadCount(unsigned int threadCount) {
+	m_purchaseIndex.SetThreadCount(threadCount);
+}
+
+/**
+ * Accessor for whether the input file is followed as it is appended to.
+ *
+ * @return true if menu selections only read purchases added since the last selection.
+ */
+bool GrocerMenuFuncs::GetFollowInput() {
+	return m_followInput;
+}
+/**
+ * Mutator for whether the input file is followed as it is appended to.
+ *
+ * @param followInput true to only read purchases added since the last selection, false to reread
+ * the whole file for each selection.
+ */
+void GrocerMenuFuncs::SetFollowInput(bool followInput) {
+	this->m_followInput = followInput;
+}
+
+/**
+ * Accessor for whether count snapshots are used.
+ *
+ * @return true if the index is loaded from and saved to a snapshot next to the input file.
+ */
+bool GrocerMenuFuncs::GetUseSnapshots() {
+	return m_useSnapshots;
+}
+/**
+ * Mutator for whether count snapshots are used.
+ *
+ * @param useSnapshots true to load the index from a valid snapshot next to the input file and to
+ * save one after each scan, false to always scan the input file.
+ */
+void GrocerMenuFuncs::SetUseSnapshots(bool useSnapshots) {
+	this->m_useSnapshots = useSnapshots;
+}
+
+/**
+ * Accessor for the number of items the best-sellers sketch monitors.
+ *
+ * @return Capacity of m_topItems.
+ */
+size_t GrocerMenuFuncs::GetTopKCapacity() {
+	return m_topItems.GetCapacity();
+}
+/**
+ * Mutator for the number of items the best-sellers sketch monitors. Best-seller counts are exact
+ * for files with up to this many distinct items; memory use grows with it.
+ *
+ * @param capacity Number of items monitored by m_topItems.
+ */
+void GrocerMenuFuncs::SetTopKCapacity(size_t capacity) {
+	m_topItems.SetCapacity(capacity);
+}
+
+/**
+ * Accessor for the format of the file written by menu option three.
+ *
+ * @return Chart format.
+ */
+HistogramWriter::Format GrocerMenuFuncs::GetChartFormat() {
+	return m_histogramWriter.GetFormat();
+}
+/**
+ * Mutator for the format of the file written by menu option three. The chart is always printed
+ * as text.
+ *
+ * @param format Text, Csv, or Binary. See HistogramWriter.
+ */
+void GrocerMenuFuncs::SetChartFormat(HistogramWriter::Format format) {
+	m_histogramWriter.SetFormat(format);
+}
+
+/**
+ * Accessor for the longest bar in the histogram.
+ *
+ * @return Bar width in characters, 0 if bars are never scaled.
+ */
+size_t GrocerMenuFuncs::GetChartWidth() {
+	return m_histogramWriter.GetBarWidth();
+}
+/**
+ * Mutator for the longest bar in the histogram. Charts with larger counts are scaled to fit.
+ *
+ * @param barWidth Bar width in characters. 0 never scales: one * per purchase.
+ */
+void GrocerMenuFuncs::SetChartWidth(size_t barWidth) {
+	m_histogramWriter.SetBarWidth(barWidth);
+}
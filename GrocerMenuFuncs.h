@@ -12,14 +12,18 @@
 #ifndef GROCERMENUFUNCS_H
 #define GROCERMENUFUNCS_H
 
-#include"PyInterface.h"
+#include"PyExecutor.h"
+#include"PurchaseIndex.h"
+#include"TopKSketch.h"
+#include"HistogramWriter.h"
+#include"ItemSearchIndex.h"
 #include"UserMenu.h"
 
 class GrocerMenuFuncs {
 public:
 	GrocerMenuFuncs();
-	GrocerMenuFuncs(PyInterface* pyInterface, UserMenu* userMenu);
-	GrocerMenuFuncs(PyInterface* pyInterface, UserMenu* userMenu, 
+	GrocerMenuFuncs(PyExecutor* pyExecutor, UserMenu* userMenu);
+	GrocerMenuFuncs(PyExecutor* pyExecutor, UserMenu* userMenu, 
 					string inputFileName, string outputFileName);
 
 	int GetIntInput(int& menuSelect);
@@ -27,25 +31,62 @@ public:
 	void OptListItems();
 	void OptSearchItem();
 	void OptChartItems();
+	void OptTopItems();
+	void OptStatistics();
 	void OptExit();
 
 	bool MenuSelection();
 
-	PyInterface* GetPyInterface();
-	void SetPyInterface(PyInterface* pyInterface);
+	PyExecutor* GetPyExecutor();
+	void SetPyExecutor(PyExecutor* pyExecutor);
 	UserMenu* GetUserMenu();
 	void SetUserMenu(UserMenu* userMenu);
 	string GetInputFilename();
 	void SetInputFilename(string inputFileName);
 	string GetOutputFilename();
 	void SetOutputFilename(string outputFileName);
-
+	bool GetNativeEngine();
+	void SetNativeEngine(bool useNativeEngine);
+	unsigned int GetThreadCount();
+	void SetThreadCount(unsigned int threadCount);
+	bool GetFollowInput();
+	void SetFollowInput(bool followInput);
+	bool GetUseSnapshots();
+	void SetUseSnapshots(bool useSnapshots);
+	size_t GetTopKCapacity();
+	void SetTopKCapacity(size_t capacity);
+	HistogramWriter::Format GetChartFormat();
+	void SetChartFormat(HistogramWriter::Format format);
+	size_t GetChartWidth();
+	void SetChartWidth(size_t barWidth);
 
 private:
-	PyInterface* m_pyInterface;
+	bool LoadPurchaseIndex();
+	void ShareCounts();
+	vector<string> GetItemsList();
+	int CountPurchases(const string& searchItem);
+	int CountListedItem(const vector<string>& itemsList, size_t itemPosition);
+	void PrintPurchaseCount(const string& itemName, int purchases);
+	template <typename R>
+	R AwaitResult(future<R> result);
+	void StartReport(const string& reportName, function<int(PyInterface&)> call);
+	void CollectReport(bool wait);
+
+	PyExecutor* m_pyExecutor;
 	UserMenu* m_userMenu;
 	string m_inputFileName;
 	string m_outputFileName;
+	bool m_useNativeEngine;
+	bool m_followInput;
+	bool m_useSnapshots;
+	PurchaseIndex m_purchaseIndex;
+	TopKSketch m_topItems;
+	HistogramWriter m_histogramWriter;
+	ItemSearchIndex m_itemSearch;
+	/* Python report still running in the background (see StartReport()): its result and what
+	 * it printed, and its name. */
+	future<pair<int, string>> m_pendingReport;
+	string m_pendingReportName;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,275 @@
+/**
+ * GrocerPyModule.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Built-in Python module "grocer" that gives PythonCode.py (and any other script run by a
+ * PyInterface) the counts already computed by the C++ PurchaseIndex, so Python code doesn't have
+ * to re-read and re-count the input file:
+ * - grocer.items()    tuple of item names, in ID (first-purchased) order.
+ * - grocer.counts()   memoryview of unsigned 64-bit ints (format 'Q'), counts[i] being the
+ *                     purchases of items()[i]. Supports len(), indexing, sum(), and the buffer
+ *                     protocol, e.g. numpy.frombuffer(grocer.counts(), dtype=numpy.uint64).
+ * - grocer.count(name)  purchases of one item, 0 if never purchased.
+ * - grocer.count_many(names)  list of the purchases of each item in a list (or any sequence) of
+ *                     names, in order; one lookup per name.
+ * - grocer.source()   name of the file the counts were read from ("" for a rollup).
+ * Each function raises RuntimeError if no counts have been shared yet.
+ * Item names are bytes from the input file: items() and source() decode them as UTF-8 with
+ * "surrogateescape", and count() and count_many() encode names the same way, so every name from
+ * items() round-trips even if its bytes aren't valid UTF-8.
+ *
+ * Register() adds the module to the interpreter's built-in modules with PyImport_AppendInittab,
+ * which must happen before Py_Initialize; PyInterface does this when it starts the interpreter.
+ * The C++ side shares an index with SetPurchaseIndex() (or PyInterface::SetPurchaseIndex()). The
+ * index is read at the time of each call, so Python always sees its current counts.
+ *
+ * counts() copies the counts into a new bytes object (one memcpy, 8 bytes per distinct item) and
+ * returns a view of it, so the view stays valid after the index is reloaded.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "GrocerPyModule.h"
+
+using namespace std;
+
+/* Index shared with Python, or nullptr. */
+const PurchaseIndex* GrocerPyModule::s_purchaseIndex = nullptr;
+/* Whether Register() has added the module to the built-in modules. */
+bool GrocerPyModule::s_registered = false;
+
+/* Functions in the grocer module. */
+PyMethodDef GrocerPyModule::s_methods[] = {
+	{ "items", GrocerPyModule::Items, METH_NOARGS, "Tuple of item names, in ID order." },
+	{ "counts", GrocerPyModule::Counts, METH_NOARGS,
+	  "Memoryview of uint64 purchase counts ('Q'), in ID order." },
+	{ "count", GrocerPyModule::Count, METH_VARARGS, "Purchases of the named item." },
+	{ "count_many", GrocerPyModule::CountMany, METH_VARARGS,
+	  "List of the purchases of each named item, in order." },
+	{ "source", GrocerPyModule::Source, METH_NOARGS, "Name of the file the counts are from." },
+	{ nullptr, nullptr, 0, nullptr }
+};
+
+/* Definition of the grocer module. */
+PyModuleDef GrocerPyModule::s_moduleDef = {
+	PyModuleDef_HEAD_INIT,
+	"grocer",
+	"Purchase counts computed by the Corner Grocer C++ engine.",
+	-1,
+	GrocerPyModule::s_methods,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr
+};
+
+/**
+ * Add "grocer" to the interpreter's built-in modules. Must be called before Py_Initialize. Only
+ * the first call has any effect.
+ */
+void GrocerPyModule::Register() {
+	if (s_registered) {
+		return;
+	}
+	if (PyImport_AppendInittab("grocer", &GrocerPyModule::Init) == 0) {
+		s_registered = true;
+	}
+}
+
+/**
+ * Share an index's counts with Python. Shared by every PyInterface, since there is one
+ * interpreter.
+ *
+ * @param purchaseIndex Index to share, or nullptr to share nothing. Must stay alive while shared.
+ */
+void GrocerPyModule::SetPurchaseIndex(const PurchaseIndex* purchaseIndex) {
+	s_purchaseIndex = purchaseIndex;
+}
+
+/**
+ * @return Index shared with Python, or nullptr.
+ */
+const PurchaseIndex* GrocerPyModule::GetPurchaseIndex() {
+	return s_purchaseIndex;
+}
+
+/**
+ * Module init function, called by Python on "import grocer".
+ *
+ * @return New reference to the module, or nullptr on error.
+ */
+PyObject* GrocerPyModule::Init() {
+	return PyModule_Create(&s_moduleDef);
+}
+
+/**
+ * grocer.items()
+ *
+ * @return New reference to a tuple of str, or nullptr with RuntimeError set.
+ */
+PyObject* GrocerPyModule::Items(PyObject*, PyObject*) {
+	const PurchaseIndex* index = RequireIndex();
+	if (index == nullptr) {
+		return nullptr;
+	}
+
+	PyObject* pItems = PyTuple_New(static_cast<Py_ssize_t>(index->ItemCount()));
+	if (pItems == nullptr) {
+		return nullptr;
+	}
+	for (uint32_t id = 0; id < index->ItemCount(); ++id) {
+		string_view item = index->ItemAt(id);
+		// Item names are raw bytes from the file; undecodable bytes are kept as surrogates.
+		PyObject* pItem = PyUnicode_DecodeUTF8(item.data(), static_cast<Py_ssize_t>(item.size()),
+											   "surrogateescape");
+		if (pItem == nullptr) {
+			Py_DECREF(pItems);
+			return nullptr;
+		}
+		// PyTuple_SET_ITEM steals the reference to pItem
+		PyTuple_SET_ITEM(pItems, id, pItem);
+	}
+	return pItems;
+}
+
+/**
+ * grocer.counts()
+ *
+ * @return New reference to a memoryview of format 'Q', or nullptr with an exception set.
+ */
+PyObject* GrocerPyModule::Counts(PyObject*, PyObject*) {
+	const PurchaseIndex* index = RequireIndex();
+	if (index == nullptr) {
+		return nullptr;
+	}
+
+	static_assert(sizeof(unsigned long long) == 8, "counts are exposed as 64-bit 'Q'");
+	const vector<unsigned long long>& counts = index->GetCounts();
+	PyObject* pBytes = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(counts.data()),
+		static_cast<Py_ssize_t>(counts.size() * sizeof(unsigned long long)));
+	if (pBytes == nullptr) {
+		return nullptr;
+	}
+
+	PyObject* pView = PyMemoryView_FromObject(pBytes);
+	Py_DECREF(pBytes);
+	if (pView == nullptr) {
+		return nullptr;
+	}
+	PyObject* pCounts = PyObject_CallMethod(pView, "cast", "s", "Q");
+	Py_DECREF(pView);
+	return pCounts;
+}
+
+/**
+ * grocer.count(name)
+ *
+ * @return New reference to an int, or nullptr with an exception set.
+ */
+PyObject* GrocerPyModule::Count(PyObject*, PyObject* args) {
+	PyObject* pName;
+	if (!PyArg_ParseTuple(args, "O", &pName)) {
+		return nullptr;
+	}
+	const PurchaseIndex* index = RequireIndex();
+	if (index == nullptr) {
+		return nullptr;
+	}
+
+	return CountName(*index, pName);
+}
+
+/**
+ * grocer.count_many(names)
+ *
+ * @return New reference to a list of int, or nullptr with an exception set.
+ */
+PyObject* GrocerPyModule::CountMany(PyObject*, PyObject* args) {
+	PyObject* pNames;
+	if (!PyArg_ParseTuple(args, "O", &pNames)) {
+		return nullptr;
+	}
+	const PurchaseIndex* index = RequireIndex();
+	if (index == nullptr) {
+		return nullptr;
+	}
+
+	PyObject* pSequence = PySequence_Fast(pNames, "count_many() takes a sequence of item names");
+	if (pSequence == nullptr) {
+		return nullptr;
+	}
+	Py_ssize_t size = PySequence_Fast_GET_SIZE(pSequence);
+	PyObject** pItems = PySequence_Fast_ITEMS(pSequence);
+
+	PyObject* pCounts = PyList_New(size);
+	if (pCounts == nullptr) {
+		Py_DECREF(pSequence);
+		return nullptr;
+	}
+	for (Py_ssize_t i = 0; i < size; ++i) {
+		PyObject* pCount = CountName(*index, pItems[i]);
+		if (pCount == nullptr) {
+			Py_DECREF(pCounts);
+			Py_DECREF(pSequence);
+			return nullptr;
+		}
+		// PyList_SET_ITEM steals the reference to pCount
+		PyList_SET_ITEM(pCounts, i, pCount);
+	}
+	Py_DECREF(pSequence);
+	return pCounts;
+}
+
+/**
+ * grocer.source()
+ *
+ * @return New reference to a str, or nullptr with an exception set.
+ */
+PyObject* GrocerPyModule::Source(PyObject*, PyObject*) {
+	const PurchaseIndex* index = RequireIndex();
+	if (index == nullptr) {
+		return nullptr;
+	}
+
+	const string& source = index->GetSourceName();
+	return PyUnicode_DecodeUTF8(source.data(), static_cast<Py_ssize_t>(source.size()),
+								"surrogateescape");
+}
+
+/**
+ * Look up the purchases of an item named by a Python str. The name is encoded as items() decodes
+ * names, with "surrogateescape", so a name from items() finds its item even if the file's bytes
+ * for it aren't valid UTF-8.
+ *
+ * @param index Index to look in.
+ * @param pName Borrowed reference to the item name.
+ *
+ * @return New reference to an int, or nullptr with TypeError set if pName isn't a str.
+ */
+PyObject* GrocerPyModule::CountName(const PurchaseIndex& index, PyObject* pName) {
+	if (!PyUnicode_Check(pName)) {
+		PyErr_Format(PyExc_TypeError, "item names must be str, not %.200s",
+					 Py_TYPE(pName)->tp_name);
+		return nullptr;
+	}
+	PyObject* pBytes = PyUnicode_AsEncodedString(pName, "utf-8", "surrogateescape");
+	if (pBytes == nullptr) {
+		return nullptr;
+	}
+	string_view item(PyBytes_AS_STRING(pBytes), static_cast<size_t>(PyBytes_GET_SIZE(pBytes)));
+	PyObject* pCount = PyLong_FromUnsignedLongLong(index.CountOf(item));
+	Py_DECREF(pBytes);
+	return pCount;
+}
+
+/**
+ * @return The shared index, or nullptr with RuntimeError set if none is shared.
+ */
+const PurchaseIndex* GrocerPyModule::RequireIndex() {
+	if (s_purchaseIndex == nullptr) {
+		PyErr_SetString(PyExc_RuntimeError, "no purchase counts have been shared with grocer");
+	}
+	return s_purchaseIndex;
+}
@@ -0,0 +1,44 @@
+/**
+ * GrocerPyModule.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See GrocerPyModule.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef GROCERPYMODULE_H
+#define GROCERPYMODULE_H
+
+/* Python.h must see this first: "#" argument formats take Py_ssize_t lengths. */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "PurchaseIndex.h"
+
+using namespace std;
+
+class GrocerPyModule {
+public:
+	static void Register();
+	static void SetPurchaseIndex(const PurchaseIndex* purchaseIndex);
+	static const PurchaseIndex* GetPurchaseIndex();
+
+private:
+	static PyObject* Init();
+	static PyObject* Items(PyObject* self, PyObject* args);
+	static PyObject* Counts(PyObject* self, PyObject* args);
+	static PyObject* Count(PyObject* self, PyObject* args);
+	static PyObject* CountMany(PyObject* self, PyObject* args);
+	static PyObject* Source(PyObject* self, PyObject* args);
+	static PyObject* CountName(const PurchaseIndex& index, PyObject* pName);
+	static const PurchaseIndex* RequireIndex();
+
+	static const PurchaseIndex* s_purchaseIndex;
+	static bool s_registered;
+	static PyMethodDef s_methods[];
+	static PyModuleDef s_moduleDef;
+};
+
+#endif
@@ -0,0 +1,722 @@
+/**
+ * GrocerServer.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Long-running server that keeps purchase counts in memory and answers queries over a Unix
+ * domain socket, so dashboards can poll counts every few seconds without starting the app each
+ * time. Started by the "serve SOCKET" command (see Source.cpp).
+ *
+ * Counts:
+ * - The inputs (files, directories, or wildcards, as in batch mode) are counted into one
+ * PurchaseIndex per file and merged into the served counts, as a batch rollup.
+ * - Every SetRefreshSeconds() seconds the inputs are expanded again and each file is refreshed
+ * with PurchaseIndex::RefreshFile(), so appended purchases are read incrementally, rewritten
+ * files are rescanned, and files added to a directory are picked up. The merged counts are
+ * built off to the side and swapped in under a unique lock; requests read them under a shared
+ * lock, so they never wait for a scan and always see one consistent refresh.
+ *
+ * Protocol: one request per line, answered in order. Commands are case-insensitive. A reply is
+ * "OK" and a value, or "OK n" followed by n lines, or "ERR message":
+ *   COUNT ITEM   OK <purchases of ITEM, 0 if never purchased>
+ *   LIST         OK n, then "ITEM<tab>COUNT" for each item, in the order first purchased
+ *   TOP K        OK n, then "ITEM<tab>COUNT" for the K best sellers, highest count first (ties
+ *                in the order first purchased). Counts are exact.
+ *   CHART        OK n, then the text histogram of menu option three (see HistogramWriter.cpp)
+ *   FILES        OK n, then "FILE<tab>PURCHASES" for each file being served
+ * E.g. from a shell: printf 'COUNT Peas\nTOP 3\n' | nc -U grocer.sock
+ *
+ * Threads:
+ * - Run() is an epoll event loop on the calling thread. It accepts clients, reads request lines
+ * from non-blocking sockets, and writes replies; it never formats a reply itself.
+ * - A pool of SetWorkerCount() worker threads formats replies with HandleRequest(), so many
+ * clients are answered at once. Each connection has at most one request with the workers, and
+ * workers hand replies back to the loop through an eventfd.
+ * - One more thread runs Refresh() on its interval.
+ * - A client that sends requests faster than it reads replies is held back: while a connection
+ * has INPUT_HIGH_WATER bytes of requests waiting, or OUTPUT_HIGH_WATER bytes of replies, it
+ * isn't read from, and while it has that many bytes of replies no more of its requests are
+ * dispatched. The rest wait in the socket, so one client can't fill the server's memory.
+ * - Stop() may be called from any thread or a signal handler; Run() then closes every
+ * connection, removes the socket file, and returns.
+ *
+ * Linux only: the event loop uses epoll. Elsewhere Run() prints an error and returns false.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "GrocerServer.h"
+#include "PurchaseAggregator.h"
+#include "LineScanner.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * Constructor. Nothing is read until Run() or Refresh().
+ *
+ * @param inputs Purchase files, directories, or wildcards to serve (see
+ * PurchaseAggregator::ExpandInputs()).
+ * @param socketPath Path of the Unix domain socket to listen on.
+ */
+GrocerServer::GrocerServer(const vector<string>& inputs, const string& socketPath) {
+	m_inputs = inputs;
+	m_socketPath = socketPath;
+	m_workerCount = 0;
+	m_threadCount = 1;
+	m_refreshSeconds = DEFAULT_REFRESH_SECONDS;
+	m_chartWidth = HistogramWriter::DEFAULT_BAR_WIDTH;
+	m_stoppingWorkers = false;
+	m_stopping = false;
+	m_wakeFd = -1;
+	m_nextConnectionId = 0;
+}
+
+/**
+ * Destructor. Stops the server if it is running on another thread.
+ */
+GrocerServer::~GrocerServer() {
+	Stop();
+}
+
+/**
+ * Load the inputs, listen on the socket, and serve requests until Stop() is called.
+ *
+ * @return true if the server ran and was stopped, false if no input could be read or the socket
+ * couldn't be set up (with the error printed to cerr).
+ */
+bool GrocerServer::Run() {
+#ifdef __linux__
+	if (!Refresh()) {
+		cerr << "No purchase files to serve." << endl;
+		return false;
+	}
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.empty() || m_socketPath.size() >= sizeof(address.sun_path)) {
+		cerr << "Socket path must be 1 to " << sizeof(address.sun_path) - 1 << " characters." << endl;
+		return false;
+	}
+	memcpy(address.sun_path, m_socketPath.c_str(), m_socketPath.size() + 1);
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenFd < 0) {
+		cerr << "Couldn't create a socket: " << strerror(errno) << endl;
+		return false;
+	}
+
+	// A socket file left by a server that is gone is removed; one that still answers is not.
+	struct stat socketStat;
+	if (lstat(m_socketPath.c_str(), &socketStat) == 0 && S_ISSOCK(socketStat.st_mode)) {
+		int probeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		bool inUse = probeFd >= 0 &&
+			connect(probeFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+		if (probeFd >= 0) {
+			close(probeFd);
+		}
+		if (inUse) {
+			cerr << "Another server is listening on " << m_socketPath << "." << endl;
+			close(listenFd);
+			return false;
+		}
+		unlink(m_socketPath.c_str());
+	}
+
+	if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		listen(listenFd, SOMAXCONN) != 0) {
+		cerr << "Couldn't listen on " << m_socketPath << ": " << strerror(errno) << endl;
+		close(listenFd);
+		return false;
+	}
+
+	int epollFd = epoll_create1(EPOLL_CLOEXEC);
+	int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = listenFd;
+	bool ready = epollFd >= 0 && wakeFd >= 0 &&
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+	event.data.fd = wakeFd;
+	ready = ready && epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == 0;
+	if (!ready) {
+		cerr << "Couldn't start the event loop: " << strerror(errno) << endl;
+		for (int fd : { epollFd, wakeFd, listenFd }) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+		unlink(m_socketPath.c_str());
+		return false;
+	}
+	m_wakeFd = wakeFd;
+
+	unsigned int workerCount = (m_workerCount == 0) ? max(thread::hardware_concurrency(), 1u)
+													: m_workerCount;
+	m_stoppingWorkers = false;
+	vector<thread> workers;
+	for (unsigned int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&GrocerServer::WorkerLoop, this);
+	}
+	thread refresher(&GrocerServer::RefreshLoop, this);
+	cerr << "Serving " << m_fileTotals.size() << " file(s) on " << m_socketPath << "." << endl;
+
+	epoll_event events[64];
+	while (!m_stopping) {
+		int eventCount = epoll_wait(epollFd, events, 64, -1);
+		if (eventCount < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			cerr << "Event loop failed: " << strerror(errno) << endl;
+			break;
+		}
+
+		for (int i = 0; i < eventCount; ++i) {
+			int fd = events[i].data.fd;
+			if (fd == listenFd) {
+				AcceptClients(listenFd, epollFd);
+				continue;
+			}
+			if (fd == wakeFd) {
+				DeliverReplies(epollFd);
+				continue;
+			}
+
+			auto found = m_connections.find(fd);
+			if (found == m_connections.end()) {
+				continue;
+			}
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR)) {
+				ReadClient(fd, found->second);
+			}
+			DispatchNext(fd, found->second);
+			if (!WriteClient(fd, epollFd, found->second)) {
+				epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+				close(fd);
+				m_connections.erase(found);
+			}
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		m_stoppingWorkers = true;
+		m_tasks.clear();
+	}
+	m_queueChanged.notify_all();
+	m_stopRequested.notify_all();
+	for (thread& worker : workers) {
+		worker.join();
+	}
+	refresher.join();
+
+	m_wakeFd = -1;
+	for (auto& connection : m_connections) {
+		close(connection.first);
+	}
+	m_connections.clear();
+	m_replies.clear();
+	close(wakeFd);
+	close(epollFd);
+	close(listenFd);
+	unlink(m_socketPath.c_str());
+	return true;
+#else
+	cerr << "Server mode needs Linux." << endl;
+	return false;
+#endif
+}
+
+/**
+ * Ask Run() to stop. Returns right away; Run() returns once it has closed its connections. Safe
+ * to call from any thread, from a signal handler, and more than once.
+ */
+void GrocerServer::Stop() {
+	m_stopping = true;
+#ifdef __linux__
+	int wakeFd = m_wakeFd;
+	if (wakeFd >= 0) {
+		uint64_t one = 1;
+		ssize_t written = write(wakeFd, &one, sizeof(one));
+		(void)written;
+	}
+#endif
+}
+
+/**
+ * Bring the served counts up to date: expand the inputs again, refresh each file's index (reading
+ * only appended purchases where possible), and swap in freshly merged counts. Files that can't
+ * be read are left out until they can. Called by Run() and then periodically.
+ *
+ * @return true if at least one file is being served.
+ */
+bool GrocerServer::Refresh() {
+	lock_guard<mutex> refreshLock(m_refreshMutex);
+
+	vector<string> fileNames;
+	string unmatchedInput;
+	PurchaseAggregator::ExpandInputs(m_inputs, fileNames, unmatchedInput);
+
+	PurchaseIndex counts;
+	vector<pair<string, unsigned long long>> fileTotals;
+	map<string, PurchaseIndex> fileIndexes;
+	for (const string& fileName : fileNames) {
+		// Each file keeps its index between refreshes, so only new purchases are read.
+		auto previous = m_fileIndexes.find(fileName);
+		bool wasServed = previous != m_fileIndexes.end();
+		PurchaseIndex& index = fileIndexes[fileName];
+		if (wasServed) {
+			index = move(previous->second);
+		}
+		index.SetThreadCount(m_threadCount);
+		if (!index.RefreshFile(fileName)) {
+			if (wasServed || m_fileTotals.empty()) {
+				cerr << "Couldn't open " << fileName << "." << endl;
+			}
+			fileIndexes.erase(fileName);
+			continue;
+		}
+
+		unsigned long long total = 0;
+		for (unsigned long long count : index.GetCounts()) {
+			total += count;
+		}
+		fileTotals.push_back({ fileName, total });
+		counts.Merge(index);
+	}
+	m_fileIndexes = move(fileIndexes);
+
+	// Best sellers are ranked once per refresh, so TOP K only reads the first K.
+	vector<uint32_t> ranking(counts.ItemCount());
+	for (uint32_t id = 0; id < ranking.size(); ++id) {
+		ranking[id] = id;
+	}
+	const vector<unsigned long long>& itemCounts = counts.GetCounts();
+	stable_sort(ranking.begin(), ranking.end(), [&itemCounts](uint32_t a, uint32_t b) {
+		return itemCounts[a] > itemCounts[b];
+	});
+
+	bool serving = !fileTotals.empty();
+	unique_lock<shared_mutex> countsLock(m_countsMutex);
+	m_counts = move(counts);
+	m_ranking = move(ranking);
+	m_fileTotals = move(fileTotals);
+	return serving;
+}
+
+/**
+ * Answer one request line (see the protocol at the top of this file). Safe to call from any
+ * thread, alongside Refresh().
+ *
+ * @param request Request line, without its line ending. Surrounding whitespace is ignored.
+ * @return Reply, ending in a newline.
+ */
+string GrocerServer::HandleRequest(const string& request) {
+	string_view line = LineScanner::Trim(request);
+	size_t commandEnd = min(line.find_first_of(" \t"), line.size());
+	string command(line.substr(0, commandEnd));
+	for (char& c : command) {
+		c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+	}
+	string argument(LineScanner::Trim(line.substr(commandEnd)));
+
+	shared_lock<shared_mutex> lock(m_countsMutex);
+	if (command == "COUNT") {
+		if (argument.empty()) {
+			return "ERR COUNT needs an item name\n";
+		}
+		return "OK " + to_string(m_counts.CountOf(argument)) + "\n";
+	}
+	if (command == "LIST" && argument.empty()) {
+		vector<uint32_t> ids(m_counts.ItemCount());
+		for (uint32_t id = 0; id < ids.size(); ++id) {
+			ids[id] = id;
+		}
+		return FormatCounts(ids, ids.size());
+	}
+	if (command == "TOP") {
+		size_t itemCount = 0;
+		try {
+			itemCount = stoul(argument);
+		}
+		// stoul throws invalid_argument or out_of_range for anything but a reasonable number.
+		catch (logic_error& excpt) {
+			itemCount = 0;
+		}
+		if (itemCount == 0) {
+			return "ERR TOP needs a positive number of items\n";
+		}
+		return FormatCounts(m_ranking, min(itemCount, m_ranking.size()));
+	}
+	if (command == "CHART" && argument.empty()) {
+		if (m_counts.ItemCount() == 0) {
+			return "OK 0\n";
+		}
+		HistogramWriter writer(HistogramWriter::Format::Text, m_chartWidth);
+		writer.AddSection("", m_counts);
+		const string& chart = writer.GetOutput();
+		return "OK " + to_string(count(chart.begin(), chart.end(), '\n')) + "\n" + chart;
+	}
+	if (command == "FILES" && argument.empty()) {
+		string reply = "OK " + to_string(m_fileTotals.size()) + "\n";
+		for (const auto& fileTotal : m_fileTotals) {
+			reply += fileTotal.first + "\t" + to_string(fileTotal.second) + "\n";
+		}
+		return reply;
+	}
+	return "ERR unknown request; use COUNT ITEM, LIST, TOP K, CHART, or FILES\n";
+}
+
+/**
+ * Format "OK n" and a line of "ITEM<tab>COUNT" for each of the first n items in a list. Called
+ * with m_countsMutex held.
+ *
+ * @param ids Item IDs in m_counts.
+ * @param count Number of items to include.
+ * @return Reply.
+ */
+string GrocerServer::FormatCounts(const vector<uint32_t>& ids, size_t count) {
+	string reply = "OK " + to_string(count) + "\n";
+	for (size_t i = 0; i < count; ++i) {
+		reply += m_counts.ItemAt(ids[i]);
+		reply += '\t';
+		reply += to_string(m_counts.CountAt(ids[i]));
+		reply += '\n';
+	}
+	return reply;
+}
+
+/**
+ * Body of each worker thread: answer queued requests until the server stops.
+ */
+void GrocerServer::WorkerLoop() {
+	while (true) {
+		Task task;
+		{
+			unique_lock<mutex> lock(m_queueMutex);
+			m_queueChanged.wait(lock, [this] { return m_stoppingWorkers || !m_tasks.empty(); });
+			if (m_stoppingWorkers) {
+				return;
+			}
+			task = move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+
+		task.request = HandleRequest(task.request);
+
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_replies.push_back(move(task));
+		}
+#ifdef __linux__
+		uint64_t one = 1;
+		ssize_t written = write(m_wakeFd, &one, sizeof(one));
+		(void)written;
+#endif
+	}
+}
+
+/**
+ * Body of the refresh thread: call Refresh() every m_refreshSeconds until the server stops. A
+ * refresh interval of 0 never refreshes.
+ */
+void GrocerServer::RefreshLoop() {
+	unique_lock<mutex> lock(m_queueMutex);
+	while (!m_stoppingWorkers) {
+		if (m_refreshSeconds == 0) {
+			m_stopRequested.wait(lock, [this] { return m_stoppingWorkers; });
+			break;
+		}
+		if (m_stopRequested.wait_for(lock, chrono::seconds(m_refreshSeconds),
+									[this] { return m_stoppingWorkers; })) {
+			break;
+		}
+		lock.unlock();
+		Refresh();
+		lock.lock();
+	}
+}
+
+#ifdef __linux__
+
+/**
+ * Accept every waiting client and watch it for requests.
+ *
+ * @param listenFd Listening socket.
+ * @param epollFd Event loop's epoll instance.
+ */
+void GrocerServer::AcceptClients(int listenFd, int epollFd) {
+	while (true) {
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			// EAGAIN: none left. Anything else (e.g. out of descriptors) is retried on the next
+			// event, and the client waits in the backlog meanwhile.
+			return;
+		}
+
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = fd;
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+			close(fd);
+			continue;
+		}
+		m_connections[fd] = Connection{ m_nextConnectionId++, "", "", false, false, false,
+										event.events };
+	}
+}
+
+/**
+ * Read what a client has sent, up to INPUT_HIGH_WATER bytes of waiting input. Marks the input
+ * closed at end of stream or on an error, or if a request line grows past MAX_REQUEST_SIZE
+ * (DispatchNext() then answers ERR once the requests before it are answered).
+ *
+ * @param fd Client socket.
+ * @param connection Its connection.
+ */
+void GrocerServer::ReadClient(int fd, Connection& connection) {
+	char buffer[16384];
+	while (!connection.inputClosed && connection.input.size() < INPUT_HIGH_WATER) {
+		ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+		if (received > 0) {
+			connection.input.append(buffer, static_cast<size_t>(received));
+			size_t lastNewline = connection.input.rfind('\n');
+			size_t partialSize = connection.input.size() -
+				((lastNewline == string::npos) ? 0 : lastNewline + 1);
+			if (partialSize > MAX_REQUEST_SIZE) {
+				connection.input.resize(connection.input.size() - partialSize);
+				connection.input += "\n";
+				connection.requestTooLong = true;
+				connection.inputClosed = true;
+			}
+		}
+		else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		}
+		else if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		else {
+			connection.inputClosed = true;
+		}
+	}
+}
+
+/**
+ * Hand a connection's next request line to the workers, unless one is already with them or
+ * OUTPUT_HIGH_WATER bytes of replies are waiting to be written. Blank lines are skipped. Once
+ * the input is closed, a last line without a newline counts too, and an over-long request is
+ * answered with ERR after every request before it.
+ *
+ * @param fd Client socket.
+ * @param connection Its connection.
+ */
+void GrocerServer::DispatchNext(int fd, Connection& connection) {
+	while (!connection.busy && !connection.input.empty() &&
+		   connection.output.size() < OUTPUT_HIGH_WATER) {
+		size_t lineEnd = connection.input.find('\n');
+		if (lineEnd == string::npos) {
+			if (!connection.inputClosed) {
+				return;
+			}
+			lineEnd = connection.input.size();
+		}
+		string request = connection.input.substr(0, lineEnd);
+		connection.input.erase(0, min(lineEnd + 1, connection.input.size()));
+		if (LineScanner::Trim(request).empty()) {
+			continue;
+		}
+
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_tasks.push_back(Task{ fd, connection.id, move(request) });
+		}
+		m_queueChanged.notify_one();
+		connection.busy = true;
+	}
+
+	if (!connection.busy && connection.input.empty() && connection.requestTooLong) {
+		connection.output += "ERR request too long\n";
+		connection.requestTooLong = false;
+	}
+}
+
+/**
+ * Write as much of a connection's pending reply as the socket takes, dispatch its next request
+ * if that brought the output under OUTPUT_HIGH_WATER, then update what the connection is watched
+ * for (see WatchClient()).
+ *
+ * @param fd Client socket.
+ * @param epollFd Event loop's epoll instance.
+ * @param connection Its connection.
+ * @return false if the connection should be closed: it failed, or the client has stopped sending
+ * and every reply has been written.
+ */
+bool GrocerServer::WriteClient(int fd, int epollFd, Connection& connection) {
+	size_t written = 0;
+	while (written < connection.output.size()) {
+		ssize_t sent = send(fd, connection.output.data() + written,
+							connection.output.size() - written, MSG_NOSIGNAL);
+		if (sent > 0) {
+			written += static_cast<size_t>(sent);
+		}
+		else if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		else {
+			return false;
+		}
+	}
+	connection.output.erase(0, written);
+	DispatchNext(fd, connection);
+	if (connection.output.empty() && connection.inputClosed && !connection.busy &&
+		connection.input.empty()) {
+		return false;
+	}
+
+	WatchClient(fd, epollFd, connection);
+	return true;
+}
+
+/**
+ * Watch a connection for input until the client stops sending, except while its input or output
+ * is over its high-water mark, and for writability only while a reply is waiting: level-triggered
+ * events nobody handles would wake the loop on every pass. A connection watched for neither
+ * (input closed or full, a request with the workers) is taken out of the epoll set, since a
+ * hung-up socket reports EPOLLHUP whatever it is watched for.
+ *
+ * @param fd Client socket.
+ * @param epollFd Event loop's epoll instance.
+ * @param connection Its connection.
+ */
+void GrocerServer::WatchClient(int fd, int epollFd, Connection& connection) {
+	bool readable = !connection.inputClosed && connection.input.size() < INPUT_HIGH_WATER &&
+		connection.output.size() < OUTPUT_HIGH_WATER;
+	uint32_t events = (readable ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u)
+		| (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+	if (events == connection.events) {
+		return;
+	}
+
+	epoll_event event = {};
+	event.events = events;
+	event.data.fd = fd;
+	if (events == 0) {
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	}
+	else {
+		epoll_ctl(epollFd, (connection.events == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event);
+	}
+	connection.events = events;
+}
+
+/**
+ * Collect the workers' replies, queue each on its connection (if the client is still there),
+ * and dispatch each connection's next request.
+ *
+ * @param epollFd Event loop's epoll instance.
+ */
+void GrocerServer::DeliverReplies(int epollFd) {
+	uint64_t wakeCount;
+	ssize_t readSize = read(m_wakeFd, &wakeCount, sizeof(wakeCount));
+	(void)readSize;
+
+	deque<Task> replies;
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		replies.swap(m_replies);
+	}
+	for (Task& reply : replies) {
+		auto found = m_connections.find(reply.fd);
+		// The client may have gone, and its descriptor been reused by a new one.
+		if (found == m_connections.end() || found->second.id != reply.connectionId) {
+			continue;
+		}
+		Connection& connection = found->second;
+		connection.output += reply.request;
+		connection.busy = false;
+		DispatchNext(reply.fd, connection);
+		if (!WriteClient(reply.fd, epollFd, connection)) {
+			epoll_ctl(epollFd, EPOLL_CTL_DEL, reply.fd, nullptr);
+			close(reply.fd);
+			m_connections.erase(found);
+		}
+	}
+}
+
+#endif
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Number of worker threads answering requests, 0 for one per hardware thread.
+ */
+unsigned int GrocerServer::GetWorkerCount() {
+	return m_workerCount;
+}
+/**
+ * @param workerCount Number of worker threads answering requests, 0 for one per hardware
+ * thread. Takes effect at the next Run().
+ */
+void GrocerServer::SetWorkerCount(unsigned int workerCount) {
+	m_workerCount = workerCount;
+}
+
+/**
+ * @return Maximum number of threads scanning each file.
+ */
+unsigned int GrocerServer::GetThreadCount() {
+	return m_threadCount;
+}
+/**
+ * @param threadCount Maximum number of threads scanning each file, 0 for one per hardware thread.
+ */
+void GrocerServer::SetThreadCount(unsigned int threadCount) {
+	m_threadCount = threadCount;
+}
+
+/**
+ * @return Seconds between refreshes of the served counts, 0 if never refreshed.
+ */
+unsigned int GrocerServer::GetRefreshSeconds() {
+	return m_refreshSeconds;
+}
+/**
+ * @param refreshSeconds Seconds between refreshes of the served counts, 0 to never refresh.
+ * Takes effect at the next Run().
+ */
+void GrocerServer::SetRefreshSeconds(unsigned int refreshSeconds) {
+	m_refreshSeconds = refreshSeconds;
+}
+
+/**
+ * @return Longest bar in CHART replies, in characters. 0 if bars are never scaled.
+ */
+size_t GrocerServer::GetChartWidth() {
+	return m_chartWidth;
+}
+/**
+ * @param barWidth Longest bar in CHART replies, in characters. 0 never scales: one * per purchase.
+ */
+void GrocerServer::SetChartWidth(size_t barWidth) {
+	m_chartWidth = barWidth;
+}
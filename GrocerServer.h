@@ -0,0 +1,118 @@
+/**
+ * GrocerServer.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See GrocerServer.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef GROCERSERVER_H
+#define GROCERSERVER_H
+
+#include "PurchaseIndex.h"
+#include "HistogramWriter.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class GrocerServer {
+public:
+	static const size_t MAX_REQUEST_SIZE = 64 * 1024;
+	/* A connection isn't read from while this much input waits to be dispatched... */
+	static const size_t INPUT_HIGH_WATER = 4 * MAX_REQUEST_SIZE;
+	/* ...or while this much output waits to be written; nor are more requests dispatched. */
+	static const size_t OUTPUT_HIGH_WATER = 1024 * 1024;
+	static const unsigned int DEFAULT_REFRESH_SECONDS = 5;
+
+	GrocerServer(const vector<string>& inputs, const string& socketPath);
+	~GrocerServer();
+	GrocerServer(const GrocerServer&) = delete;
+	GrocerServer& operator=(const GrocerServer&) = delete;
+
+	bool Run();
+	void Stop();
+	bool Refresh();
+	string HandleRequest(const string& request);
+
+	unsigned int GetWorkerCount();
+	void SetWorkerCount(unsigned int workerCount);
+	unsigned int GetThreadCount();
+	void SetThreadCount(unsigned int threadCount);
+	unsigned int GetRefreshSeconds();
+	void SetRefreshSeconds(unsigned int refreshSeconds);
+	size_t GetChartWidth();
+	void SetChartWidth(size_t barWidth);
+
+private:
+	/* A request line read from a client, and the connection to answer. */
+	struct Task {
+		int fd;
+		unsigned long long connectionId;
+		string request;
+	};
+
+	/* A client connection, owned by the event loop. At most one request per connection is with
+	 * the workers at a time, so replies are sent in request order. */
+	struct Connection {
+		unsigned long long id;
+		string input;			// Bytes read but not yet dispatched.
+		string output;			// Reply bytes not yet written.
+		bool busy;				// A request is with the workers.
+		bool inputClosed;		// The client has stopped sending.
+		bool requestTooLong;	// Input was cut at an over-long request; ERR after the rest.
+		uint32_t events;		// Events watched with epoll, 0 if not watched.
+	};
+
+	void WorkerLoop();
+	void RefreshLoop();
+	void AcceptClients(int listenFd, int epollFd);
+	void ReadClient(int fd, Connection& connection);
+	void DispatchNext(int fd, Connection& connection);
+	bool WriteClient(int fd, int epollFd, Connection& connection);
+	void WatchClient(int fd, int epollFd, Connection& connection);
+	void DeliverReplies(int epollFd);
+	string FormatCounts(const vector<uint32_t>& ids, size_t count);
+
+	vector<string> m_inputs;
+	string m_socketPath;
+	unsigned int m_workerCount;
+	unsigned int m_threadCount;
+	unsigned int m_refreshSeconds;
+	size_t m_chartWidth;
+
+	/* Per-file indexes, used only by Refresh(). */
+	mutex m_refreshMutex;
+	map<string, PurchaseIndex> m_fileIndexes;
+
+	/* What requests are answered from, replaced as a whole by Refresh(). */
+	shared_mutex m_countsMutex;
+	PurchaseIndex m_counts;
+	vector<uint32_t> m_ranking;		// Item IDs of m_counts, best sellers first.
+	vector<pair<string, unsigned long long>> m_fileTotals;
+
+	/* Requests waiting for a worker, and replies waiting for the event loop. */
+	mutex m_queueMutex;
+	condition_variable m_queueChanged;
+	condition_variable m_stopRequested;		// Wakes the refresh thread to stop.
+	deque<Task> m_tasks;
+	deque<Task> m_replies;
+	bool m_stoppingWorkers;
+
+	atomic<bool> m_stopping;
+	atomic<int> m_wakeFd;
+	map<int, Connection> m_connections;
+	unsigned long long m_nextConnectionId;
+};
+
+#endif
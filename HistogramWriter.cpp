@@ -0,0 +1,306 @@
+/**
+ * HistogramWriter.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Renders purchase counts from one or more PurchaseIndex objects as the histogram of menu option
+ * three, or as CSV or a compact binary file for other tools. Output is built in one buffer
+ * (GetOutput()) so it can be printed or saved with a single write, and its size depends on the
+ * number of distinct items, not the number of purchases.
+ *
+ * Formats:
+ * - Text: one line per item, names padded to the longest name, as ChartItems in PythonCode.py:
+ *   Item1 .....| ***
+ *   ItemsLength| ***
+ *   If the largest count is more than the bar width, bars are scaled so the largest is exactly
+ *   the bar width (every item keeps at least one *) and each line ends with the exact count:
+ *   Item1 .....| ************************************************************ 81234
+ *   Otherwise, or with a bar width of 0, there is one * per purchase and the output matches
+ *   ChartItems byte-for-byte. With SetSectionHeaders(true), each section starts "== source ==".
+ * - Csv: a "source,item,count" header line, then one row per item (RFC 4180 quoting).
+ * - Binary: little-endian, for programs that read counts directly:
+ *     char[4]  "CGHF"
+ *     uint32   format version (1)
+ *     uint32   number of sections
+ *     then per section:
+ *       uint32 source length, then the source name
+ *       uint64 number of items
+ *       then per item: uint32 name length, the name, uint64 count
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "HistogramWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+
+/* First bytes of every binary histogram. */
+static const char BINARY_MAGIC[4] = { 'C', 'G', 'H', 'F' };
+/* Version written after the magic. Bump when the binary layout changes. */
+static const uint32_t BINARY_VERSION = 1;
+/* Offset of the section count in a binary histogram. */
+static const size_t BINARY_SECTION_COUNT_OFFSET = sizeof(BINARY_MAGIC) + sizeof(uint32_t);
+
+/* Append an integer to a buffer, little-endian. */
+template <typename T>
+static void AppendValue(string& buffer, T value) {
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		buffer += static_cast<char>((static_cast<unsigned long long>(value) >> (8 * i)) & 0xFF);
+	}
+}
+
+/**
+ * Constructor.
+ *
+ * @param format Output format.
+ * @param barWidth Longest bar in a Text histogram before bars are scaled. 0 never scales.
+ */
+HistogramWriter::HistogramWriter(Format format, size_t barWidth) {
+	m_format = format;
+	m_barWidth = barWidth;
+	m_sectionHeaders = false;
+	Clear();
+}
+
+/**
+ * Discard the output built so far.
+ */
+void HistogramWriter::Clear() {
+	m_output.clear();
+	m_sectionCount = 0;
+
+	if (m_format == Format::Csv) {
+		m_output += "source,item,count\n";
+	}
+	else if (m_format == Format::Binary) {
+		m_output.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+		AppendValue(m_output, BINARY_VERSION);
+		AppendValue(m_output, static_cast<uint32_t>(0));
+	}
+}
+
+/**
+ * Add the counts in one index to the output, in the index's item order.
+ *
+ * @param source Name of the file (or rollup) the counts are from.
+ * @param index Counts to add.
+ */
+void HistogramWriter::AddSection(const string& source, const PurchaseIndex& index) {
+	++m_sectionCount;
+
+	if (m_format == Format::Csv) {
+		AddCsvSection(source, index);
+	}
+	else if (m_format == Format::Binary) {
+		AddBinarySection(source, index);
+	}
+	else {
+		AddTextSection(source, index);
+	}
+}
+
+/**
+ * @return Everything added since the last Clear(), in the set format.
+ */
+const string& HistogramWriter::GetOutput() const {
+	return m_output;
+}
+
+/**
+ * Write GetOutput() to a file with a single write. Text and CSV are written in text mode, as
+ * ChartItems writes frequency.dat; binary output is written byte for byte.
+ *
+ * @param fileName Name of the file to write (or overwrite).
+ *
+ * @return true if the whole output was written.
+ */
+bool HistogramWriter::WriteFile(const string& fileName) const {
+	ios::openmode mode = ios::out | ios::trunc;
+	if (m_format == Format::Binary) {
+		mode |= ios::binary;
+	}
+
+	ofstream outFS(fileName, mode);
+	return outFS.is_open() && outFS.write(m_output.data(), m_output.size()) && outFS.flush();
+}
+
+/**
+ * Add one section as Text. See top of file.
+ *
+ * @param source Name of the file the counts are from, for the section header.
+ * @param index Counts to add.
+ */
+void HistogramWriter::AddTextSection(const string& source, const PurchaseIndex& index) {
+	const vector<unsigned long long>& counts = index.GetCounts();
+	size_t itemLength = 0;
+	unsigned long long maxCount = 0;
+	for (uint32_t id = 0; id < counts.size(); ++id) {
+		itemLength = max(itemLength, index.ItemAt(id).size());
+		maxCount = max(maxCount, counts[id]);
+	}
+	bool scaled = m_barWidth != 0 && maxCount > m_barWidth;
+
+	if (m_sectionHeaders) {
+		m_output += "== " + source + " ==\n";
+	}
+	for (uint32_t id = 0; id < counts.size(); ++id) {
+		string_view item = index.ItemAt(id);
+		size_t spaceWidth = itemLength - item.size();
+
+		m_output += item;
+		m_output.append(spaceWidth, (spaceWidth > 1) ? '.' : ' ');
+		m_output += "| ";
+		if (!scaled) {
+			m_output.append(counts[id], '*');
+		}
+		else {
+			double barLength = round(static_cast<double>(counts[id]) * m_barWidth / maxCount);
+			m_output.append(max<size_t>(static_cast<size_t>(barLength), 1), '*');
+			m_output += ' ';
+			m_output += to_string(counts[id]);
+		}
+		m_output += '\n';
+	}
+}
+
+/**
+ * Add one section as CSV rows.
+ *
+ * @param source Name of the file the counts are from, for the source column.
+ * @param index Counts to add.
+ */
+void HistogramWriter::AddCsvSection(const string& source, const PurchaseIndex& index) {
+	const vector<unsigned long long>& counts = index.GetCounts();
+	for (uint32_t id = 0; id < counts.size(); ++id) {
+		AppendCsvField(source);
+		m_output += ',';
+		AppendCsvField(index.ItemAt(id));
+		m_output += ',';
+		m_output += to_string(counts[id]);
+		m_output += '\n';
+	}
+}
+
+/**
+ * Add one section in the binary format, and update the section count in the header.
+ *
+ * @param source Name of the file the counts are from.
+ * @param index Counts to add.
+ */
+void HistogramWriter::AddBinarySection(const string& source, const PurchaseIndex& index) {
+	const vector<unsigned long long>& counts = index.GetCounts();
+	AppendValue(m_output, static_cast<uint32_t>(source.size()));
+	m_output += source;
+	AppendValue(m_output, static_cast<unsigned long long>(counts.size()));
+	for (uint32_t id = 0; id < counts.size(); ++id) {
+		string_view item = index.ItemAt(id);
+		AppendValue(m_output, static_cast<uint32_t>(item.size()));
+		m_output += item;
+		AppendValue(m_output, counts[id]);
+	}
+
+	string sectionCount;
+	AppendValue(sectionCount, static_cast<uint32_t>(m_sectionCount));
+	m_output.replace(BINARY_SECTION_COUNT_OFFSET, sectionCount.size(), sectionCount);
+}
+
+/**
+ * Append one CSV field, quoted if it contains a comma, quote, or line break.
+ *
+ * @param field Field contents.
+ */
+void HistogramWriter::AppendCsvField(string_view field) {
+	if (field.find_first_of(",\"\r\n") == string_view::npos) {
+		m_output += field;
+		return;
+	}
+
+	m_output += '"';
+	for (char c : field) {
+		if (c == '"') {
+			m_output += '"';
+		}
+		m_output += c;
+	}
+	m_output += '"';
+}
+
+/**
+ * Read a format name as given on the command line.
+ *
+ * @param formatName "text", "csv", or "binary".
+ * @param format Receives the format.
+ *
+ * @return true if the name was recognized.
+ */
+bool HistogramWriter::ParseFormat(const string& formatName, Format& format) {
+	if (formatName == "text") {
+		format = Format::Text;
+	}
+	else if (formatName == "csv") {
+		format = Format::Csv;
+	}
+	else if (formatName == "binary") {
+		format = Format::Binary;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Output format.
+ */
+HistogramWriter::Format HistogramWriter::GetFormat() const {
+	return m_format;
+}
+
+/**
+ * Set the output format. Clears the output built so far.
+ *
+ * @param format Output format.
+ */
+void HistogramWriter::SetFormat(Format format) {
+	m_format = format;
+	Clear();
+}
+
+/**
+ * @return Longest bar in a Text histogram before bars are scaled, 0 if bars are never scaled.
+ */
+size_t HistogramWriter::GetBarWidth() const {
+	return m_barWidth;
+}
+
+/**
+ * Set the longest bar in a Text histogram. Sections with a larger count are scaled to fit.
+ *
+ * @param barWidth Bar width in characters. 0 never scales: one * per purchase.
+ */
+void HistogramWriter::SetBarWidth(size_t barWidth) {
+	m_barWidth = barWidth;
+}
+
+/**
+ * @return true if Text sections start with a "== source ==" line.
+ */
+bool HistogramWriter::GetSectionHeaders() const {
+	return m_sectionHeaders;
+}
+
+/**
+ * Set whether Text sections start with a "== source ==" line. CSV and binary output always
+ * name each row's or section's source.
+ *
+ * @param sectionHeaders true to print section headers.
+ */
+void HistogramWriter::SetSectionHeaders(bool sectionHeaders) {
+	m_sectionHeaders = sectionHeaders;
+}
@@ -0,0 +1,55 @@
+/**
+ * HistogramWriter.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See HistogramWriter.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef HISTOGRAMWRITER_H
+#define HISTOGRAMWRITER_H
+
+#include "PurchaseIndex.h"
+#include <string>
+
+using namespace std;
+
+class HistogramWriter {
+public:
+	enum class Format { Text, Csv, Binary };
+
+	static const size_t DEFAULT_BAR_WIDTH = 60;
+
+	HistogramWriter(Format format = Format::Text, size_t barWidth = DEFAULT_BAR_WIDTH);
+
+	void Clear();
+	void AddSection(const string& source, const PurchaseIndex& index);
+	const string& GetOutput() const;
+	bool WriteFile(const string& fileName) const;
+
+	Format GetFormat() const;
+	void SetFormat(Format format);
+	size_t GetBarWidth() const;
+	void SetBarWidth(size_t barWidth);
+	bool GetSectionHeaders() const;
+	void SetSectionHeaders(bool sectionHeaders);
+
+	static bool ParseFormat(const string& formatName, Format& format);
+
+private:
+	void AddTextSection(const string& source, const PurchaseIndex& index);
+	void AddCsvSection(const string& source, const PurchaseIndex& index);
+	void AddBinarySection(const string& source, const PurchaseIndex& index);
+	void AppendCsvField(string_view field);
+
+	Format m_format;
+	size_t m_barWidth;
+	bool m_sectionHeaders;
+	size_t m_sectionCount;
+	string m_output;
+};
+
+#endif
@@ -0,0 +1,452 @@
+/**
+ * IngestPipeline.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Counts purchases from many sources at once into one PurchaseIndex, e.g. the live feeds of
+ * every register lane of a store, without first concatenating them into one file. A source may be
+ * a regular file, a FIFO (named pipe) that a register writes to, or standard input (STDIN_NAME).
+ *
+ * Design:
+ * - One producer thread per source reads it in large chunks and splits and trims the lines with
+ * a LineScanner, as PurchaseIndex does, so sources are parsed in parallel. Lines are copied end
+ * to end into fixed-size blocks (at most BLOCK_LINES lines and BLOCK_BYTES bytes).
+ * - A full block, or a source's last one, is pushed onto a bounded lock-free queue to the
+ * aggregator, which runs on the thread that called Run() and counts each line into the index.
+ * Only the aggregator touches the index, so it needs no lock.
+ * - Blocks are allocated once per Run() and recycled: the aggregator pushes each emptied block
+ * onto a free list (a second queue of the same kind), and producers take blocks from it. So memory
+ * is fixed at GetQueueBlocks() blocks however much is read, and the filled queue can never
+ * overflow.
+ * - When the aggregator falls behind, the free list runs out and producers wait for it to catch
+ * up, rather than reading ahead without bound. When the sources fall behind (e.g. quiet lanes),
+ * the aggregator waits. Waiting threads yield, then sleep briefly, so an idle pipeline doesn't
+ * spin a core.
+ *
+ * Counting matches PurchaseIndex::LoadFile() line for line, but items are numbered in the order
+ * they first reach the aggregator, which depends on how the sources' reads interleave. Lines
+ * longer than BLOCK_BYTES don't fit in a block and are skipped, and counted in the source's stats.
+ *
+ * Backpressure is measured on both sides: for each source, how often and how long it waited for
+ * a free block, and for the aggregator, how often and how long it waited for a filled block and
+ * how full the queue was. GetStats() has the numbers and FormatStats() summarizes them. With
+ * LatencyStats enabled, each wait is also recorded as pipeline.block_wait or pipeline.queue_wait.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "IngestPipeline.h"
+#include "LatencyStats.h"
+#include "LineScanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+const char* const IngestPipeline::STDIN_NAME = "-";
+
+/* Bytes a producer reads at a time. Grown if one line is longer. */
+static const size_t READ_BYTES = 256 * 1024;
+/* Lines a producer gets from its LineScanner at a time. */
+static const size_t SCAN_BATCH_LINES = 256;
+/* A waiting thread yields this many times, then sleeps WAIT_SLEEP between checks. */
+static const unsigned int WAIT_YIELDS = 64;
+static const chrono::microseconds WAIT_SLEEP(100);
+
+/**
+ * Default constructor. DEFAULT_QUEUE_BLOCKS blocks.
+ */
+IngestPipeline::IngestPipeline() {
+	m_queueBlocks = DEFAULT_QUEUE_BLOCKS;
+	m_stats = Stats();
+	m_activeProducers.store(0, memory_order_relaxed);
+}
+
+/**
+ * Read every source to its end, each on its own thread, and count all their purchases into one
+ * index. Returns once every source has ended: for a FIFO, once every writer has closed it.
+ *
+ * @param sourceNames Files or FIFOs to read, or STDIN_NAME for standard input.
+ * @param index Index to add the purchases to. Items already in it are kept.
+ *
+ * @return true if every source was read to its end, false if any couldn't be opened or read. The
+ * purchases read from the others are counted either way; see GetStats() for which failed.
+ */
+bool IngestPipeline::Run(const vector<string>& sourceNames, PurchaseIndex& index) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	// A power of two for the queues, with at least two blocks per source, so one producer can
+	// fill a block while its last one is queued.
+	size_t queueBlocks = 2;
+	while (queueBlocks < max(m_queueBlocks, 2 * sourceNames.size())) {
+		queueBlocks *= 2;
+	}
+
+	m_stats = Stats();
+	m_stats.queueBlocks = queueBlocks;
+	for (const string& sourceName : sourceNames) {
+		SourceStats source = SourceStats();
+		source.name = sourceName;
+		m_stats.sources.push_back(source);
+	}
+
+	unique_ptr<Block[]> blocks(new Block[queueBlocks]);
+	BlockQueue filledBlocks(queueBlocks);
+	BlockQueue freeBlocks(queueBlocks);
+	for (size_t i = 0; i < queueBlocks; ++i) {
+		freeBlocks.TryPush(&blocks[i]);
+	}
+
+	m_activeProducers.store(sourceNames.size(), memory_order_relaxed);
+	vector<thread> producers;
+	for (size_t source = 0; source < sourceNames.size(); ++source) {
+		producers.emplace_back(&IngestPipeline::Produce, this, source, ref(filledBlocks),
+							   ref(freeBlocks));
+	}
+
+	unsigned long long depthTotal = 0;
+	bool waiting = false;
+	unsigned int attempt = 0;
+	chrono::steady_clock::time_point waitStart;
+	while (true) {
+		// Read before popping: if every producer had finished, every block they pushed is visible.
+		bool producersDone = m_activeProducers.load(memory_order_acquire) == 0;
+		Block* block;
+		if (!filledBlocks.TryPop(block)) {
+			if (producersDone) {
+				break;
+			}
+			if (!waiting) {
+				waiting = true;
+				attempt = 0;
+				waitStart = chrono::steady_clock::now();
+				++m_stats.waits;
+			}
+			Backoff(attempt);
+			continue;
+		}
+
+		if (waiting) {
+			waiting = false;
+			chrono::nanoseconds waited = chrono::steady_clock::now() - waitStart;
+			m_stats.waitSeconds += chrono::duration<double>(waited).count();
+			if (LatencyStats::IsEnabled()) {
+				LatencyStats::Record(LatencyStats::Metric::PipelineQueueWait, waited.count());
+			}
+		}
+		size_t depth = filledBlocks.Depth() + 1;
+		m_stats.maxQueueDepth = max(m_stats.maxQueueDepth, depth);
+		depthTotal += depth;
+
+		size_t lineBegin = 0;
+		for (size_t i = 0; i < block->lineCount; ++i) {
+			index.AddPurchase(string_view(block->text + lineBegin, block->lineEnds[i] - lineBegin));
+			lineBegin = block->lineEnds[i];
+		}
+		m_stats.lines += block->lineCount;
+		++m_stats.blocks;
+		freeBlocks.TryPush(block);
+	}
+
+	for (thread& producer : producers) {
+		producer.join();
+	}
+	m_stats.meanQueueDepth = (m_stats.blocks == 0) ? 0
+		: static_cast<double>(depthTotal) / m_stats.blocks;
+	m_stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	bool allRead = true;
+	for (const SourceStats& source : m_stats.sources) {
+		allRead = allRead && source.read;
+	}
+	return allRead;
+}
+
+/**
+ * Read one source to its end and queue its lines in blocks. Runs on the source's own thread and
+ * only writes the source's own stats.
+ *
+ * @param source Index of the source in m_stats.sources.
+ * @param filledBlocks Queue to the aggregator.
+ * @param freeBlocks Free list to take empty blocks from.
+ */
+void IngestPipeline::Produce(size_t source, BlockQueue& filledBlocks, BlockQueue& freeBlocks) {
+	SourceStats& stats = m_stats.sources[source];
+	bool fromStdin = stats.name == STDIN_NAME;
+	FILE* input = fromStdin ? stdin : fopen(stats.name.c_str(), "rb");
+
+	if (input != nullptr) {
+		string buffer(READ_BYTES, '\0');
+		size_t held = 0;	// Bytes of an unfinished line kept from the last read.
+		Block* block = nullptr;
+		string_view lines[SCAN_BATCH_LINES];
+		size_t lineCount;
+
+		auto queueBlock = [&]() {
+			// Never full: it has a cell for every block.
+			filledBlocks.TryPush(block);
+			++stats.blocks;
+			block = nullptr;
+		};
+
+		while (true) {
+			if (held == buffer.size()) {
+				buffer.resize(buffer.size() * 2);
+			}
+			size_t got = fread(&buffer[held], 1, buffer.size() - held, input);
+			stats.bytes += got;
+
+			// Scan up to the last complete line, or everything once the source has ended.
+			size_t end = held + got;
+			size_t scanEnd = end;
+			if (got != 0) {
+				while (scanEnd > held && buffer[scanEnd - 1] != '\n') {
+					--scanEnd;
+				}
+				if (scanEnd == held) {
+					scanEnd = 0;
+				}
+			}
+
+			LineScanner scanner(string_view(buffer.data(), scanEnd));
+			while ((lineCount = scanner.NextBatch(lines, SCAN_BATCH_LINES)) > 0) {
+				for (size_t i = 0; i < lineCount; ++i) {
+					string_view line = lines[i];
+					if (line.size() > BLOCK_BYTES) {
+						++stats.longLines;
+						continue;
+					}
+					size_t lineBegin = (block == nullptr || block->lineCount == 0) ? 0
+						: block->lineEnds[block->lineCount - 1];
+					if (block != nullptr && (block->lineCount == BLOCK_LINES ||
+											 lineBegin + line.size() > BLOCK_BYTES)) {
+						queueBlock();
+						lineBegin = 0;
+					}
+					if (block == nullptr) {
+						block = TakeBlock(freeBlocks, stats);
+						block->lineCount = 0;
+					}
+					memcpy(block->text + lineBegin, line.data(), line.size());
+					block->lineEnds[block->lineCount++] =
+						static_cast<uint32_t>(lineBegin + line.size());
+					++stats.lines;
+				}
+			}
+
+			held = end - scanEnd;
+			memmove(&buffer[0], &buffer[scanEnd], held);
+			if (got == 0) {
+				break;
+			}
+		}
+
+		if (block != nullptr) {
+			queueBlock();
+		}
+		stats.read = ferror(input) == 0;
+		if (!fromStdin) {
+			fclose(input);
+		}
+	}
+
+	m_activeProducers.fetch_sub(1, memory_order_release);
+}
+
+/**
+ * Take an empty block from the free list, waiting for the aggregator to return one if there are
+ * none.
+ *
+ * @param freeBlocks Free list.
+ * @param stats Stats of the source taking the block, to count any wait in.
+ *
+ * @return Empty block.
+ */
+IngestPipeline::Block* IngestPipeline::TakeBlock(BlockQueue& freeBlocks, SourceStats& stats) {
+	Block* block;
+	if (freeBlocks.TryPop(block)) {
+		return block;
+	}
+
+	chrono::steady_clock::time_point waitStart = chrono::steady_clock::now();
+	unsigned int attempt = 0;
+	do {
+		Backoff(attempt);
+	} while (!freeBlocks.TryPop(block));
+	chrono::nanoseconds waited = chrono::steady_clock::now() - waitStart;
+	++stats.waits;
+	stats.waitSeconds += chrono::duration<double>(waited).count();
+	if (LatencyStats::IsEnabled()) {
+		LatencyStats::Record(LatencyStats::Metric::PipelineBlockWait, waited.count());
+	}
+	return block;
+}
+
+/**
+ * Wait a little before checking a queue again: yield at first, then sleep.
+ *
+ * @param attempt Number of waits so far; incremented.
+ */
+void IngestPipeline::Backoff(unsigned int& attempt) {
+	if (attempt++ < WAIT_YIELDS) {
+		this_thread::yield();
+	}
+	else {
+		this_thread::sleep_for(WAIT_SLEEP);
+	}
+}
+
+/**
+ * @return Summary of the last Run(): totals and queue use, then each source's line, one per line.
+ */
+string IngestPipeline::FormatStats() const {
+	ostringstream summary;
+	summary << fixed << setprecision(3);
+	summary << "Pipeline: " << m_stats.lines << " lines from " << m_stats.sources.size()
+			<< " sources in " << m_stats.seconds << " s, " << m_stats.blocks
+			<< " blocks through a queue of " << m_stats.queueBlocks << ".\n";
+	summary << "Queue depth mean " << setprecision(1) << m_stats.meanQueueDepth << ", max "
+			<< m_stats.maxQueueDepth << ". Aggregator waited for a block " << m_stats.waits
+			<< " times (" << setprecision(3) << m_stats.waitSeconds << " s).\n";
+	for (const SourceStats& source : m_stats.sources) {
+		summary << "  " << source.name << ": " << source.lines << " lines, " << source.blocks
+				<< " blocks, waited for a free block " << source.waits << " times ("
+				<< source.waitSeconds << " s).";
+		if (source.longLines > 0) {
+			summary << " Skipped " << source.longLines << " lines over " << BLOCK_BYTES
+					<< " bytes.";
+		}
+		if (!source.read) {
+			summary << " Couldn't be read.";
+		}
+		summary << '\n';
+	}
+	return summary.str();
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * Accessor for what the last Run() did.
+ *
+ * @return Stats of the last Run(), including its backpressure measures.
+ */
+const IngestPipeline::Stats& IngestPipeline::GetStats() const {
+	return m_stats;
+}
+
+/**
+ * Accessor for the number of blocks in the queue.
+ *
+ * @return Blocks as set. Run() rounds up to a power of two of at least two per source.
+ */
+size_t IngestPipeline::GetQueueBlocks() const {
+	return m_queueBlocks;
+}
+/**
+ * Mutator for the number of blocks in the queue. More blocks let sources read further ahead of
+ * the aggregator, at the cost of about BLOCK_BYTES + 4 * BLOCK_LINES bytes of memory each.
+ *
+ * @param queueBlocks Number of blocks.
+ */
+void IngestPipeline::SetQueueBlocks(size_t queueBlocks) {
+	this->m_queueBlocks = queueBlocks;
+}
+
+/* -------------------- BlockQueue -------------------- */
+
+/**
+ * Constructor. Creates an empty queue.
+ *
+ * @param capacity Most blocks held at once. A power of two.
+ */
+IngestPipeline::BlockQueue::BlockQueue(size_t capacity) {
+	m_cells.reset(new Cell[capacity]);
+	m_mask = capacity - 1;
+	for (size_t i = 0; i < capacity; ++i) {
+		m_cells[i].sequence.store(i, memory_order_relaxed);
+		m_cells[i].block = nullptr;
+	}
+	m_pushPosition.store(0, memory_order_relaxed);
+	m_popPosition.store(0, memory_order_relaxed);
+}
+
+/**
+ * Add a block at the back of the queue, unless it is full. Thread safe.
+ *
+ * @param block Block to add.
+ *
+ * @return true if added, false if the queue is full.
+ */
+bool IngestPipeline::BlockQueue::TryPush(Block* block) {
+	size_t position = m_pushPosition.load(memory_order_relaxed);
+	while (true) {
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.sequence.load(memory_order_acquire);
+		// The cell is free for this position, still holds the block from a lap ago (full), or
+		// another thread already pushed at this position.
+		ptrdiff_t lag = static_cast<ptrdiff_t>(sequence - position);
+		if (lag == 0) {
+			if (m_pushPosition.compare_exchange_weak(position, position + 1,
+													 memory_order_relaxed)) {
+				cell.block = block;
+				cell.sequence.store(position + 1, memory_order_release);
+				return true;
+			}
+		}
+		else if (lag < 0) {
+			return false;
+		}
+		else {
+			position = m_pushPosition.load(memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * Remove the block at the front of the queue, unless it is empty. Thread safe.
+ *
+ * @param block Receives the block removed.
+ *
+ * @return true if a block was removed, false if the queue is empty.
+ */
+bool IngestPipeline::BlockQueue::TryPop(Block*& block) {
+	size_t position = m_popPosition.load(memory_order_relaxed);
+	while (true) {
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.sequence.load(memory_order_acquire);
+		// The cell holds the block for this position, hasn't been pushed to yet (empty), or
+		// another thread already popped at this position.
+		ptrdiff_t lag = static_cast<ptrdiff_t>(sequence - (position + 1));
+		if (lag == 0) {
+			if (m_popPosition.compare_exchange_weak(position, position + 1,
+													memory_order_relaxed)) {
+				block = cell.block;
+				cell.sequence.store(position + m_mask + 1, memory_order_release);
+				return true;
+			}
+		}
+		else if (lag < 0) {
+			return false;
+		}
+		else {
+			position = m_popPosition.load(memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @return Number of blocks in the queue. Only a snapshot while other threads push and pop.
+ */
+size_t IngestPipeline::BlockQueue::Depth() const {
+	size_t popPosition = m_popPosition.load(memory_order_relaxed);
+	size_t pushPosition = m_pushPosition.load(memory_order_relaxed);
+	return (pushPosition > popPosition) ? pushPosition - popPosition : 0;
+}
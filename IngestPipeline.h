@@ -0,0 +1,114 @@
+/**
+ * IngestPipeline.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See IngestPipeline.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include "PurchaseIndex.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class IngestPipeline {
+public:
+	/* Source name that reads standard input. */
+	static const char* const STDIN_NAME;
+	/* Most bytes of item names in one block. Longer lines are skipped (see SourceStats). */
+	static const size_t BLOCK_BYTES = 64 * 1024;
+	/* Most lines in one block. */
+	static const size_t BLOCK_LINES = 4096;
+	/* Blocks in the queue, unless set otherwise. */
+	static const size_t DEFAULT_QUEUE_BLOCKS = 64;
+
+	/* What one source's producer thread did. A producer "waits" when every block is queued or
+	 * being filled, i.e. the aggregator is behind: the pipeline's backpressure. */
+	struct SourceStats {
+		string name;
+		bool read;						// Opened and read to the end without an error.
+		unsigned long long bytes;		// Bytes read.
+		unsigned long long lines;		// Lines passed to the aggregator.
+		unsigned long long longLines;	// Lines longer than BLOCK_BYTES, skipped.
+		unsigned long long blocks;		// Blocks queued.
+		unsigned long long waits;		// Times no free block was available.
+		double waitSeconds;				// Time spent waiting for a free block.
+	};
+
+	/* What the whole pipeline did in the last Run(). The aggregator "waits" when the queue is
+	 * empty, i.e. the sources are behind. */
+	struct Stats {
+		vector<SourceStats> sources;
+		unsigned long long lines;
+		unsigned long long blocks;
+		size_t queueBlocks;				// Blocks in the queue, as rounded by Run().
+		size_t maxQueueDepth;			// Most filled blocks queued at once.
+		double meanQueueDepth;			// Filled blocks queued, on average, when one is taken.
+		unsigned long long waits;		// Times the aggregator found the queue empty.
+		double waitSeconds;				// Time the aggregator spent waiting for a block.
+		double seconds;
+	};
+
+	IngestPipeline();
+
+	bool Run(const vector<string>& sourceNames, PurchaseIndex& index);
+
+	const Stats& GetStats() const;
+	string FormatStats() const;
+	size_t GetQueueBlocks() const;
+	void SetQueueBlocks(size_t queueBlocks);
+
+private:
+	/* Trimmed lines from one source, packed end to end: line i is text[lineEnds[i - 1]] up to
+	 * text[lineEnds[i]]. Blocks are allocated once per Run() and reused. */
+	struct Block {
+		size_t lineCount;
+		uint32_t lineEnds[BLOCK_LINES];
+		char text[BLOCK_BYTES];
+	};
+
+	/* Bounded lock-free queue of blocks (Dmitry Vyukov's array queue): each cell's sequence
+	 * number says whether it is free for the push at its position or holds the block for the pop
+	 * at its position, so pushers and poppers only contend on their own position counter. Safe
+	 * for any number of threads on either end; used with many producers and one consumer for
+	 * filled blocks, and the other way round for free ones. */
+	class BlockQueue {
+	public:
+		explicit BlockQueue(size_t capacity);
+
+		bool TryPush(Block* block);
+		bool TryPop(Block*& block);
+		size_t Depth() const;
+
+	private:
+		struct Cell {
+			atomic<size_t> sequence;
+			Block* block;
+		};
+
+		unique_ptr<Cell[]> m_cells;
+		size_t m_mask;
+		alignas(64) atomic<size_t> m_pushPosition;
+		alignas(64) atomic<size_t> m_popPosition;
+	};
+
+	void Produce(size_t source, BlockQueue& filledBlocks, BlockQueue& freeBlocks);
+	static Block* TakeBlock(BlockQueue& freeBlocks, SourceStats& stats);
+	static void Backoff(unsigned int& attempt);
+
+	size_t m_queueBlocks;
+	Stats m_stats;
+	atomic<size_t> m_activeProducers;
+};
+
+#endif
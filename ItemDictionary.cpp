@@ -0,0 +1,206 @@
+/**
+ * ItemDictionary.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * String-interning symbol table for item names. Each distinct name is given a dense uint32_t ID
+ * the first time it is interned: 0 for the first name, 1 for the second, and so on. So IDs are 
+ * also the order items were first seen, and per-item data (counts, rankings, histogram bars) can 
+ * be kept in flat arrays indexed by ID instead of in string-keyed maps.
+ *
+ * Storage is kept compact so large catalogs stay in cache:
+ * - All names are stored back to back in one string, with an offset per ID.
+ * - Lookups use an open-addressing hash table of IDs (load factor at most 1/2), checking a stored
+ * 32-bit hash per ID before comparing any name bytes.
+ *
+ * Use:
+ * - uint32_t id = dictionary.Intern(name); ++counts[id]; (grow counts when id == counts.size())
+ * - string_views from NameOf() point into the dictionary and are invalidated by Intern() and 
+ * Clear(). Copy the name if it must outlive the next Intern().
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "ItemDictionary.h"
+#include <cstring>
+
+using namespace std;
+
+/* Slot table size for a new dictionary. Always a power of two. */
+static const size_t INITIAL_SLOT_COUNT = 64;
+/* Value of an unused slot. Used slots hold ID + 1. */
+static const uint32_t EMPTY_SLOT = 0;
+
+/**
+ * Default constructor. Creates an empty dictionary.
+ */
+ItemDictionary::ItemDictionary() {
+	m_nameOffsets.push_back(0);
+	m_slots.assign(INITIAL_SLOT_COUNT, EMPTY_SLOT);
+}
+
+/**
+ * Get the ID of a name, assigning the next ID if the name hasn't been seen before.
+ *
+ * @param name Item name. Copied into the dictionary if new.
+ *
+ * @return ID of name. Equal to Size() - 1 if the name was just added.
+ */
+uint32_t ItemDictionary::Intern(string_view name) {
+	uint32_t hash = static_cast<uint32_t>(Hash(name));
+	uint32_t slot = FindSlot(name, hash);
+	if (m_slots[slot] != EMPTY_SLOT) {
+		return m_slots[slot] - 1;
+	}
+
+	uint32_t id = static_cast<uint32_t>(m_hashes.size());
+	m_names.append(name.data(), name.size());
+	m_nameOffsets.push_back(m_names.size());
+	m_hashes.push_back(hash);
+	m_slots[slot] = id + 1;
+
+	if (m_hashes.size() * 2 > m_slots.size()) {
+		Rehash(m_slots.size() * 2);
+	}
+	return id;
+}
+
+/**
+ * Get the ID of a name without adding it.
+ *
+ * @param name Item name. Must match exactly, including case.
+ *
+ * @return ID of name, or NO_ITEM if it hasn't been interned.
+ */
+uint32_t ItemDictionary::Find(string_view name) const {
+	uint32_t slot = FindSlot(name, static_cast<uint32_t>(Hash(name)));
+	return m_slots[slot] - 1;
+}
+
+/**
+ * @param id ID returned by Intern() or Find().
+ *
+ * @return Name with that ID. Valid until the next Intern() or Clear().
+ */
+string_view ItemDictionary::NameOf(uint32_t id) const {
+	return string_view(m_names.data() + m_nameOffsets[id], m_nameOffsets[id + 1] - m_nameOffsets[id]);
+}
+
+/**
+ * @return Number of distinct names interned. IDs run from 0 to Size() - 1.
+ */
+size_t ItemDictionary::Size() const {
+	return m_hashes.size();
+}
+
+/**
+ * Remove the most recently interned name, e.g. to undo counting a line that turned out to be 
+ * incomplete. Other IDs are unchanged. Does nothing if the dictionary is empty.
+ */
+void ItemDictionary::RemoveLast() {
+	if (m_hashes.empty()) {
+		return;
+	}
+
+	uint32_t id = static_cast<uint32_t>(m_hashes.size() - 1);
+	uint32_t mask = static_cast<uint32_t>(m_slots.size() - 1);
+	uint32_t gap = FindSlot(NameOf(id), m_hashes[id]);
+	m_slots[gap] = EMPTY_SLOT;
+
+	// Shift later entries of the probe run back into the gap if their home slot allows it, so 
+	// linear probing never stops early at the emptied slot.
+	for (uint32_t next = (gap + 1) & mask; m_slots[next] != EMPTY_SLOT; next = (next + 1) & mask) {
+		uint32_t home = m_hashes[m_slots[next] - 1] & mask;
+		if (((next - home) & mask) >= ((next - gap) & mask)) {
+			m_slots[gap] = m_slots[next];
+			m_slots[next] = EMPTY_SLOT;
+			gap = next;
+		}
+	}
+
+	m_names.resize(m_nameOffsets[id]);
+	m_nameOffsets.pop_back();
+	m_hashes.pop_back();
+}
+
+/**
+ * Remove every name. IDs start again from 0.
+ */
+void ItemDictionary::Clear() {
+	m_names.clear();
+	m_nameOffsets.assign(1, 0);
+	m_hashes.clear();
+	m_slots.assign(INITIAL_SLOT_COUNT, EMPTY_SLOT);
+}
+
+/**
+ * Hash a name 8 bytes at a time. Not stable across platforms; never store it.
+ *
+ * @param name Item name.
+ *
+ * @return 64-bit hash of name.
+ */
+uint64_t ItemDictionary::Hash(string_view name) {
+	const char* data = name.data();
+	size_t remaining = name.size();
+	uint64_t hash = 0x9E3779B97F4A7C15ULL ^ remaining;
+
+	while (remaining >= 8) {
+		uint64_t word;
+		memcpy(&word, data, 8);
+		hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+		hash ^= hash >> 31;
+		data += 8;
+		remaining -= 8;
+	}
+
+	uint64_t tail = 0;
+	if (remaining > 0) {
+		memcpy(&tail, data, remaining);
+	}
+	hash = (hash ^ tail) * 0x94D049BB133111EBULL;
+	hash ^= hash >> 29;
+	return hash;
+}
+
+/**
+ * Find the slot holding a name, or the empty slot where it would be inserted. Uses linear
+ * probing from the slot picked by the low bits of the hash.
+ *
+ * @param name Item name.
+ * @param hash Low 32 bits of Hash(name).
+ *
+ * @return Index into m_slots.
+ */
+uint32_t ItemDictionary::FindSlot(string_view name, uint32_t hash) const {
+	uint32_t mask = static_cast<uint32_t>(m_slots.size() - 1);
+	uint32_t slot = hash & mask;
+
+	while (m_slots[slot] != EMPTY_SLOT) {
+		uint32_t id = m_slots[slot] - 1;
+		if (m_hashes[id] == hash && NameOf(id) == name) {
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * Rebuild the slot table at a new size from the stored per-ID hashes.
+ *
+ * @param slotCount New number of slots. Must be a power of two larger than Size().
+ */
+void ItemDictionary::Rehash(size_t slotCount) {
+	m_slots.assign(slotCount, EMPTY_SLOT);
+	uint32_t mask = static_cast<uint32_t>(slotCount - 1);
+
+	for (uint32_t id = 0; id < m_hashes.size(); ++id) {
+		uint32_t slot = m_hashes[id] & mask;
+		while (m_slots[slot] != EMPTY_SLOT) {
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = id + 1;
+	}
+}
@@ -0,0 +1,48 @@
+/**
+ * ItemDictionary.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See ItemDictionary.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef ITEMDICTIONARY_H
+#define ITEMDICTIONARY_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class ItemDictionary {
+public:
+	/* ID returned by Find() for names that haven't been interned. */
+	static const uint32_t NO_ITEM = 0xFFFFFFFF;
+
+	ItemDictionary();
+
+	uint32_t Intern(string_view name);
+	uint32_t Find(string_view name) const;
+	string_view NameOf(uint32_t id) const;
+	size_t Size() const;
+	void RemoveLast();
+	void Clear();
+
+	static uint64_t Hash(string_view name);
+
+private:
+	uint32_t FindSlot(string_view name, uint32_t hash) const;
+	void Rehash(size_t slotCount);
+
+	string m_names;
+	vector<size_t> m_nameOffsets;
+	vector<uint32_t> m_hashes;
+	vector<uint32_t> m_slots;
+};
+
+#endif
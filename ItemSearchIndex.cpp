@@ -0,0 +1,453 @@
+/**
+ * ItemSearchIndex.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Search index over item names, for finding an item in a catalog too large to print. Finds
+ * names that start with a query, ignoring case, and names within a few typing errors of the
+ * query (Levenshtein distance: inserted, deleted, or changed characters), and ranks them. Built
+ * once per item list with Build(); queries take well under a millisecond for a million names.
+ *
+ * Matching:
+ * - Case is folded for ASCII letters only. Other bytes must match exactly.
+ * - Prefix completion uses the names sorted by folded name: the names starting with a prefix
+ *   are one range of the sorted array, found by binary search. This needs the same O(log n)
+ *   lookups as a trie in a fraction of the memory.
+ * - Fuzzy matching uses an index of the trigrams (3-character substrings) of each folded name,
+ *   with a start and an end marker so short names have trigrams too. Each edit changes at most
+ *   three trigrams, so a name within d edits of a query of g distinct trigrams shares at least
+ *   g - 3d of them. Only names that share enough are checked with a bounded edit distance,
+ *   which stops as soon as the distance is over the limit. The query's end marker isn't used,
+ *   so a query also matches the start of a longer name ("bnana" finds "Bananas").
+ * - The largest distance tried is GetMaxDistance(), lowered for short queries so that a name
+ *   must share at least one trigram per edit allowed: queries of 4 characters or fewer are only
+ *   matched as prefixes, and 2 edits need a query of at least 9.
+ *
+ * Ranking: fewest edits first, then names the query matches whole before names it only starts,
+ * then by weight (e.g. purchase count, see SetWeights()), highest first, then by name.
+ *
+ * Storage follows ItemDictionary: names are stored back to back in one string, with an offset
+ * per ID, and the trigram index is one flat array of IDs with an offset per trigram.
+ *
+ * Const member functions may be called from several threads at once.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "ItemSearchIndex.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+/* Marks the start and end of a name in its trigrams. */
+static const char GRAM_START = '\x01';
+static const char GRAM_END = '\x02';
+/* Longest query that is also matched fuzzily. Longer queries are only matched as prefixes. */
+static const size_t MAX_FUZZY_LENGTH = 64;
+
+/**
+ * Default constructor. Creates an empty index.
+ */
+ItemSearchIndex::ItemSearchIndex() {
+	m_maxDistance = DEFAULT_MAX_DISTANCE;
+	Clear();
+}
+
+/**
+ * Index a list of names, replacing anything indexed before. Weights are cleared.
+ *
+ * @param names Item names. Match IDs are positions in this list.
+ */
+void ItemSearchIndex::Build(const vector<string>& names) {
+	Clear();
+	for (const string& name : names) {
+		m_names += name;
+		m_nameOffsets.push_back(m_names.size());
+	}
+	m_foldedNames = Fold(m_names);
+
+	m_sortedIds.resize(names.size());
+	iota(m_sortedIds.begin(), m_sortedIds.end(), 0);
+	sort(m_sortedIds.begin(), m_sortedIds.end(), [this](uint32_t a, uint32_t b) {
+		int order = FoldedAt(a).compare(FoldedAt(b));
+		return order < 0 || (order == 0 && a < b);
+	});
+
+	// Count the names with each trigram, then place each name's ID in its trigrams' lists.
+	// IDs are placed in increasing order, so every list is sorted.
+	vector<uint32_t> grams;
+	vector<size_t> gramCounts;
+	for (uint32_t id = 0; id < names.size(); ++id) {
+		grams.clear();
+		AddGrams(FoldedAt(id), true, grams);
+		for (uint32_t gram : grams) {
+			auto inserted = m_gramIds.emplace(gram, static_cast<uint32_t>(gramCounts.size()));
+			if (inserted.second) {
+				gramCounts.push_back(0);
+			}
+			++gramCounts[inserted.first->second];
+		}
+	}
+
+	m_postingOffsets.assign(gramCounts.size() + 1, 0);
+	for (size_t gramId = 0; gramId < gramCounts.size(); ++gramId) {
+		m_postingOffsets[gramId + 1] = m_postingOffsets[gramId] + gramCounts[gramId];
+	}
+	m_postings.resize(m_postingOffsets.back());
+	vector<size_t> nextPosting(m_postingOffsets.begin(), m_postingOffsets.end() - 1);
+	for (uint32_t id = 0; id < names.size(); ++id) {
+		grams.clear();
+		AddGrams(FoldedAt(id), true, grams);
+		for (uint32_t gram : grams) {
+			m_postings[nextPosting[m_gramIds[gram]]++] = id;
+		}
+	}
+}
+
+/**
+ * Check whether the index is up to date with a list of names, so it needn't be rebuilt.
+ *
+ * @param names Item names.
+ *
+ * @return true if Build() was last called with the same names in the same order.
+ */
+bool ItemSearchIndex::IsBuiltFrom(const vector<string>& names) const {
+	if (names.size() != ItemCount()) {
+		return false;
+	}
+	for (uint32_t id = 0; id < names.size(); ++id) {
+		if (NameAt(id) != names[id]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Set how results that are otherwise equal are ranked: higher weights first.
+ *
+ * @param weights Weight of each name by ID, e.g. its purchase count. Missing weights are 0.
+ */
+void ItemSearchIndex::SetWeights(const vector<unsigned long long>& weights) {
+	m_weights = weights;
+}
+
+/**
+ * Remove every name and weight.
+ */
+void ItemSearchIndex::Clear() {
+	m_names.clear();
+	m_foldedNames.clear();
+	m_nameOffsets.assign(1, 0);
+	m_sortedIds.clear();
+	m_weights.clear();
+	m_gramIds.clear();
+	m_postingOffsets.assign(1, 0);
+	m_postings.clear();
+}
+
+/**
+ * Find a name, ignoring case.
+ *
+ * @param name Item name.
+ *
+ * @return ID of the name that matches exactly if there is one, otherwise of the first name that
+ * matches ignoring case, or NO_ITEM if none does.
+ */
+uint32_t ItemSearchIndex::FindName(string_view name) const {
+	string folded = Fold(name);
+	auto sortedId = lower_bound(m_sortedIds.begin(), m_sortedIds.end(), folded,
+		[this](uint32_t id, const string& key) { return FoldedAt(id) < key; });
+
+	uint32_t found = NO_ITEM;
+	for (; sortedId != m_sortedIds.end() && FoldedAt(*sortedId) == folded; ++sortedId) {
+		if (NameAt(*sortedId) == name) {
+			return *sortedId;
+		}
+		if (found == NO_ITEM) {
+			found = *sortedId;
+		}
+	}
+	return found;
+}
+
+/**
+ * Find the best ranked names that start with a prefix, ignoring case. No fuzzy matching.
+ *
+ * @param prefix Start of a name. An empty prefix matches every name.
+ * @param maxResults Most matches to return.
+ *
+ * @return Matches, best first. Distances are all 0.
+ */
+vector<ItemSearchIndex::Match> ItemSearchIndex::CompletePrefix(string_view prefix,
+															   size_t maxResults) const {
+	vector<Match> matches;
+	RankPrefixRange(Fold(prefix), maxResults, matches);
+	sort(matches.begin(), matches.end(),
+		 [this](const Match& a, const Match& b) { return Outranks(a, b); });
+	return matches;
+}
+
+/**
+ * Find the best ranked names that match a query or start with it, ignoring case, exactly or
+ * within GetMaxDistance() edits. See top of file.
+ *
+ * @param query Name, or the start of a name, as typed.
+ * @param maxResults Most matches to return.
+ *
+ * @return Matches, best first.
+ */
+vector<ItemSearchIndex::Match> ItemSearchIndex::Search(string_view query,
+													   size_t maxResults) const {
+	string folded = Fold(query);
+	vector<Match> matches;
+	RankPrefixRange(folded, maxResults, matches);
+	if (folded.size() <= MAX_FUZZY_LENGTH) {
+		FindSimilar(folded, m_maxDistance, matches);
+	}
+
+	size_t resultCount = min(maxResults, matches.size());
+	partial_sort(matches.begin(), matches.begin() + resultCount, matches.end(),
+				 [this](const Match& a, const Match& b) { return Outranks(a, b); });
+	matches.resize(resultCount);
+	return matches;
+}
+
+/**
+ * Add the best ranked names that start with a folded prefix to a list of matches.
+ *
+ * @param folded Prefix, case folded.
+ * @param maxResults Most matches to add.
+ * @param matches Receives the matches, in no particular order.
+ */
+void ItemSearchIndex::RankPrefixRange(const string& folded, size_t maxResults,
+									  vector<Match>& matches) const {
+	auto first = lower_bound(m_sortedIds.begin(), m_sortedIds.end(), folded,
+		[this](uint32_t id, const string& key) { return FoldedAt(id) < key; });
+	auto last = partition_point(first, m_sortedIds.end(), [this, &folded](uint32_t id) {
+		return FoldedAt(id).compare(0, folded.size(), folded) == 0;
+	});
+
+	vector<Match> range;
+	range.reserve(last - first);
+	for (auto sortedId = first; sortedId != last; ++sortedId) {
+		range.push_back({ *sortedId, 0, FoldedAt(*sortedId).size() != folded.size() });
+	}
+	if (range.size() > maxResults) {
+		partial_sort(range.begin(), range.begin() + maxResults, range.end(),
+					 [this](const Match& a, const Match& b) { return Outranks(a, b); });
+		range.resize(maxResults);
+	}
+	matches.insert(matches.end(), range.begin(), range.end());
+}
+
+/**
+ * Add the names within some edits of a folded query, or whose start is, to a list of matches.
+ * Names that start with the query exactly are left out, as RankPrefixRange() finds them.
+ *
+ * @param folded Query, case folded. At most MAX_FUZZY_LENGTH characters.
+ * @param maxDistance Most edits. Lowered for short queries, see top of file.
+ * @param matches Receives the matches, in no particular order.
+ */
+void ItemSearchIndex::FindSimilar(const string& folded, unsigned int maxDistance,
+								  vector<Match>& matches) const {
+	vector<uint32_t> grams;
+	AddGrams(folded, false, grams);
+	// A name then shares at least one trigram per edit allowed, which keeps the candidates few.
+	maxDistance = min(maxDistance, static_cast<unsigned int>(grams.size() / 4));
+	if (maxDistance == 0) {
+		return;
+	}
+
+	// Count the query's trigrams in each name. A name is a candidate once it has enough.
+	size_t threshold = grams.size() - 3 * maxDistance;
+	vector<uint8_t> sharedGrams(ItemCount(), 0);
+	vector<uint32_t> candidates;
+	for (uint32_t gram : grams) {
+		auto gramId = m_gramIds.find(gram);
+		if (gramId == m_gramIds.end()) {
+			continue;
+		}
+		for (size_t posting = m_postingOffsets[gramId->second];
+			 posting < m_postingOffsets[gramId->second + 1]; ++posting) {
+			uint32_t id = m_postings[posting];
+			if (++sharedGrams[id] == threshold) {
+				candidates.push_back(id);
+			}
+		}
+	}
+
+	for (uint32_t id : candidates) {
+		string_view name = FoldedAt(id);
+		if (name.size() + maxDistance < folded.size()) {
+			continue;
+		}
+
+		unsigned int wholeDistance;
+		unsigned int prefixDistance;
+		EditDistances(folded, name, maxDistance, wholeDistance, prefixDistance);
+		if (prefixDistance != 0 && prefixDistance <= maxDistance) {
+			matches.push_back({ id, prefixDistance, prefixDistance < wholeDistance });
+		}
+	}
+}
+
+/**
+ * @return true if match a ranks before match b. See top of file.
+ */
+bool ItemSearchIndex::Outranks(const Match& a, const Match& b) const {
+	if (a.distance != b.distance) {
+		return a.distance < b.distance;
+	}
+	if (a.prefixOnly != b.prefixOnly) {
+		return !a.prefixOnly;
+	}
+	unsigned long long weightA = WeightAt(a.id);
+	unsigned long long weightB = WeightAt(b.id);
+	if (weightA != weightB) {
+		return weightA > weightB;
+	}
+	int order = FoldedAt(a.id).compare(FoldedAt(b.id));
+	return order < 0 || (order == 0 && a.id < b.id);
+}
+
+/**
+ * Fold ASCII letters to lower case. Other bytes are unchanged, so lengths and offsets are too.
+ *
+ * @param text Any text.
+ *
+ * @return text in lower case.
+ */
+string ItemSearchIndex::Fold(string_view text) {
+	string folded(text);
+	for (char& c : folded) {
+		if (c >= 'A' && c <= 'Z') {
+			c = static_cast<char>(c - 'A' + 'a');
+		}
+	}
+	return folded;
+}
+
+/**
+ * Add the distinct trigrams of a folded name, with start marker, to a list. Each trigram is
+ * packed in the low 24 bits of a uint32_t.
+ *
+ * @param folded Name, case folded.
+ * @param withEnd true to add trigrams ending with the end marker (for indexed names), false to
+ * leave them out (for queries, which may be the start of a name).
+ * @param grams Receives the trigrams, sorted.
+ */
+void ItemSearchIndex::AddGrams(string_view folded, bool withEnd, vector<uint32_t>& grams) {
+	size_t first = grams.size();
+	uint32_t gram = static_cast<unsigned char>(GRAM_START);
+	for (size_t i = 0; i <= folded.size(); ++i) {
+		char next = (i < folded.size()) ? folded[i] : GRAM_END;
+		if (i == folded.size() && !withEnd) {
+			break;
+		}
+		gram = ((gram << 8) | static_cast<unsigned char>(next)) & 0xFFFFFF;
+		if (i >= 1) {
+			grams.push_back(gram);
+		}
+	}
+	sort(grams.begin() + first, grams.end());
+	grams.erase(unique(grams.begin() + first, grams.end()), grams.end());
+}
+
+/**
+ * Levenshtein distances between a query and a name, and between the query and the closest
+ * start of the name, computed one column of the distance table per character of the name. Stops
+ * early once every distance in a column is over the limit, since later columns are never less.
+ *
+ * @param query Query, at most MAX_FUZZY_LENGTH characters.
+ * @param name Name to compare with.
+ * @param limit Largest distance of interest.
+ * @param wholeDistance Receives the distance to the whole name, or more than limit.
+ * @param prefixDistance Receives the smallest distance to any start of the name, or more than
+ * limit.
+ */
+void ItemSearchIndex::EditDistances(string_view query, string_view name, unsigned int limit,
+									unsigned int& wholeDistance, unsigned int& prefixDistance) {
+	unsigned int column[MAX_FUZZY_LENGTH + 1];
+	size_t queryLength = query.size();
+	for (size_t i = 0; i <= queryLength; ++i) {
+		column[i] = static_cast<unsigned int>(i);
+	}
+	prefixDistance = column[queryLength];
+
+	for (size_t j = 0; j < name.size(); ++j) {
+		unsigned int diagonal = column[0];
+		column[0] = static_cast<unsigned int>(j + 1);
+		unsigned int columnMin = column[0];
+		for (size_t i = 1; i <= queryLength; ++i) {
+			unsigned int above = column[i];
+			unsigned int substitution = diagonal + ((query[i - 1] == name[j]) ? 0 : 1);
+			column[i] = min(min(above, column[i - 1]) + 1, substitution);
+			diagonal = above;
+			columnMin = min(columnMin, column[i]);
+		}
+		prefixDistance = min(prefixDistance, column[queryLength]);
+		if (columnMin > limit) {
+			wholeDistance = limit + 1;
+			return;
+		}
+	}
+	wholeDistance = column[queryLength];
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Number of names indexed. IDs run from 0 to ItemCount() - 1.
+ */
+size_t ItemSearchIndex::ItemCount() const {
+	return m_nameOffsets.size() - 1;
+}
+
+/**
+ * @param id ID from a Match or FindName().
+ *
+ * @return Name with that ID, as given to Build().
+ */
+string_view ItemSearchIndex::NameAt(uint32_t id) const {
+	return string_view(m_names.data() + m_nameOffsets[id],
+					   m_nameOffsets[id + 1] - m_nameOffsets[id]);
+}
+
+/**
+ * @param id ID from a Match or FindName().
+ *
+ * @return Name with that ID, case folded.
+ */
+string_view ItemSearchIndex::FoldedAt(uint32_t id) const {
+	return string_view(m_foldedNames.data() + m_nameOffsets[id],
+					   m_nameOffsets[id + 1] - m_nameOffsets[id]);
+}
+
+/**
+ * @param id ID from a Match or FindName().
+ *
+ * @return Weight of that name, 0 if none was set.
+ */
+unsigned long long ItemSearchIndex::WeightAt(uint32_t id) const {
+	return (id < m_weights.size()) ? m_weights[id] : 0;
+}
+
+/**
+ * @return Most edits between a query and a fuzzy match.
+ */
+unsigned int ItemSearchIndex::GetMaxDistance() const {
+	return m_maxDistance;
+}
+
+/**
+ * Set the most edits between a query and a fuzzy match. Short queries allow fewer, see top of
+ * file.
+ *
+ * @param maxDistance Most edits. 0 turns fuzzy matching off.
+ */
+void ItemSearchIndex::SetMaxDistance(unsigned int maxDistance) {
+	m_maxDistance = maxDistance;
+}
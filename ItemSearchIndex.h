@@ -0,0 +1,78 @@
+/**
+ * ItemSearchIndex.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See ItemSearchIndex.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef ITEMSEARCHINDEX_H
+#define ITEMSEARCHINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class ItemSearchIndex {
+public:
+	/* ID returned by FindName() for names that aren't in the index. */
+	static const uint32_t NO_ITEM = 0xFFFFFFFF;
+	/* Most edits between a query and a fuzzy match, unless set otherwise. */
+	static const unsigned int DEFAULT_MAX_DISTANCE = 2;
+
+	/* One search result. Results are ranked by distance, then whole-name matches before prefix
+	 * matches, then weight (highest first), then name. */
+	struct Match {
+		uint32_t id;			// Position of the name in the list the index was built from.
+		unsigned int distance;	// Edits between the query and the name, or the start of it.
+		bool prefixOnly;		// The query matches the start of the name, not all of it.
+	};
+
+	ItemSearchIndex();
+
+	void Build(const vector<string>& names);
+	bool IsBuiltFrom(const vector<string>& names) const;
+	void SetWeights(const vector<unsigned long long>& weights);
+	void Clear();
+
+	uint32_t FindName(string_view name) const;
+	vector<Match> CompletePrefix(string_view prefix, size_t maxResults) const;
+	vector<Match> Search(string_view query, size_t maxResults) const;
+
+	size_t ItemCount() const;
+	string_view NameAt(uint32_t id) const;
+	unsigned int GetMaxDistance() const;
+	void SetMaxDistance(unsigned int maxDistance);
+
+private:
+	string_view FoldedAt(uint32_t id) const;
+	unsigned long long WeightAt(uint32_t id) const;
+	bool Outranks(const Match& a, const Match& b) const;
+	void RankPrefixRange(const string& folded, size_t maxResults, vector<Match>& matches) const;
+	void FindSimilar(const string& folded, unsigned int maxDistance,
+					 vector<Match>& matches) const;
+	static string Fold(string_view text);
+	static void AddGrams(string_view folded, bool withEnd, vector<uint32_t>& grams);
+	static void EditDistances(string_view query, string_view name, unsigned int limit,
+							  unsigned int& wholeDistance, unsigned int& prefixDistance);
+
+	string m_names;
+	string m_foldedNames;
+	vector<size_t> m_nameOffsets;
+	vector<uint32_t> m_sortedIds;
+	vector<unsigned long long> m_weights;
+	unsigned int m_maxDistance;
+
+	unordered_map<uint32_t, uint32_t> m_gramIds;
+	vector<size_t> m_postingOffsets;
+	vector<uint32_t> m_postings;
+};
+
+#endif
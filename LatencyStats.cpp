@@ -0,0 +1,257 @@
+/**
+ * LatencyStats.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Latency histograms for the app's hot paths, to show where the time of a menu option or Python
+ * call goes: starting the interpreter, importing the module, converting arguments, running the
+ * Python function, converting its result, loading counts, and each menu option as a whole. Also
+ * the waits on either side of an IngestPipeline's queue, which show which side is behind.
+ *
+ * Use:
+ * - Timing is off until SetEnabled(true) (Source.cpp does this for --stats and --stats-json).
+ * While off, a ScopedTimer (see LatencyStats.h) only loads one flag, so timed code costs the
+ * same as untimed code.
+ * - Wrap a phase in a ScopedTimer for its Metric. Phases may be timed on any thread: the
+ * PyExecutor's thread records the Python phases while the menu thread records menu options.
+ * - FormatTable() summarizes every metric for the console (the menu's Statistics option);
+ * FormatJson() and WriteJson() give the same summary as JSON:
+ *   { "enabled": true, "metrics": [ { "name": "python.call", "count": 3, "total_us": 41.2,
+ *     "mean_us": 13.7, "p50_us": 12.9, "p99_us": 15.4, "max_us": 15.6 }, ... ] }
+ *
+ * Each metric keeps a total, a maximum, and a log-scale histogram of nanoseconds in relaxed
+ * atomic counters, so recording never locks. p50 and p99 are read from the histogram and are
+ * within 6.25% of the true value; the count (the sum of the buckets), total, and max are exact.
+ * A summary taken while other threads record may mix old and new values of different counters.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "LatencyStats.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+/* Whether ScopedTimers record. */
+atomic<bool> LatencyStats::s_enabled(false);
+/* One histogram per Metric. Static storage, so every counter starts at zero. */
+LatencyStats::Histogram LatencyStats::s_histograms[static_cast<size_t>(Metric::Count)];
+/* Names of the metrics in output, in Metric order. */
+const char* LatencyStats::METRIC_NAMES[] = {
+	"python.initialize",
+	"python.import",
+	"python.arguments",
+	"python.call",
+	"python.result",
+	"counts.load",
+	"menu.list",
+	"menu.search.list",
+	"menu.search.count",
+	"menu.chart",
+	"menu.top",
+	"pipeline.block_wait",
+	"pipeline.queue_wait"
+};
+
+/**
+ * Turn timing on or off. Counts recorded so far are kept either way; see Reset().
+ *
+ * @param enabled true to record ScopedTimer phases, false to skip them.
+ */
+void LatencyStats::SetEnabled(bool enabled) {
+	s_enabled.store(enabled, memory_order_relaxed);
+}
+
+/**
+ * Add one timing to a metric. Called by ScopedTimer; safe from any thread.
+ *
+ * @param metric Metric to add to.
+ * @param nanoseconds Time taken.
+ */
+void LatencyStats::Record(Metric metric, unsigned long long nanoseconds) {
+	Histogram& histogram = s_histograms[static_cast<size_t>(metric)];
+	histogram.total.fetch_add(nanoseconds, memory_order_relaxed);
+	histogram.buckets[BucketOf(nanoseconds)].fetch_add(1, memory_order_relaxed);
+
+	unsigned long long max = histogram.max.load(memory_order_relaxed);
+	while (nanoseconds > max &&
+		   !histogram.max.compare_exchange_weak(max, nanoseconds, memory_order_relaxed)) {
+	}
+}
+
+/**
+ * Clear every metric.
+ */
+void LatencyStats::Reset() {
+	for (Histogram& histogram : s_histograms) {
+		histogram.total.store(0, memory_order_relaxed);
+		histogram.max.store(0, memory_order_relaxed);
+		for (atomic<unsigned long long>& bucket : histogram.buckets) {
+			bucket.store(0, memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * Summarize every metric that has been recorded, for the console. Times are in microseconds.
+ *
+ * @return Table with a row per recorded metric, or a note if there is nothing to show.
+ */
+string LatencyStats::FormatTable() {
+	if (!IsEnabled()) {
+		return "Timing statistics are off. Start with --stats to collect them.\n";
+	}
+
+	ostringstream table;
+	char row[128];
+	snprintf(row, sizeof(row), "%-20s %8s %12s %12s %12s\n", "Phase (microseconds)", "Count",
+			 "p50", "p99", "Max");
+	table << row;
+	bool anyRecorded = false;
+	for (size_t i = 0; i < static_cast<size_t>(Metric::Count); ++i) {
+		Summary summary = Summarize(s_histograms[i]);
+		if (summary.count == 0) {
+			continue;
+		}
+		snprintf(row, sizeof(row), "%-20s %8llu %12.1f %12.1f %12.1f\n", METRIC_NAMES[i],
+				 summary.count, summary.p50 / 1e3, summary.p99 / 1e3, summary.max / 1e3);
+		table << row;
+		anyRecorded = true;
+	}
+	if (!anyRecorded) {
+		return "No timings recorded yet.\n";
+	}
+	return table.str();
+}
+
+/**
+ * Summarize every metric as JSON, including metrics with no timings (count 0), so every dump
+ * has the same fields. Times are in microseconds.
+ *
+ * @return JSON object, ending in a newline.
+ */
+string LatencyStats::FormatJson() {
+	static_assert(sizeof(METRIC_NAMES) / sizeof(METRIC_NAMES[0]) ==
+				  static_cast<size_t>(Metric::Count), "METRIC_NAMES needs one name per Metric");
+
+	ostringstream json;
+	json << "{ \"enabled\": " << (IsEnabled() ? "true" : "false") << ", \"metrics\": [";
+	for (size_t i = 0; i < static_cast<size_t>(Metric::Count); ++i) {
+		Summary summary = Summarize(s_histograms[i]);
+		double mean = (summary.count == 0) ? 0.0
+			: static_cast<double>(summary.total) / summary.count;
+		char entry[256];
+		snprintf(entry, sizeof(entry), "%s\n  { \"name\": \"%s\", \"count\": %llu, "
+				 "\"total_us\": %.3f, \"mean_us\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, "
+				 "\"max_us\": %.3f }", (i == 0) ? "" : ",", METRIC_NAMES[i], summary.count,
+				 summary.total / 1e3, mean / 1e3, summary.p50 / 1e3, summary.p99 / 1e3,
+				 summary.max / 1e3);
+		json << entry;
+	}
+	json << "\n] }\n";
+	return json.str();
+}
+
+/**
+ * Write FormatJson() to a file.
+ *
+ * @param fileName File to write (or overwrite), or "-" for standard output.
+ * @return true if written, false if the file couldn't be written.
+ */
+bool LatencyStats::WriteJson(const string& fileName) {
+	string json = FormatJson();
+	if (fileName == "-") {
+		cout << json << flush;
+		return cout.good();
+	}
+
+	ofstream outputFile(fileName, ios::binary);
+	outputFile << json;
+	outputFile.close();
+	return !outputFile.fail();
+}
+
+/**
+ * @param nanoseconds A timing.
+ * @return Index of the histogram bucket for it.
+ */
+size_t LatencyStats::BucketOf(unsigned long long nanoseconds) {
+	if (nanoseconds < (1ULL << SUB_BUCKET_BITS)) {
+		return static_cast<size_t>(nanoseconds);
+	}
+
+	// Position of the highest set bit picks the power of two; the next bits pick the sub-bucket.
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long highestBit;
+	_BitScanReverse64(&highestBit, nanoseconds);
+#else
+	unsigned highestBit = 63 - __builtin_clzll(nanoseconds);
+#endif
+	unsigned shift = highestBit - SUB_BUCKET_BITS;
+	return (static_cast<size_t>(shift + 1) << SUB_BUCKET_BITS) +
+		   static_cast<size_t>((nanoseconds >> shift) & ((1ULL << SUB_BUCKET_BITS) - 1));
+}
+
+/**
+ * @param bucket Index of a histogram bucket.
+ * @return Middle of the range of nanoseconds the bucket counts.
+ */
+unsigned long long LatencyStats::BucketMidpoint(size_t bucket) {
+	if (bucket < (1ULL << SUB_BUCKET_BITS)) {
+		return bucket;
+	}
+
+	unsigned shift = static_cast<unsigned>(bucket >> SUB_BUCKET_BITS) - 1;
+	unsigned long long subBucket = bucket & ((1ULL << SUB_BUCKET_BITS) - 1);
+	unsigned long long low = ((1ULL << SUB_BUCKET_BITS) + subBucket) << shift;
+	return low + ((1ULL << shift) >> 1);
+}
+
+/**
+ * Read a histogram's counters and find its percentiles.
+ *
+ * @param histogram Histogram to summarize.
+ * @return Its summary. Percentiles are bucket midpoints, capped at the exact maximum.
+ */
+LatencyStats::Summary LatencyStats::Summarize(const Histogram& histogram) {
+	Summary summary = { 0, 0, 0, 0, 0 };
+	unsigned long long bucketCounts[BUCKET_COUNT];
+	for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+		bucketCounts[i] = histogram.buckets[i].load(memory_order_relaxed);
+		summary.count += bucketCounts[i];
+	}
+	summary.total = histogram.total.load(memory_order_relaxed);
+	summary.max = histogram.max.load(memory_order_relaxed);
+	if (summary.count == 0) {
+		return summary;
+	}
+
+	// Rank of each percentile, counted from 1: the smallest timing with at least that fraction of
+	// timings at or below it.
+	unsigned long long p50Rank = (summary.count + 1) / 2;
+	unsigned long long p99Rank = summary.count - summary.count / 100;
+	unsigned long long seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+		if (bucketCounts[i] == 0) {
+			continue;
+		}
+		if (seen < p50Rank && seen + bucketCounts[i] >= p50Rank) {
+			summary.p50 = min(BucketMidpoint(i), summary.max);
+		}
+		seen += bucketCounts[i];
+		if (seen >= p99Rank) {
+			summary.p99 = min(BucketMidpoint(i), summary.max);
+			break;
+		}
+	}
+	return summary;
+}
@@ -0,0 +1,140 @@
+/**
+ * LatencyStats.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See LatencyStats.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+class LatencyStats {
+public:
+	/* Timed phases. Keep METRIC_NAMES in LatencyStats.cpp in the same order. */
+	enum class Metric {
+		PyInitialize,		// Registering the grocer module and Py_Initialize.
+		PyImport,			// Importing the Python module.
+		PyArguments,		// Converting a call's arguments to Python objects.
+		PyCall,				// Looking up and running the Python function.
+		PyResult,			// Converting the function's result back to C++.
+		LoadCounts,			// Loading the PurchaseIndex for a menu option.
+		MenuList,			// Menu option one.
+		MenuSearchList,		// Menu option two, up to the prompt.
+		MenuSearchCount,	// Menu option two, after the user's selection.
+		MenuChart,			// Menu option three.
+		MenuTop,			// Menu option four, after the user's selection.
+		PipelineBlockWait,	// An IngestPipeline source waiting for a free block.
+		PipelineQueueWait,	// The IngestPipeline aggregator waiting for a filled block.
+		Count				// Number of metrics, not a metric.
+	};
+
+	static void SetEnabled(bool enabled);
+	static void Record(Metric metric, unsigned long long nanoseconds);
+	static void Reset();
+	static string FormatTable();
+	static string FormatJson();
+	static bool WriteJson(const string& fileName);
+
+	/* Inline: ScopedTimer checks this on every timed phase. */
+	static bool IsEnabled() {
+		return s_enabled.load(memory_order_relaxed);
+	}
+
+private:
+	/* Values below 2^(SUB_BUCKET_BITS + 1) ns get a bucket each; above that, each power of two
+	 * is split into 2^SUB_BUCKET_BITS buckets, so a bucket's midpoint is within 6.25% of its
+	 * values. */
+	static const unsigned SUB_BUCKET_BITS = 3;
+	static const size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+	struct Histogram {
+		atomic<unsigned long long> total;
+		atomic<unsigned long long> max;
+		atomic<unsigned long long> buckets[BUCKET_COUNT];
+	};
+
+	/* Summary of one Histogram, in nanoseconds. */
+	struct Summary {
+		unsigned long long count;
+		unsigned long long total;
+		unsigned long long max;
+		unsigned long long p50;
+		unsigned long long p99;
+	};
+
+	static size_t BucketOf(unsigned long long nanoseconds);
+	static unsigned long long BucketMidpoint(size_t bucket);
+	static Summary Summarize(const Histogram& histogram);
+
+	static atomic<bool> s_enabled;
+	static Histogram s_histograms[static_cast<size_t>(Metric::Count)];
+	static const char* METRIC_NAMES[];
+};
+
+/* Times a phase from construction to Stop(), Next(), or destruction, and records it in
+ * LatencyStats. Does nothing, not even read the clock, while LatencyStats is disabled. E.g.:
+ *   ScopedTimer timer(LatencyStats::Metric::PyArguments);
+ *   ...convert arguments...
+ *   timer.Next(LatencyStats::Metric::PyCall);
+ *   ...call... (recorded when timer goes out of scope) */
+class ScopedTimer {
+public:
+	explicit ScopedTimer(LatencyStats::Metric metric) {
+		m_running = LatencyStats::IsEnabled();
+		m_metric = metric;
+		if (m_running) {
+			m_start = chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedTimer() {
+		Stop();
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	/* Record the current phase, if running, and stop timing. */
+	void Stop() {
+		if (m_running) {
+			LatencyStats::Record(m_metric, static_cast<unsigned long long>(
+				chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_start)
+					.count()));
+			m_running = false;
+		}
+	}
+
+	/* Record the current phase, if running, and start timing the next one with the same clock
+	 * reading. */
+	void Next(LatencyStats::Metric metric) {
+		chrono::steady_clock::time_point now;
+		if (m_running) {
+			now = chrono::steady_clock::now();
+			LatencyStats::Record(m_metric, static_cast<unsigned long long>(
+				chrono::duration_cast<chrono::nanoseconds>(now - m_start).count()));
+		}
+		else if (LatencyStats::IsEnabled()) {
+			now = chrono::steady_clock::now();
+			m_running = true;
+		}
+		m_metric = metric;
+		m_start = now;
+	}
+
+private:
+	bool m_running;
+	LatencyStats::Metric m_metric;
+	chrono::steady_clock::time_point m_start;
+};
+
+#endif
@@ -0,0 +1,465 @@
+/**
+ * LineScanner.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Splits text (usually a MappedFile's view) into lines and trims each line of surrounding 
+ * whitespace, without copying. This is the inner loop of every purchase file scan, so it has 
+ * three implementations, picked once at runtime for the CPU it runs on:
+ * - AVX2: finds '\n' bytes and whitespace 32 bytes at a time.
+ * - SSE2: 16 bytes at a time. Always available on x64, so it is the baseline there.
+ * - Scalar: one byte at a time. Used on other CPUs, and as the reference the SIMD versions
+ * must match exactly (see SetIsa()). tools/LineScannerFuzz.cpp checks that they do.
+ *
+ * Line rules match Python's readlines() followed by str.strip(), as used by PythonCode.py:
+ * - Lines end at '\n'. A final line without a '\n' is still returned, but a '\n' at the very end
+ * of the text does not start another (empty) line.
+ * - Trimming removes ASCII whitespace as str.strip() does: spaces, \t, \n, \v, \f, \r, and the
+ * \x1c-\x1f separator characters. So CRLF files scan the same as LF files.
+ *
+ * Use:
+ * - LineScanner scanner(file.View()); string_view lines[256]; size_t n;
+ * while ((n = scanner.NextBatch(lines, 256)) > 0) { ... }
+ * - Next() reads one line at a time, for callers that don't need the speed.
+ * - Returned string_views point into the scanned text and are only valid as long as it is.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "LineScanner.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LINESCANNER_X64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/* MSVC allows AVX2 intrinsics anywhere; GCC and Clang need the function marked for AVX2. */
+#if defined(_MSC_VER) && !defined(__clang__)
+#define LINESCANNER_AVX2_TARGET
+#else
+#define LINESCANNER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+using namespace std;
+
+/* Signatures of the per-ISA implementations. */
+typedef size_t (*SplitFunc)(const char* text, size_t size, size_t& offset, string_view* lines,
+							size_t maxLines);
+typedef string_view (*TrimFunc)(string_view text);
+
+/**
+ * @param c Byte to test.
+ *
+ * @return true if c is whitespace to str.strip().
+ */
+static inline bool IsSpace(unsigned char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r') || (c >= 0x1c && c <= 0x1f);
+}
+
+/* -------------------- Scalar -------------------- */
+
+/**
+ * Trim one byte at a time. Reference implementation for the SIMD versions.
+ */
+static string_view TrimScalar(string_view text) {
+	size_t first = 0;
+	size_t last = text.size();
+	while (first < last && IsSpace(text[first])) {
+		++first;
+	}
+	while (last > first && IsSpace(text[last - 1])) {
+		--last;
+	}
+	return text.substr(first, last - first);
+}
+
+/**
+ * Split one byte at a time. Reference implementation for the SIMD versions.
+ *
+ * @param text Start of the text.
+ * @param size Size of the text in bytes.
+ * @param offset Byte offset of the next line to read; advanced past the lines returned.
+ * @param lines Array to fill with trimmed lines.
+ * @param maxLines Size of lines.
+ *
+ * @return Number of lines written to lines.
+ */
+static size_t SplitScalar(const char* text, size_t size, size_t& offset, string_view* lines, 
+						  size_t maxLines) {
+	size_t count = 0;
+	size_t lineStart = offset;
+
+	for (size_t pos = offset; pos < size && count < maxLines; ++pos) {
+		if (text[pos] == '\n') {
+			lines[count++] = TrimScalar(string_view(text + lineStart, pos - lineStart));
+			lineStart = pos + 1;
+		}
+	}
+	if (count < maxLines && lineStart < size) {
+		lines[count++] = TrimScalar(string_view(text + lineStart, size - lineStart));
+		lineStart = size;
+	}
+
+	offset = lineStart;
+	return count;
+}
+
+#ifdef LINESCANNER_X64
+
+/* Index of the lowest and highest set bit of a non-zero mask. */
+static inline unsigned LowestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned HighestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+/* -------------------- SSE2 -------------------- */
+
+/**
+ * Mark whitespace bytes in a 16-byte block. Unsigned range checks are done as 
+ * min(x - low, span) == x - low, since SSE2 has no unsigned byte compare.
+ */
+static inline __m128i WhitespaceSse2(__m128i bytes) {
+	__m128i isBlank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+	__m128i control = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+	__m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control);
+	__m128i separator = _mm_sub_epi8(bytes, _mm_set1_epi8(0x1c));
+	__m128i isSeparator = _mm_cmpeq_epi8(_mm_min_epu8(separator, _mm_set1_epi8(3)), separator);
+	return _mm_or_si128(isBlank, _mm_or_si128(isControl, isSeparator));
+}
+
+/**
+ * Trim 16 bytes at a time from each end, then finish the last partial block byte by byte.
+ */
+static string_view TrimSse2(string_view text) {
+	const char* data = text.data();
+	size_t first = 0;
+	size_t last = text.size();
+
+	// Most lines only need the '\r' of a CRLF line ending removed, if anything.
+	if (last > 0 && data[last - 1] == '\r') {
+		--last;
+	}
+	if (last == 0 || (!IsSpace(data[0]) && !IsSpace(data[last - 1]))) {
+		return text.substr(0, last);
+	}
+
+	while (last - first >= 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + last - 16));
+		uint32_t notSpace = ~static_cast<uint32_t>(_mm_movemask_epi8(WhitespaceSse2(block))) & 0xFFFF;
+		if (notSpace != 0) {
+			last = last - 16 + HighestBit(notSpace) + 1;
+			break;
+		}
+		last -= 16;
+	}
+	while (last > first && IsSpace(data[last - 1])) {
+		--last;
+	}
+
+	while (last - first >= 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + first));
+		uint32_t notSpace = ~static_cast<uint32_t>(_mm_movemask_epi8(WhitespaceSse2(block))) & 0xFFFF;
+		if (notSpace != 0) {
+			first += LowestBit(notSpace);
+			break;
+		}
+		first += 16;
+	}
+	while (first < last && IsSpace(data[first])) {
+		++first;
+	}
+
+	return text.substr(first, last - first);
+}
+
+/**
+ * Find '\n' bytes 16 at a time, then finish the last partial block byte by byte. See 
+ * SplitScalar() for parameters.
+ */
+static size_t SplitSse2(const char* text, size_t size, size_t& offset, string_view* lines,
+						size_t maxLines) {
+	const __m128i newline = _mm_set1_epi8('\n');
+	size_t count = 0;
+	size_t lineStart = offset;
+	size_t pos = offset;
+
+	for (; pos + 16 <= size; pos += 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+		while (mask != 0) {
+			size_t lineEnd = pos + LowestBit(mask);
+			lines[count++] = TrimSse2(string_view(text + lineStart, lineEnd - lineStart));
+			lineStart = lineEnd + 1;
+			if (count == maxLines) {
+				offset = lineStart;
+				return count;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	size_t tailOffset = lineStart;
+	count += SplitScalar(text, size, tailOffset, lines + count, maxLines - count);
+	offset = tailOffset;
+	return count;
+}
+
+/* -------------------- AVX2 -------------------- */
+
+/**
+ * Mark whitespace bytes in a 32-byte block. See WhitespaceSse2().
+ */
+LINESCANNER_AVX2_TARGET
+static inline __m256i WhitespaceAvx2(__m256i bytes) {
+	__m256i isBlank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+	__m256i control = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+	__m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(4)), control);
+	__m256i separator = _mm256_sub_epi8(bytes, _mm256_set1_epi8(0x1c));
+	__m256i isSeparator = _mm256_cmpeq_epi8(_mm256_min_epu8(separator, _mm256_set1_epi8(3)), 
+											separator);
+	return _mm256_or_si256(isBlank, _mm256_or_si256(isControl, isSeparator));
+}
+
+/**
+ * Trim 32 bytes at a time from each end. See TrimSse2().
+ */
+LINESCANNER_AVX2_TARGET
+static string_view TrimAvx2(string_view text) {
+	const char* data = text.data();
+	size_t first = 0;
+	size_t last = text.size();
+
+	if (last > 0 && data[last - 1] == '\r') {
+		--last;
+	}
+	if (last == 0 || (!IsSpace(data[0]) && !IsSpace(data[last - 1]))) {
+		return text.substr(0, last);
+	}
+
+	while (last - first >= 32) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + last - 32));
+		uint32_t notSpace = ~static_cast<uint32_t>(_mm256_movemask_epi8(WhitespaceAvx2(block)));
+		if (notSpace != 0) {
+			last = last - 32 + HighestBit(notSpace) + 1;
+			break;
+		}
+		last -= 32;
+	}
+	while (last > first && IsSpace(data[last - 1])) {
+		--last;
+	}
+
+	while (last - first >= 32) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + first));
+		uint32_t notSpace = ~static_cast<uint32_t>(_mm256_movemask_epi8(WhitespaceAvx2(block)));
+		if (notSpace != 0) {
+			first += LowestBit(notSpace);
+			break;
+		}
+		first += 32;
+	}
+	while (first < last && IsSpace(data[first])) {
+		++first;
+	}
+
+	return text.substr(first, last - first);
+}
+
+/**
+ * Find '\n' bytes 32 at a time. See SplitSse2().
+ */
+LINESCANNER_AVX2_TARGET
+static size_t SplitAvx2(const char* text, size_t size, size_t& offset, string_view* lines,
+						size_t maxLines) {
+	const __m256i newline = _mm256_set1_epi8('\n');
+	size_t count = 0;
+	size_t lineStart = offset;
+	size_t pos = offset;
+
+	for (; pos + 32 <= size; pos += 32) {
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos));
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+		while (mask != 0) {
+			size_t lineEnd = pos + LowestBit(mask);
+			lines[count++] = TrimAvx2(string_view(text + lineStart, lineEnd - lineStart));
+			lineStart = lineEnd + 1;
+			if (count == maxLines) {
+				offset = lineStart;
+				return count;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	size_t tailOffset = lineStart;
+	count += SplitSse2(text, size, tailOffset, lines + count, maxLines - count);
+	offset = tailOffset;
+	return count;
+}
+
+#endif // LINESCANNER_X64
+
+/* -------------------- Dispatch -------------------- */
+
+/* Implementations in use. Chosen from DetectIsa() on first use; changed by SetIsa(). */
+struct ScanDispatch {
+	LineScanner::Isa isa;
+	SplitFunc split;
+	TrimFunc trim;
+};
+
+static ScanDispatch MakeDispatch(LineScanner::Isa isa) {
+#ifdef LINESCANNER_X64
+	if (isa == LineScanner::Isa::Avx2) {
+		return { isa, SplitAvx2, TrimAvx2 };
+	}
+	if (isa == LineScanner::Isa::Sse2) {
+		return { isa, SplitSse2, TrimSse2 };
+	}
+#endif
+	return { LineScanner::Isa::Scalar, SplitScalar, TrimScalar };
+}
+
+static ScanDispatch& GetDispatch() {
+	static ScanDispatch dispatch = MakeDispatch(LineScanner::DetectIsa());
+	return dispatch;
+}
+
+/**
+ * Constructor taking the text to split into lines, usually MappedFile::View().
+ *
+ * @param text Text to read lines from. Must outlive the LineScanner and the lines it returns.
+ */
+LineScanner::LineScanner(string_view text) {
+	m_text = text;
+	m_offset = 0;
+}
+
+/**
+ * Read the next line, trimmed of surrounding whitespace.
+ *
+ * @param line Set to the trimmed line if one was read.
+ *
+ * @return true if a line was read, false at the end of the text.
+ */
+bool LineScanner::Next(string_view& line) {
+	return NextBatch(&line, 1) == 1;
+}
+
+/**
+ * Read up to maxLines lines at once, each trimmed of surrounding whitespace. Reading in batches
+ * of a few hundred lines keeps the SIMD loop running between calls.
+ *
+ * @param lines Array to fill with trimmed lines.
+ * @param maxLines Size of lines.
+ *
+ * @return Number of lines read; 0 at the end of the text.
+ */
+size_t LineScanner::NextBatch(string_view* lines, size_t maxLines) {
+	if (maxLines == 0 || m_offset >= m_text.size()) {
+		return 0;
+	}
+	return GetDispatch().split(m_text.data(), m_text.size(), m_offset, lines, maxLines);
+}
+
+/**
+ * @return Byte offset of the start of the next line to be read (the text's size at the end).
+ */
+size_t LineScanner::Offset() const {
+	return m_offset;
+}
+
+/**
+ * Trim leading and trailing whitespace without copying, as str.strip() does for ASCII text.
+ *
+ * @param text Text to trim.
+ *
+ * @return View of text without leading or trailing whitespace.
+ */
+string_view LineScanner::Trim(string_view text) {
+	return GetDispatch().trim(text);
+}
+
+/**
+ * @return Instruction set currently used to split and trim lines.
+ */
+LineScanner::Isa LineScanner::GetIsa() {
+	return GetDispatch().isa;
+}
+
+/**
+ * Choose the instruction set used to split and trim lines, e.g. to compare implementations. 
+ * Requests for an instruction set this CPU lacks fall back to the best one it has. Not 
+ * thread-safe: call before any scans are running.
+ *
+ * @param isa Instruction set to use.
+ */
+void LineScanner::SetIsa(Isa isa) {
+	Isa detected = DetectIsa();
+	GetDispatch() = MakeDispatch(isa > detected ? detected : isa);
+}
+
+/**
+ * Detect the best instruction set this CPU supports.
+ *
+ * @return Avx2 if the CPU and OS support AVX2, Sse2 on any other x64 CPU, Scalar otherwise.
+ */
+LineScanner::Isa LineScanner::DetectIsa() {
+#ifdef LINESCANNER_X64
+#if defined(_MSC_VER) && !defined(__clang__)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 0);
+	if (cpuInfo[0] >= 7) {
+		__cpuid(cpuInfo, 1);
+		bool osSavesAvx = (cpuInfo[2] & (1 << 27)) != 0 && (cpuInfo[2] & (1 << 28)) != 0 &&
+						  (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(cpuInfo, 7, 0);
+		if (osSavesAvx && (cpuInfo[1] & (1 << 5)) != 0) {
+			return Isa::Avx2;
+		}
+	}
+	return Isa::Sse2;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? Isa::Avx2 : Isa::Sse2;
+#endif
+#else
+	return Isa::Scalar;
+#endif
+}
+
+/**
+ * @param isa Instruction set.
+ *
+ * @return Lowercase name of the instruction set, e.g. "avx2".
+ */
+const char* LineScanner::IsaName(Isa isa) {
+	switch (isa) {
+	case Isa::Avx2:
+		return "avx2";
+	case Isa::Sse2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
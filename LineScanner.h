@@ -0,0 +1,43 @@
+/**
+ * LineScanner.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See LineScanner.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+class LineScanner {
+public:
+	/* Instruction set used to split and trim lines. */
+	enum class Isa { Scalar, Sse2, Avx2 };
+
+	LineScanner(string_view text);
+
+	bool Next(string_view& line);
+	size_t NextBatch(string_view* lines, size_t maxLines);
+	size_t Offset() const;
+
+	static string_view Trim(string_view text);
+
+	static Isa GetIsa();
+	static void SetIsa(Isa isa);
+	static Isa DetectIsa();
+	static const char* IsaName(Isa isa);
+
+private:
+	string_view m_text;
+	size_t m_offset;
+};
+
+#endif
@@ -0,0 +1,379 @@
+/**
+ * MappedFile.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Read-only, memory-mapped view of a purchase file. A LineScanner (see LineScanner.cpp) walks the
+ * mapping one line at a time, returning string_views that point straight into the mapping, 
+ * already trimmed of surrounding whitespace (including the '\r' of CRLF files), so scanning a file
+ * makes no heap copies of its contents. Only the distinct item names kept by PurchaseIndex are 
+ * copied.
+ *
+ * Use:
+ * - MappedFile file; if (file.Open(name)) { LineScanner scanner(file.View()); ... }
+ * - string_views from a LineScanner are only valid while the MappedFile stays open.
+ * - Call Release(offset, length) on ranges that have already been scanned to let the OS drop
+ * their pages, so that scanning a multi-GB file doesn't grow resident memory to the file's size.
+ *
+ * Identity() reports the mapped file's device, inode, size, and modification time, as read from the
+ * open handle, so callers can tell when a file has been appended to, truncated, or replaced.
+ *
+ * A mapping is only safe while the file doesn't shrink: touching a mapped page past the file's 
+ * new end raises SIGBUS. Files that another process may truncate or rewrite while they are read,
+ * such as a log being followed, are opened with Open(name, false) instead, which doesn't map 
+ * them, and read with Read() or Range(); a read past the new end just comes up short.
+ *
+ * Uses mmap on Linux and other POSIX systems, and CreateFileMapping/MapViewOfFile on Windows.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "MappedFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+/**
+ * Build a FileIdentity from Windows file information. The volume serial number and file index
+ * stand in for device and inode; the modification time is in 100 ns ticks.
+ */
+static FileIdentity IdentityFromInfo(const BY_HANDLE_FILE_INFORMATION& fileInfo) {
+	FileIdentity identity;
+	identity.device = fileInfo.dwVolumeSerialNumber;
+	identity.inode = (static_cast<unsigned long long>(fileInfo.nFileIndexHigh) << 32) | 
+					 fileInfo.nFileIndexLow;
+	identity.size = (static_cast<unsigned long long>(fileInfo.nFileSizeHigh) << 32) | 
+					fileInfo.nFileSizeLow;
+	identity.modifiedTime = (static_cast<long long>(fileInfo.ftLastWriteTime.dwHighDateTime) << 32) |
+							fileInfo.ftLastWriteTime.dwLowDateTime;
+	return identity;
+}
+#else
+/**
+ * Build a FileIdentity from stat results. The modification time is in nanoseconds.
+ */
+static FileIdentity IdentityFromStat(const struct stat& fileStat) {
+	FileIdentity identity;
+	identity.device = static_cast<unsigned long long>(fileStat.st_dev);
+	identity.inode = static_cast<unsigned long long>(fileStat.st_ino);
+	identity.size = static_cast<unsigned long long>(fileStat.st_size);
+#ifdef __APPLE__
+	identity.modifiedTime = static_cast<long long>(fileStat.st_mtimespec.tv_sec) * 1000000000LL +
+							fileStat.st_mtimespec.tv_nsec;
+#else
+	identity.modifiedTime = static_cast<long long>(fileStat.st_mtim.tv_sec) * 1000000000LL +
+							fileStat.st_mtim.tv_nsec;
+#endif
+	return identity;
+}
+#endif
+
+/**
+ * Default constructor. Nothing is mapped until Open() is called.
+ */
+MappedFile::MappedFile() {
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+	m_identity = FileIdentity();
+#ifdef _WIN32
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mappingHandle = nullptr;
+#else
+	m_fileDescriptor = -1;
+#endif
+}
+
+/**
+ * Destructor. Unmaps the file if it is still open.
+ */
+MappedFile::~MappedFile() {
+	Close();
+}
+
+/**
+ * Map a file into memory, read-only. Any previously mapped file is closed first. An empty file
+ * opens successfully with Size() == 0 and Data() == nullptr.
+ *
+ * @param fileName Name of the file to map.
+ * @param mapContents false to only open the file, for Read() and Range(): Data() is nullptr and
+ * View() is empty, but Size() and Identity() are set.
+ *
+ * @return true if the file was mapped, false if it could not be opened or mapped.
+ */
+bool MappedFile::Open(const string& fileName, bool mapContents) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE |
+									FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 
+									FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	BY_HANDLE_FILE_INFORMATION fileInfo;
+	if (!GetFileInformationByHandle(fileHandle, &fileInfo)) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	m_fileHandle = fileHandle;
+	m_identity = IdentityFromInfo(fileInfo);
+	m_size = static_cast<size_t>(m_identity.size);
+	m_isOpen = true;
+	if (m_size == 0 || !mapContents) {
+		return true;
+	}
+
+	m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr) {
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const char*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		Close();
+		return false;
+	}
+#else
+	int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) {
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0) {
+		close(fileDescriptor);
+		return false;
+	}
+
+	m_fileDescriptor = fileDescriptor;
+	m_identity = IdentityFromStat(fileStat);
+	m_size = static_cast<size_t>(fileStat.st_size);
+	m_isOpen = true;
+	if (m_size == 0 || !mapContents) {
+		return true;
+	}
+
+	void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	m_data = static_cast<const char*>(mapping);
+	madvise(mapping, m_size, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+/**
+ * Unmap the file and close its handle. Safe to call more than once.
+ */
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != nullptr) {
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_fileHandle);
+	}
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mappingHandle = nullptr;
+#else
+	if (m_data != nullptr) {
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+	if (m_fileDescriptor >= 0) {
+		close(m_fileDescriptor);
+	}
+	m_fileDescriptor = -1;
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+	m_identity = FileIdentity();
+}
+
+/**
+ * Hint that a range of the mapping has been scanned and won't be read again soon, so its pages 
+ * can be dropped from this process's resident memory. The data stays readable; touching it again
+ * just faults the pages back in from the file. Does nothing on Windows, where the working set
+ * manager trims mapped pages on its own.
+ *
+ * @param offset Byte offset of the start of the range.
+ * @param length Length of the range in bytes.
+ */
+void MappedFile::Release(size_t offset, size_t length) {
+#ifndef _WIN32
+	if (m_data == nullptr || offset >= m_size) {
+		return;
+	}
+
+	// madvise needs a page-aligned start; only release whole pages inside the range.
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+	size_t end = min(offset + length, m_size) / pageSize * pageSize;
+	if (end > begin) {
+		madvise(const_cast<char*>(m_data) + begin, end - begin, MADV_DONTNEED);
+	}
+#else
+	(void)offset;
+	(void)length;
+#endif
+}
+
+/**
+ * Copy bytes of the open file into a buffer, from the file itself rather than the mapping, so a
+ * file that has been truncated since Open() gives a short read instead of SIGBUS. Works whether
+ * or not the file is mapped.
+ *
+ * @param offset Byte offset in the file to read from.
+ * @param buffer Receives the bytes.
+ * @param length Most bytes to read.
+ *
+ * @return Number of bytes read: less than length if the file ends first, or on an error.
+ */
+size_t MappedFile::Read(size_t offset, char* buffer, size_t length) const {
+	size_t done = 0;
+#ifdef _WIN32
+	while (m_fileHandle != INVALID_HANDLE_VALUE && done < length) {
+		OVERLAPPED position = {};
+		unsigned long long at = offset + done;
+		position.Offset = static_cast<DWORD>(at);
+		position.OffsetHigh = static_cast<DWORD>(at >> 32);
+		DWORD request = static_cast<DWORD>(min<size_t>(length - done, 1 << 30));
+		DWORD received = 0;
+		if (!ReadFile(m_fileHandle, buffer + done, request, &received, &position) || 
+			received == 0) {
+			break;
+		}
+		done += received;
+	}
+#else
+	while (m_fileDescriptor >= 0 && done < length) {
+		ssize_t received = pread(m_fileDescriptor, buffer + done, length - done, 
+								 static_cast<off_t>(offset + done));
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			break;
+		}
+		done += static_cast<size_t>(received);
+	}
+#endif
+	return done;
+}
+
+/**
+ * Get a range of the file, as of Open(): a view of the mapping if the file is mapped, else read
+ * into a buffer with Read().
+ *
+ * @param offset Byte offset of the start of the range.
+ * @param length Length of the range in bytes. Cut at Size().
+ * @param buffer Holds the bytes if the file isn't mapped; the view points into it.
+ *
+ * @return The bytes of the range. Shorter than asked if the file isn't mapped and has been
+ * truncated since Open().
+ */
+string_view MappedFile::Range(size_t offset, size_t length, string& buffer) const {
+	if (offset >= m_size) {
+		return string_view();
+	}
+	length = min<size_t>(length, m_size - offset);
+	if (m_data != nullptr) {
+		return string_view(m_data + offset, length);
+	}
+
+	buffer.resize(length);
+	buffer.resize(Read(offset, &buffer[0], length));
+	return buffer;
+}
+
+/**
+ * @return Device, inode, size, and modification time of the open file, as of Open().
+ */
+const FileIdentity& MappedFile::Identity() const {
+	return m_identity;
+}
+
+/**
+ * Read a file's identity without opening or mapping it.
+ *
+ * @param fileName Name of the file.
+ * @param identity Set to the file's device, inode, size, and modification time.
+ *
+ * @return true if the file exists and could be read, false otherwise.
+ */
+bool MappedFile::StatFile(const string& fileName, FileIdentity& identity) {
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(fileName.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | 
+									FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 
+									FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	BY_HANDLE_FILE_INFORMATION fileInfo;
+	bool found = GetFileInformationByHandle(fileHandle, &fileInfo) != 0;
+	CloseHandle(fileHandle);
+	if (found) {
+		identity = IdentityFromInfo(fileInfo);
+	}
+	return found;
+#else
+	struct stat fileStat;
+	if (stat(fileName.c_str(), &fileStat) != 0) {
+		return false;
+	}
+	identity = IdentityFromStat(fileStat);
+	return true;
+#endif
+}
+
+/**
+ * @return true if a file is open (including an empty file).
+ */
+bool MappedFile::IsOpen() const {
+	return m_isOpen;
+}
+
+/**
+ * @return Pointer to the first byte of the mapped file, or nullptr if empty or not open.
+ */
+const char* MappedFile::Data() const {
+	return m_data;
+}
+
+/**
+ * @return Size of the mapped file in bytes.
+ */
+size_t MappedFile::Size() const {
+	return m_size;
+}
+
+/**
+ * @return string_view over the whole mapped file. Empty if not open.
+ */
+string_view MappedFile::View() const {
+	return string_view(m_data, m_size);
+}
+
@@ -0,0 +1,62 @@
+/**
+ * MappedFile.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See MappedFile.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/* Identity and version of a file on disk, used to tell whether a file has changed. */
+struct FileIdentity {
+	unsigned long long device;
+	unsigned long long inode;
+	unsigned long long size;
+	long long modifiedTime;
+};
+
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const string& fileName, bool mapContents = true);
+	void Close();
+	void Release(size_t offset, size_t length);
+	size_t Read(size_t offset, char* buffer, size_t length) const;
+	string_view Range(size_t offset, size_t length, string& buffer) const;
+
+	bool IsOpen() const;
+	const char* Data() const;
+	size_t Size() const;
+	string_view View() const;
+	const FileIdentity& Identity() const;
+
+	static bool StatFile(const string& fileName, FileIdentity& identity);
+
+private:
+	const char* m_data;
+	size_t m_size;
+	bool m_isOpen;
+	FileIdentity m_identity;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+};
+
+#endif
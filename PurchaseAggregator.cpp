@@ -0,0 +1,317 @@
+/**
+ * PurchaseAggregator.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Counts many purchase files at once, e.g. a month of one file per store per day, and rolls them
+ * up into one PurchaseIndex.
+ *
+ * CountFiles() runs a bounded pool of worker threads (GetJobCount()), each counting one whole
+ * file into its own PurchaseIndex. Results are handed to the caller's callback on the calling
+ * thread in file order, then merged into the rollup, so output and rollup item order don't depend
+ * on which worker finishes first. Workers stay at most a few files ahead of the callback, which
+ * bounds the number of indexes held in memory however many files there are.
+ *
+ * ExpandInputs() turns input arguments into file names: a directory stands for every file in it,
+ * and a file name containing * or ? is matched against the files in its directory (the Windows
+ * shell doesn't expand wildcards). Snapshot files (see PurchaseIndex::SnapshotName()) are skipped.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "PurchaseAggregator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/* How many files each worker may count ahead of the file being handed to the callback. */
+static const size_t FILES_AHEAD_PER_JOB = 4;
+
+/**
+ * Default constructor. One job per hardware thread, one scan thread per file, no snapshots.
+ */
+PurchaseAggregator::PurchaseAggregator() {
+	m_jobCount = 0;
+	m_threadCount = 1;
+	m_useSnapshots = false;
+	m_rollupFileCount = 0;
+}
+
+/**
+ * Count each file on the worker pool, call onFile for each in order, and roll all the files that
+ * could be read up into GetRollup(). The rollup is cleared first.
+ *
+ * @param fileNames Names of the purchase files, in the order to report them.
+ * @param onFile Called on this thread once per file, in order, with the file's counts.
+ *
+ * @return true if every file was read, false if any couldn't be.
+ */
+bool PurchaseAggregator::CountFiles(const vector<string>& fileNames, const FileCallback& onFile) {
+	/* One counted file, filled by a worker and taken by this thread. */
+	struct FileResult {
+		PurchaseIndex index;
+		bool loaded = false;
+	};
+
+	m_rollup.Clear();
+	m_rollupFileCount = 0;
+
+	size_t fileCount = fileNames.size();
+	unsigned int jobCount = m_jobCount != 0 ? m_jobCount : max(1u, thread::hardware_concurrency());
+	jobCount = static_cast<unsigned int>(min<size_t>(jobCount, max<size_t>(fileCount, 1)));
+	size_t filesAhead = jobCount * FILES_AHEAD_PER_JOB;
+
+	vector<unique_ptr<FileResult>> results(fileCount);
+	mutex resultsMutex;
+	condition_variable resultReady;
+	condition_variable slotFree;
+	size_t nextFile = 0;
+	size_t handedFiles = 0;
+
+	auto worker = [&]() {
+		while (true) {
+			size_t file;
+			{
+				unique_lock<mutex> lock(resultsMutex);
+				slotFree.wait(lock, [&]() {
+					return nextFile >= fileCount || nextFile < handedFiles + filesAhead;
+				});
+				if (nextFile >= fileCount) {
+					return;
+				}
+				file = nextFile++;
+			}
+
+			unique_ptr<FileResult> result(new FileResult());
+			result->index.SetThreadCount(m_threadCount);
+			result->loaded = LoadIndex(fileNames[file], result->index);
+
+			lock_guard<mutex> lock(resultsMutex);
+			results[file] = move(result);
+			resultReady.notify_all();
+		}
+	};
+
+	vector<thread> workers;
+	for (unsigned int i = 0; i < jobCount; ++i) {
+		workers.emplace_back(worker);
+	}
+
+	bool allLoaded = true;
+	for (size_t file = 0; file < fileCount; ++file) {
+		unique_ptr<FileResult> result;
+		{
+			unique_lock<mutex> lock(resultsMutex);
+			resultReady.wait(lock, [&]() { return results[file] != nullptr; });
+			result = move(results[file]);
+		}
+
+		onFile(fileNames[file], result->loaded ? &result->index : nullptr);
+		if (result->loaded) {
+			m_rollup.Merge(result->index);
+			++m_rollupFileCount;
+		}
+		else {
+			allLoaded = false;
+		}
+
+		lock_guard<mutex> lock(resultsMutex);
+		++handedFiles;
+		slotFree.notify_all();
+	}
+
+	for (thread& worker : workers) {
+		worker.join();
+	}
+	return allLoaded;
+}
+
+/**
+ * Read one file into an index, from its snapshot if using snapshots and the snapshot is still
+ * valid, saving a new snapshot after a scan. Runs on worker threads.
+ *
+ * @param fileName Name of the purchase file.
+ * @param index Index to load.
+ *
+ * @return true if the index was loaded, false if the file couldn't be read.
+ */
+bool PurchaseAggregator::LoadIndex(const string& fileName, PurchaseIndex& index) const {
+	string snapshotName = PurchaseIndex::SnapshotName(fileName);
+	if (m_useSnapshots && index.LoadSnapshot(snapshotName, fileName)) {
+		return true;
+	}
+
+	if (!index.LoadFile(fileName)) {
+		return false;
+	}
+
+	// A snapshot that can't be written only costs a rescan next time, so failures are ignored.
+	if (m_useSnapshots) {
+		index.SaveSnapshot(snapshotName);
+	}
+	return true;
+}
+
+/**
+ * @return Counts of every file read by the last CountFiles() call, merged in file order.
+ */
+const PurchaseIndex& PurchaseAggregator::GetRollup() const {
+	return m_rollup;
+}
+
+/**
+ * @return Number of files merged into GetRollup().
+ */
+size_t PurchaseAggregator::GetRollupFileCount() const {
+	return m_rollupFileCount;
+}
+
+/**
+ * Expand input arguments into purchase file names. Each input is a file name, a directory (every
+ * file directly in it, sorted by name), or a file name containing the wildcards * and ? (every
+ * matching file in that directory, sorted by name). Snapshot files, and snapshots still being
+ * written, are never included from a directory or wildcard (see PurchaseIndex::IsSnapshotName()).
+ *
+ * @param inputs Input arguments, in order.
+ * @param fileNames Receives the file names, in order.
+ * @param unmatchedInput Receives the first directory or wildcard that matched no files.
+ *
+ * @return true if every directory or wildcard matched at least one file, false otherwise.
+ */
+bool PurchaseAggregator::ExpandInputs(const vector<string>& inputs, vector<string>& fileNames,
+									  string& unmatchedInput) {
+	fileNames.clear();
+
+	for (const string& input : inputs) {
+		fs::path inputPath(input);
+		string pattern = inputPath.filename().string();
+		bool isPattern = pattern.find_first_of("*?") != string::npos;
+
+		error_code error;
+		if (!isPattern && !fs::is_directory(inputPath, error)) {
+			fileNames.push_back(input);
+			continue;
+		}
+
+		fs::path directory = isPattern ? inputPath.parent_path() : inputPath;
+		vector<string> matches;
+		for (fs::directory_iterator entry(directory.empty() ? fs::path(".") : directory, error), end;
+			 !error && entry != end; entry.increment(error)) {
+			string name = entry->path().filename().string();
+			if (!entry->is_regular_file(error) || PurchaseIndex::IsSnapshotName(name) ||
+				(isPattern && !MatchesWildcard(pattern, name))) {
+				continue;
+			}
+			matches.push_back((directory / name).string());
+		}
+
+		if (matches.empty()) {
+			unmatchedInput = input;
+			return false;
+		}
+		sort(matches.begin(), matches.end());
+		fileNames.insert(fileNames.end(), matches.begin(), matches.end());
+	}
+	return true;
+}
+
+/**
+ * Match a file name against a wildcard pattern. * matches any run of characters (including none)
+ * and ? matches any one character. Case-sensitive.
+ *
+ * @param pattern Wildcard pattern, e.g. "store12-2026-09-*.txt".
+ * @param name File name to test.
+ *
+ * @return true if the whole name matches the pattern.
+ */
+bool PurchaseAggregator::MatchesWildcard(string_view pattern, string_view name) {
+	size_t patternPos = 0;
+	size_t namePos = 0;
+	// Position after the last * seen, and the name position it is currently matched up to.
+	size_t starPos = string_view::npos;
+	size_t starMatchEnd = 0;
+
+	while (namePos < name.size()) {
+		if (patternPos < pattern.size() &&
+			(pattern[patternPos] == '?' || pattern[patternPos] == name[namePos])) {
+			++patternPos;
+			++namePos;
+		}
+		else if (patternPos < pattern.size() && pattern[patternPos] == '*') {
+			starPos = ++patternPos;
+			starMatchEnd = namePos;
+		}
+		else if (starPos != string_view::npos) {
+			// Let the last * match one more character and retry from there.
+			patternPos = starPos;
+			namePos = ++starMatchEnd;
+		}
+		else {
+			return false;
+		}
+	}
+
+	while (patternPos < pattern.size() && pattern[patternPos] == '*') {
+		++patternPos;
+	}
+	return patternPos == pattern.size();
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Maximum number of files counted at once, 0 meaning one per hardware thread.
+ */
+unsigned int PurchaseAggregator::GetJobCount() const {
+	return m_jobCount;
+}
+
+/**
+ * Set the maximum number of files counted at once. Each file is scanned with up to
+ * GetThreadCount() threads of its own.
+ *
+ * @param jobCount Number of worker threads. 0 uses one per hardware thread.
+ */
+void PurchaseAggregator::SetJobCount(unsigned int jobCount) {
+	m_jobCount = jobCount;
+}
+
+/**
+ * @return Maximum number of threads used to scan each file. See PurchaseIndex.
+ */
+unsigned int PurchaseAggregator::GetThreadCount() const {
+	return m_threadCount;
+}
+
+/**
+ * Set the maximum number of threads used to scan each file. See PurchaseIndex.
+ *
+ * @param threadCount Maximum number of scan threads per file. 0 uses every hardware thread.
+ */
+void PurchaseAggregator::SetThreadCount(unsigned int threadCount) {
+	m_threadCount = threadCount;
+}
+
+/**
+ * @return true if each file's counts are loaded from and saved to a snapshot next to it.
+ */
+bool PurchaseAggregator::GetUseSnapshots() const {
+	return m_useSnapshots;
+}
+
+/**
+ * Set whether each file's counts are loaded from a valid snapshot next to it, and a snapshot
+ * saved after each scan. See PurchaseIndex::SaveSnapshot().
+ *
+ * @param useSnapshots true to use snapshots.
+ */
+void PurchaseAggregator::SetUseSnapshots(bool useSnapshots) {
+	m_useSnapshots = useSnapshots;
+}
@@ -0,0 +1,55 @@
+/**
+ * PurchaseAggregator.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See PurchaseAggregator.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef PURCHASEAGGREGATOR_H
+#define PURCHASEAGGREGATOR_H
+
+#include "PurchaseIndex.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class PurchaseAggregator {
+public:
+	/* Called once per file, in file order. index is nullptr if the file couldn't be read. */
+	typedef function<void(const string& fileName, const PurchaseIndex* index)> FileCallback;
+
+	PurchaseAggregator();
+
+	bool CountFiles(const vector<string>& fileNames, const FileCallback& onFile);
+	const PurchaseIndex& GetRollup() const;
+	size_t GetRollupFileCount() const;
+
+	unsigned int GetJobCount() const;
+	void SetJobCount(unsigned int jobCount);
+	unsigned int GetThreadCount() const;
+	void SetThreadCount(unsigned int threadCount);
+	bool GetUseSnapshots() const;
+	void SetUseSnapshots(bool useSnapshots);
+
+	static bool ExpandInputs(const vector<string>& inputs, vector<string>& fileNames,
+							 string& unmatchedInput);
+	static bool MatchesWildcard(string_view pattern, string_view name);
+
+private:
+	bool LoadIndex(const string& fileName, PurchaseIndex& index) const;
+
+	unsigned int m_jobCount;
+	unsigned int m_threadCount;
+	bool m_useSnapshots;
+	PurchaseIndex m_rollup;
+	size_t m_rollupFileCount;
+};
+
+#endif
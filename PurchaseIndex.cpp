@@ -0,0 +1,875 @@
+/**
+ * PurchaseIndex.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Native purchase counter for the Corner Grocer app. Reads a purchase file (one item name per
+ * line) in a single pass, keeping each distinct item in the order it was first seen alongside the
+ * number of times it was purchased. Lookups by name are hashed, so counting one item, or every
+ * item, costs O(1) per item once the file is loaded.
+ *
+ * Item names are interned in an ItemDictionary (see ItemDictionary.cpp), so each item is known by
+ * a dense ID equal to its first-seen position, and counts are a flat array indexed by ID. Names 
+ * are only handled as strings when reading the file and printing results.
+ *
+ * LoadFile() memory-maps the file (see MappedFile.cpp) and splits it into lines with a SIMD
+ * LineScanner (see LineScanner.cpp), so lines are never copied out of the file; only each 
+ * distinct item name is stored, once. Pages that have been scanned are released as the scan goes, keeping resident 
+ * memory near the size of the item table even for multi-GB files.
+ *
+ * With SetThreadCount(), large files are split into newline-aligned chunks that are counted on
+ * worker threads, each into its own table. The tables are merged in file order, so items keep the
+ * same first-seen order as a single-threaded scan (and as CountItems/GetItems).
+ *
+ * RefreshFile() supports following a file that registers are still appending to. The index 
+ * remembers the file's identity (device, inode, size, modification time) and how far it has
+ * been scanned, and on the next refresh only counts the lines added since. If the file has been 
+ * truncated, replaced (rotated), or rewritten in place, it falls back to a full rescan. A final
+ * line without a '\n' may still be being written, so it is counted but un-counted and rescanned
+ * on the next refresh if the file has grown.
+ *
+ * RefreshFile() doesn't map the file: a file being followed may be truncated or rotated in place
+ * by another process at any time, and touching a mapped page past its new end would raise 
+ * SIGBUS and kill the app. It reads the file with MappedFile::Read() (pread) instead, 
+ * FOLLOW_READ_BYTES at a time, so a file that shrinks mid-read just comes up short. If that 
+ * happens while reading appended lines, the file is rescanned in full; if it happens during a 
+ * full scan, the index holds the lines up to where the file ended, and the next refresh sees 
+ * whatever the file has become.
+ *
+ * SaveSnapshot() writes the index to a small binary sidecar file (by default "<input>.idx", see
+ * SnapshotName()), and LoadSnapshot() reads it back instead of rescanning, if it still matches 
+ * the input file. Closed-day files that are reopened for reporting then cost one small read. See
+ * the Snapshots section below for the format and how snapshots are validated.
+ *
+ * Replaces the CountItems/GetItems/CountOneItem/ChartItems logic in PythonCode.py, which re-reads
+ * the file on every call and counts with list.count() (O(lines x distinct items)). Output from
+ * FormatItemCounts() (and histograms from HistogramWriter) match the Python functions 
+ * byte-for-byte:
+ * - Lines are split on '\n' and stripped of leading and trailing whitespace as Python's
+ * str.strip() does for ASCII text, so CRLF files count the same as LF files.
+ * - A blank line is counted as an item with an empty name, as the Python code does.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "PurchaseIndex.h"
+#include "MappedFile.h"
+#include "LineScanner.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifdef _WIN32
+// Keep Windows.h's min and max macros from hiding std::min and std::max.
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+using namespace std;
+
+/* Width of the dotted item/count lines printed by FormatItemCounts(). From CountItems. */
+static const int ITEM_COUNT_WIDTH = 30;
+/* Bytes of the mapped file to scan between releases of already-scanned pages. */
+static const size_t SCAN_RELEASE_BYTES = 16 * 1024 * 1024;
+/* Bytes read from a followed file at a time by RefreshFile(), which doesn't map it. */
+static const size_t FOLLOW_READ_BYTES = 16 * 1024 * 1024;
+/* Smallest chunk worth handing to its own thread. Smaller files are scanned on fewer threads. */
+static const size_t MIN_CHUNK_BYTES = 1024 * 1024;
+/* Lines read from the LineScanner per batch. */
+static const size_t SCAN_BATCH_LINES = 256;
+/* Bytes before the end of the last scan that are kept to check a file was only appended to. */
+static const size_t SCANNED_TAIL_BYTES = 64;
+/* Bytes from each end of an input file covered by the checksum kept in snapshots. */
+static const size_t CHECKSUM_SAMPLE_BYTES = 64 * 1024;
+/* First bytes of every snapshot file. The last two digits are the format version. */
+static const char SNAPSHOT_MAGIC[8] = { 'C', 'G', 'I', 'D', 'X', '0', '0', '1' };
+/* Extension added to an input file's name to name its snapshot. */
+static const string SNAPSHOT_EXTENSION = ".idx";
+/* Extension added to a snapshot's name while SaveSnapshot() writes it. */
+static const string SNAPSHOT_TEMP_EXTENSION = ".tmp";
+
+/**
+ * Default constructor. Creates an empty, single-threaded index; call LoadFile() to fill it.
+ */
+PurchaseIndex::PurchaseIndex() {
+	m_threadCount = 1;
+	m_sourceIdentity = FileIdentity();
+	m_scannedBytes = 0;
+	m_pendingItem = ItemDictionary::NO_ITEM;
+	m_sourceChecksum = 0;
+	m_snapshotIdentity = FileIdentity();
+}
+
+/**
+ * Replace the contents of this index with the purchases listed in a file, one item per line.
+ *
+ * @param fileName Name of the purchase file to read.
+ *
+ * @return true if the file was read, false if it could not be opened (index is left empty).
+ */
+bool PurchaseIndex::LoadFile(const string& fileName) {
+	Clear();
+
+	MappedFile inputFile;
+	if (!inputFile.Open(fileName)) {
+		return false;
+	}
+
+	ScanText(inputFile.View(), &inputFile);
+	RecordScan(inputFile, fileName, inputFile.Size());
+	return true;
+}
+
+/**
+ * Bring this index up to date with a file that may have been appended to since it was last 
+ * loaded or refreshed. Only lines added since then are scanned. If the index was loaded from a
+ * different file, or the file has been truncated, replaced, or rewritten, the whole file is
+ * rescanned, as LoadFile(). The file is read rather than mapped, so it may be truncated while it
+ * is read (see the file header).
+ *
+ * @param fileName Name of the purchase file to read.
+ *
+ * @return true if the index is up to date, false if the file could not be opened (index is left
+ * empty).
+ */
+bool PurchaseIndex::RefreshFile(const string& fileName) {
+	MappedFile inputFile;
+	if (!inputFile.Open(fileName, false)) {
+		Clear();
+		return false;
+	}
+
+	if (IsAppendedTo(inputFile, fileName)) {
+		if (inputFile.Size() == m_sourceIdentity.size) {
+			// Same size and modification time: nothing new.
+			return true;
+		}
+		UncountPendingItem();
+		if (ReadFrom(inputFile, m_scannedBytes) == inputFile.Size()) {
+			RecordScan(inputFile, fileName, inputFile.Size());
+			return true;
+		}
+		// Truncated while the new lines were read: what was counted may not be purchases.
+	}
+
+	Clear();
+	RecordScan(inputFile, fileName, ReadFrom(inputFile, 0));
+	return true;
+}
+
+/**
+ * Check whether a file is the one last scanned into this index, with lines only appended since.
+ * The file must have the same name, device, and inode, must not have shrunk, must have the same
+ * modification time if its size is unchanged, and the bytes just before the end of the last scan
+ * must be unchanged. (A grown file's modification time isn't checked: appends within one clock
+ * tick of the filesystem leave it the same.)
+ *
+ * @param inputFile Mapped purchase file.
+ * @param fileName Name inputFile was opened with.
+ *
+ * @return true if only new lines need to be scanned, false if a full rescan is needed.
+ */
+bool PurchaseIndex::IsAppendedTo(const MappedFile& inputFile, const string& fileName) const {
+	const FileIdentity& identity = inputFile.Identity();
+
+	if (m_sourceName.empty() || fileName != m_sourceName || 
+		identity.device != m_sourceIdentity.device || identity.inode != m_sourceIdentity.inode) {
+		return false;
+	}
+	if (identity.size < m_sourceIdentity.size) {
+		return false;
+	}
+	if (identity.size == m_sourceIdentity.size && 
+		identity.modifiedTime != m_sourceIdentity.modifiedTime) {
+		return false;
+	}
+
+	string buffer;
+	return inputFile.Range(m_scannedBytes - m_scannedTail.size(), m_scannedTail.size(), buffer) ==
+		m_scannedTail;
+}
+
+/**
+ * Remember how far a file has been scanned, for the next RefreshFile(). The scan position is kept
+ * at the start of a final line without a '\n', whose item is recorded as pending.
+ *
+ * @param inputFile Purchase file, mapped or not, scanned into this index.
+ * @param fileName Name inputFile was opened with.
+ * @param size Bytes of the file scanned: inputFile.Size(), unless the file was truncated while
+ * it was read.
+ */
+void PurchaseIndex::RecordScan(const MappedFile& inputFile, const string& fileName, size_t size) {
+	string buffer;
+
+	m_sourceName = fileName;
+	m_sourceIdentity = inputFile.Identity();
+	m_sourceIdentity.size = size;
+	m_scannedBytes = size;
+	m_pendingItem = ItemDictionary::NO_ITEM;
+
+	if (size > 0 && inputFile.Range(size - 1, 1, buffer) != "\n") {
+		// Find the last '\n', a block at a time from the end in case the file isn't mapped.
+		m_scannedBytes = 0;
+		for (size_t blockEnd = size; blockEnd > 0; ) {
+			size_t blockStart = blockEnd - min(blockEnd, FOLLOW_READ_BYTES);
+			string_view block = inputFile.Range(blockStart, blockEnd - blockStart, buffer);
+			size_t lastNewline = block.rfind('\n');
+			if (lastNewline != string_view::npos) {
+				m_scannedBytes = blockStart + lastNewline + 1;
+				break;
+			}
+			blockEnd = blockStart;
+		}
+		string_view lastLine = inputFile.Range(m_scannedBytes, size - m_scannedBytes, buffer);
+		m_pendingItem = m_dictionary.Find(LineScanner::Trim(lastLine));
+	}
+
+	size_t tailStart = m_scannedBytes - min(m_scannedBytes, SCANNED_TAIL_BYTES);
+	m_scannedTail.assign(inputFile.Range(tailStart, m_scannedBytes - tailStart, buffer));
+
+	size_t sampleBytes = min(size, CHECKSUM_SAMPLE_BYTES);
+	string head(inputFile.Range(0, sampleBytes, buffer));
+	string_view tail = inputFile.Range(size - sampleBytes, sampleBytes, buffer);
+	m_sourceChecksum = SampleChecksum(head, tail, size);
+}
+
+/**
+ * Undo counting the pending final line of the last scan, before rescanning it. If that line was
+ * the item's only purchase, the item is removed; it was the last item added, so no other IDs 
+ * change.
+ */
+void PurchaseIndex::UncountPendingItem() {
+	if (m_pendingItem == ItemDictionary::NO_ITEM) {
+		return;
+	}
+
+	--m_counts[m_pendingItem];
+	if (m_counts[m_pendingItem] == 0 && m_pendingItem == m_counts.size() - 1) {
+		m_counts.pop_back();
+		m_dictionary.RemoveLast();
+	}
+	m_pendingItem = ItemDictionary::NO_ITEM;
+}
+
+/**
+ * Count every line of some text into this index. The text is split into up to m_threadCount 
+ * newline-aligned chunks of at least MIN_CHUNK_BYTES, each counted on its own thread, and the
+ * chunk tables are merged in text order.
+ *
+ * @param text Lines to count, from the start of a line to just past a '\n' or the end of file.
+ * @param mappedFile File whose mapping text is part of, so scanned pages can be released, or 
+ * nullptr if the text was read into memory.
+ */
+void PurchaseIndex::ScanText(string_view text, MappedFile* mappedFile) {
+	size_t end = text.size();
+	size_t chunkCount = max<size_t>(1, min<size_t>(m_threadCount, end / MIN_CHUNK_BYTES));
+	vector<size_t> bounds(chunkCount + 1, end);
+	bounds[0] = 0;
+
+	// Move each nominal split point forward to just past the next '\n' so no line is split.
+	for (size_t i = 1; i < chunkCount; ++i) {
+		size_t nominal = end / chunkCount * i;
+		size_t newline = text.find('\n', max(nominal, bounds[i - 1]) - 1);
+		bounds[i] = (newline == string_view::npos) ? end : newline + 1;
+	}
+
+	vector<ChunkCounts> chunks(chunkCount);
+	if (chunkCount == 1) {
+		CountChunk(text, mappedFile, chunks[0]);
+	}
+	else {
+		vector<thread> workers;
+		for (size_t i = 0; i < chunkCount; ++i) {
+			workers.emplace_back(CountChunk, text.substr(bounds[i], bounds[i + 1] - bounds[i]),
+								 mappedFile, ref(chunks[i]));
+		}
+		for (thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	// Merging in chunk order, and each chunk in its own ID (first-seen) order, keeps file order.
+	for (const ChunkCounts& chunk : chunks) {
+		for (uint32_t id = 0; id < chunk.counts.size(); ++id) {
+			AddPurchases(chunk.dictionary.NameOf(id), chunk.counts[id]);
+		}
+	}
+}
+
+/**
+ * Count the lines in one chunk of text. Runs on a worker thread; touches nothing but the chunk's
+ * own table and its own range of the text.
+ *
+ * @param text The chunk, from the start of a line.
+ * @param mappedFile File whose mapping text is part of, so scanned pages can be released, or
+ * nullptr.
+ * @param chunk Table to count into.
+ */
+void PurchaseIndex::CountChunk(string_view text, MappedFile* mappedFile, ChunkCounts& chunk) {
+	LineScanner scanner(text);
+	string_view lines[SCAN_BATCH_LINES];
+	size_t lineCount;
+	size_t releasedTo = 0;
+
+	while ((lineCount = scanner.NextBatch(lines, SCAN_BATCH_LINES)) > 0) {
+		for (size_t i = 0; i < lineCount; ++i) {
+			uint32_t id = chunk.dictionary.Intern(lines[i]);
+			if (id == chunk.counts.size()) {
+				chunk.counts.push_back(0);
+			}
+			++chunk.counts[id];
+		}
+
+		if (mappedFile != nullptr && scanner.Offset() - releasedTo >= SCAN_RELEASE_BYTES) {
+			size_t offset = static_cast<size_t>(text.data() - mappedFile->Data());
+			mappedFile->Release(offset + releasedTo, scanner.Offset() - releasedTo);
+			releasedTo = scanner.Offset();
+		}
+	}
+}
+
+/**
+ * Count every line of a file from a byte offset to its end, reading it FOLLOW_READ_BYTES at a 
+ * time with MappedFile::Read() rather than through a mapping (see RefreshFile()). Each read's
+ * complete lines are counted with ScanText(); a line cut by the end of a read is kept for the 
+ * next. The last line is counted even without a '\n', as ScanText() does at the end of a file.
+ *
+ * @param inputFile Purchase file, opened without mapping.
+ * @param begin Byte offset of the start of a line.
+ *
+ * @return Byte offset the file was read up to: inputFile.Size(), or less if the file was 
+ * truncated while it was read.
+ */
+size_t PurchaseIndex::ReadFrom(const MappedFile& inputFile, size_t begin) {
+	string block;			// Bytes read but not yet counted, starting at a line.
+	size_t position = begin;
+	while (position < inputFile.Size()) {
+		size_t kept = block.size();
+		size_t length = min(FOLLOW_READ_BYTES, inputFile.Size() - position);
+		block.resize(kept + length);
+		size_t received = inputFile.Read(position, &block[kept], length);
+		block.resize(kept + received);
+		position += received;
+		if (received < length) {
+			break;
+		}
+
+		size_t lastNewline = block.rfind('\n');
+		if (lastNewline != string::npos) {
+			ScanText(string_view(block).substr(0, lastNewline + 1), nullptr);
+			block.erase(0, lastNewline + 1);
+		}
+	}
+	ScanText(block, nullptr);
+	return position;
+}
+
+/**
+ * Remove all items and counts, and forget the file they were read from.
+ */
+void PurchaseIndex::Clear() {
+	m_dictionary.Clear();
+	m_counts.clear();
+	ForgetSource();
+}
+
+/**
+ * Forget the file the index was read from, keeping its items and counts.
+ */
+void PurchaseIndex::ForgetSource() {
+	m_sourceName.clear();
+	m_sourceIdentity = FileIdentity();
+	m_scannedBytes = 0;
+	m_scannedTail.clear();
+	m_pendingItem = ItemDictionary::NO_ITEM;
+	m_sourceChecksum = 0;
+	m_snapshotIdentity = FileIdentity();
+}
+
+/**
+ * Add every purchase counted by another index to this one, e.g. to roll several days' files up 
+ * into one index. Items new to this index are given IDs in the other index's ID order, so merging
+ * the same files in the same order always lists items in the same order.
+ *
+ * The merged index no longer matches one file, so it forgets its file: RefreshFile() rescans and
+ * SaveSnapshot() fails.
+ *
+ * @param other Index to add. Must not be this index.
+ */
+void PurchaseIndex::Merge(const PurchaseIndex& other) {
+	m_counts.reserve(m_counts.size() + other.m_counts.size());
+	for (uint32_t id = 0; id < other.m_counts.size(); ++id) {
+		AddPurchases(other.m_dictionary.NameOf(id), other.m_counts[id]);
+	}
+	ForgetSource();
+}
+
+/**
+ * Count one purchase of an item. Items not seen before are given the next ID.
+ *
+ * @param item Name of the purchased item, already stripped of surrounding whitespace.
+ *
+ * @return ID of the item.
+ */
+uint32_t PurchaseIndex::AddPurchase(string_view item) {
+	return AddPurchases(item, 1);
+}
+
+/**
+ * Count several purchases of an item at once. Items not seen before are given the next ID.
+ *
+ * @param item Name of the purchased item, already stripped of surrounding whitespace.
+ * @param count Number of purchases to add.
+ *
+ * @return ID of the item.
+ */
+uint32_t PurchaseIndex::AddPurchases(string_view item, unsigned long long count) {
+	uint32_t id = m_dictionary.Intern(item);
+	if (id == m_counts.size()) {
+		m_counts.push_back(0);
+	}
+	m_counts[id] += count;
+	return id;
+}
+
+/**
+ * @return Maximum number of threads LoadFile() uses to scan a file.
+ */
+unsigned int PurchaseIndex::GetThreadCount() const {
+	return m_threadCount;
+}
+
+/**
+ * Set the maximum number of threads LoadFile() uses to scan a file. Files are only split into
+ * chunks of at least 1 MiB, so small files use fewer threads.
+ *
+ * @param threadCount Number of scan threads. 0 uses one thread per hardware thread.
+ */
+void PurchaseIndex::SetThreadCount(unsigned int threadCount) {
+	if (threadCount == 0) {
+		threadCount = max(1u, thread::hardware_concurrency());
+	}
+	m_threadCount = threadCount;
+}
+
+/**
+ * @return Number of distinct items in the index. Item IDs run from 0 to ItemCount() - 1.
+ */
+size_t PurchaseIndex::ItemCount() const {
+	return m_counts.size();
+}
+
+/**
+ * @return Distinct item names in the order they first appear in the file (as GetItems).
+ */
+vector<string> PurchaseIndex::GetItems() const {
+	vector<string> items;
+	items.reserve(m_counts.size());
+	for (uint32_t id = 0; id < m_counts.size(); ++id) {
+		items.emplace_back(m_dictionary.NameOf(id));
+	}
+	return items;
+}
+
+/**
+ * Look up an item's ID by name. The name must match exactly, including case, after surrounding 
+ * whitespace is stripped.
+ *
+ * @param item Name of the item to look up.
+ *
+ * @return ID of the item, or ItemDictionary::NO_ITEM if it does not appear in the file.
+ */
+uint32_t PurchaseIndex::FindItem(string_view item) const {
+	return m_dictionary.Find(LineScanner::Trim(item));
+}
+
+/**
+ * @param id ID of an item; also its zero-based position in GetItems().
+ *
+ * @return Name of the item. Valid until the index is next changed.
+ */
+string_view PurchaseIndex::ItemAt(uint32_t id) const {
+	return m_dictionary.NameOf(id);
+}
+
+/**
+ * @param id ID of an item; also its zero-based position in GetItems().
+ *
+ * @return Number of purchases of the item.
+ */
+unsigned long long PurchaseIndex::CountAt(uint32_t id) const {
+	return m_counts.at(id);
+}
+
+/**
+ * Number of purchases of a named item (as CountOneItem). See FindItem() for matching rules.
+ *
+ * @param item Name of the item to look up.
+ *
+ * @return Number of purchases of the item, 0 if it does not appear in the file.
+ */
+unsigned long long PurchaseIndex::CountOf(string_view item) const {
+	uint32_t id = FindItem(item);
+	if (id == ItemDictionary::NO_ITEM) {
+		return 0;
+	}
+	return m_counts[id];
+}
+
+/**
+ * Number of purchases of each of a list of items, from one lookup each, so any number of items
+ * can be counted without rereading the file (as CountManyItems). See FindItem() for matching
+ * rules.
+ *
+ * @param items Names of the items to look up. May repeat.
+ *
+ * @return Number of purchases of each item, in the order of items; 0 for items that do not
+ * appear in the file.
+ */
+vector<unsigned long long> PurchaseIndex::CountMany(const vector<string>& items) const {
+	vector<unsigned long long> counts;
+	counts.reserve(items.size());
+	for (const string& item : items) {
+		counts.push_back(CountOf(item));
+	}
+	return counts;
+}
+
+/**
+ * @return Item names and IDs of this index.
+ */
+const ItemDictionary& PurchaseIndex::GetDictionary() const {
+	return m_dictionary;
+}
+
+/**
+ * @return Purchase counts indexed by item ID.
+ */
+const vector<unsigned long long>& PurchaseIndex::GetCounts() const {
+	return m_counts;
+}
+
+/**
+ * Build the item list printed by menu option one (as CountItems). One line per item, in 
+ * first-seen order, with the item name and count separated by dots to a width of 30. E.g.:
+ * Spinach ...................5
+ *
+ * @return String containing every line of the list, each ending in '\n'.
+ */
+string PurchaseIndex::FormatItemCounts() const {
+	string output;
+
+	for (uint32_t id = 0; id < m_counts.size(); ++id) {
+		string_view item = m_dictionary.NameOf(id);
+		string numStr = to_string(m_counts[id]);
+		int spaceWidth = ITEM_COUNT_WIDTH - static_cast<int>(item.size() + numStr.size());
+
+		output += item;
+		output += ' ';
+		output.append(max(spaceWidth, 0), '.');
+		output += numStr;
+		output += '\n';
+	}
+
+	return output;
+}
+
+/* -------------------- Snapshots -------------------- */
+/**
+ * Snapshot file format. All integers are little-endian, as written by x86/x64 and ARM:
+ *   char[8]  "CGIDX001" (magic and format version)
+ *   uint64   input file size
+ *   int64    input file modification time (see FileIdentity)
+ *   uint64   input file checksum: FNV-1a over the size and the first and last 64 KiB
+ *   uint64   bytes of the input file scanned (start of a pending final line, if any)
+ *   uint32   ID of the pending final line's item, or 0xFFFFFFFF
+ *   uint32   length of the scanned tail, then that many bytes (see RecordScan())
+ *   uint64   number of items, n
+ *   uint32[n] name length of each item, in ID order
+ *   uint64[n] purchase count of each item, in ID order
+ *   char[]   every item name, back to back, in ID order
+ *   uint64   FNV-1a checksum of everything above
+ *
+ * A snapshot is used only if its checksum is intact and the input file still has the same size, 
+ * modification time, and sampled checksum. Sampling keeps validation to two small reads while
+ * still catching files that were replaced by a copy with a preserved timestamp. Device and inode
+ * are not stored, so a day's files and their snapshots can be copied to another machine together.
+ */
+
+/**
+ * FNV-1a hash, continued from a previous value. Byte-order independent, unlike 
+ * ItemDictionary::Hash(), so it can be stored in files.
+ */
+static unsigned long long Fnv1a(string_view bytes, 
+								unsigned long long hash = 0xCBF29CE484222325ULL) {
+	for (unsigned char byte : bytes) {
+		hash ^= byte;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+/* Append an integer to a snapshot buffer, little-endian. */
+template <typename T>
+static void AppendValue(string& buffer, T value) {
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		buffer += static_cast<char>((static_cast<unsigned long long>(value) >> (8 * i)) & 0xFF);
+	}
+}
+
+/* Read a little-endian integer from a snapshot buffer. Returns false if the buffer is too short. */
+template <typename T>
+static bool ReadValue(string_view buffer, size_t& offset, T& value) {
+	if (buffer.size() - offset < sizeof(T)) {
+		return false;
+	}
+	unsigned long long result = 0;
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		result |= static_cast<unsigned long long>(static_cast<unsigned char>(buffer[offset + i])) 
+				  << (8 * i);
+	}
+	value = static_cast<T>(result);
+	offset += sizeof(T);
+	return true;
+}
+
+/**
+ * Name of the snapshot file kept next to an input file.
+ *
+ * @param fileName Name of the purchase file.
+ *
+ * @return fileName with ".idx" appended.
+ */
+string PurchaseIndex::SnapshotName(const string& fileName) {
+	return fileName + SNAPSHOT_EXTENSION;
+}
+
+/**
+ * Check whether a file is a snapshot, or a snapshot still being written by SaveSnapshot(), 
+ * rather than a purchase file, so it can be left out when a directory of inputs is expanded.
+ *
+ * @param fileName Name of any file.
+ *
+ * @return true if fileName ends with ".idx" or ".idx.tmp".
+ */
+bool PurchaseIndex::IsSnapshotName(const string& fileName) {
+	string_view name(fileName);
+	string_view tempExtension(SNAPSHOT_TEMP_EXTENSION);
+	if (name.size() >= tempExtension.size() &&
+		name.substr(name.size() - tempExtension.size()) == tempExtension) {
+		name.remove_suffix(tempExtension.size());
+	}
+	return name.size() >= SNAPSHOT_EXTENSION.size() &&
+		name.substr(name.size() - SNAPSHOT_EXTENSION.size()) == SNAPSHOT_EXTENSION;
+}
+
+/**
+ * Replace the contents of this index with a snapshot saved by SaveSnapshot(), if the snapshot is
+ * intact and still matches the purchase file it was made from. After loading, RefreshFile() 
+ * continues from where the snapshot's scan ended.
+ *
+ * @param snapshotName Name of the snapshot file.
+ * @param fileName Name of the purchase file the snapshot should match.
+ *
+ * @return true if the snapshot was loaded. false if it is missing, damaged, or out of date; the
+ * index is then left unchanged.
+ */
+bool PurchaseIndex::LoadSnapshot(const string& snapshotName, const string& fileName) {
+	FileIdentity identity;
+	if (!MappedFile::StatFile(fileName, identity)) {
+		return false;
+	}
+
+	ifstream inFS(snapshotName, ios::in | ios::binary);
+	if (!inFS.is_open()) {
+		return false;
+	}
+	string buffer((istreambuf_iterator<char>(inFS)), istreambuf_iterator<char>());
+	string_view snapshot = buffer;
+
+	// Check the magic, then the whole-file checksum, before trusting any sizes in the file.
+	size_t checksumOffset = snapshot.size() - sizeof(unsigned long long);
+	unsigned long long storedChecksum;
+	if (snapshot.size() < sizeof(SNAPSHOT_MAGIC) + sizeof(unsigned long long) ||
+		memcmp(snapshot.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+		!ReadValue(snapshot, checksumOffset, storedChecksum) ||
+		storedChecksum != Fnv1a(snapshot.substr(0, snapshot.size() - sizeof(storedChecksum)))) {
+		return false;
+	}
+	snapshot.remove_suffix(sizeof(storedChecksum));
+
+	size_t offset = sizeof(SNAPSHOT_MAGIC);
+	unsigned long long sourceSize, sourceChecksum, scannedBytes, itemCount;
+	long long modifiedTime;
+	uint32_t pendingItem, tailLength;
+	if (!ReadValue(snapshot, offset, sourceSize) || !ReadValue(snapshot, offset, modifiedTime) ||
+		!ReadValue(snapshot, offset, sourceChecksum) || !ReadValue(snapshot, offset, scannedBytes) ||
+		!ReadValue(snapshot, offset, pendingItem) || !ReadValue(snapshot, offset, tailLength) ||
+		snapshot.size() - offset < tailLength) {
+		return false;
+	}
+	string_view scannedTail = snapshot.substr(offset, tailLength);
+	offset += tailLength;
+
+	if (sourceSize != identity.size || modifiedTime != identity.modifiedTime ||
+		sourceChecksum != SourceChecksum(fileName, identity.size)) {
+		return false;
+	}
+
+	if (!ReadValue(snapshot, offset, itemCount) ||
+		itemCount > (snapshot.size() - offset) / (sizeof(uint32_t) + sizeof(unsigned long long))) {
+		return false;
+	}
+	size_t lengthsOffset = offset;
+	size_t countsOffset = lengthsOffset + itemCount * sizeof(uint32_t);
+	size_t namesOffset = countsOffset + itemCount * sizeof(unsigned long long);
+
+	ItemDictionary dictionary;
+	vector<unsigned long long> counts(itemCount);
+	for (size_t id = 0; id < itemCount; ++id) {
+		uint32_t nameLength;
+		ReadValue(snapshot, lengthsOffset, nameLength);
+		ReadValue(snapshot, countsOffset, counts[id]);
+		if (snapshot.size() - namesOffset < nameLength ||
+			dictionary.Intern(snapshot.substr(namesOffset, nameLength)) != id) {
+			return false;
+		}
+		namesOffset += nameLength;
+	}
+	if (namesOffset != snapshot.size() || scannedBytes > sourceSize ||
+		(pendingItem != ItemDictionary::NO_ITEM && pendingItem >= itemCount)) {
+		return false;
+	}
+
+	Clear();
+	m_dictionary = move(dictionary);
+	m_counts = move(counts);
+	m_sourceName = fileName;
+	m_sourceIdentity = identity;
+	m_scannedBytes = static_cast<size_t>(scannedBytes);
+	m_scannedTail.assign(scannedTail);
+	m_pendingItem = pendingItem;
+	m_sourceChecksum = sourceChecksum;
+	m_snapshotIdentity = identity;
+	return true;
+}
+
+/**
+ * Write this index to a snapshot file, for LoadSnapshot(). The file is written under a temporary
+ * name and then renamed, so readers never see a partly written snapshot.
+ *
+ * @param snapshotName Name of the snapshot file. Usually SnapshotName(GetSourceName()).
+ *
+ * @return true if the snapshot was written, false if the index wasn't read from a file or the
+ * snapshot couldn't be written.
+ */
+bool PurchaseIndex::SaveSnapshot(const string& snapshotName) {
+	if (m_sourceName.empty()) {
+		return false;
+	}
+
+	string buffer(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	AppendValue(buffer, m_sourceIdentity.size);
+	AppendValue(buffer, m_sourceIdentity.modifiedTime);
+	AppendValue(buffer, m_sourceChecksum);
+	AppendValue(buffer, static_cast<unsigned long long>(m_scannedBytes));
+	AppendValue(buffer, m_pendingItem);
+	AppendValue(buffer, static_cast<uint32_t>(m_scannedTail.size()));
+	buffer += m_scannedTail;
+
+	AppendValue(buffer, static_cast<unsigned long long>(m_counts.size()));
+	for (uint32_t id = 0; id < m_counts.size(); ++id) {
+		AppendValue(buffer, static_cast<uint32_t>(m_dictionary.NameOf(id).size()));
+	}
+	for (unsigned long long count : m_counts) {
+		AppendValue(buffer, count);
+	}
+	for (uint32_t id = 0; id < m_counts.size(); ++id) {
+		buffer += m_dictionary.NameOf(id);
+	}
+	AppendValue(buffer, Fnv1a(buffer));
+
+	string tempName = snapshotName + SNAPSHOT_TEMP_EXTENSION;
+	{
+		ofstream outFS(tempName, ios::out | ios::binary | ios::trunc);
+		if (!outFS.is_open() || !outFS.write(buffer.data(), buffer.size())) {
+			return false;
+		}
+	}
+	// rename() replaces an existing file atomically on POSIX but fails on Windows, where
+	// MoveFileExA does it instead. Either way the old snapshot stays whole until it is replaced.
+#ifdef _WIN32
+	if (!MoveFileExA(tempName.c_str(), snapshotName.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (rename(tempName.c_str(), snapshotName.c_str()) != 0) {
+#endif
+		remove(tempName.c_str());
+		return false;
+	}
+
+	m_snapshotIdentity = m_sourceIdentity;
+	return true;
+}
+
+/**
+ * @return true if the index has scanned its file since it was last saved to or loaded from a
+ * snapshot, so the snapshot is out of date.
+ */
+bool PurchaseIndex::HasUnsavedScan() const {
+	return !m_sourceName.empty() && (m_sourceIdentity.size != m_snapshotIdentity.size ||
+		   m_sourceIdentity.modifiedTime != m_snapshotIdentity.modifiedTime);
+}
+
+/**
+ * @return Name of the file this index was loaded from, or "" if none.
+ */
+const string& PurchaseIndex::GetSourceName() const {
+	return m_sourceName;
+}
+
+/**
+ * Checksum of a file's size and sampled contents, as stored in snapshots.
+ *
+ * @param head Up to the first 64 KiB of the file.
+ * @param tail Up to the last 64 KiB of the file.
+ * @param size Size of the file.
+ *
+ * @return 64-bit FNV-1a checksum.
+ */
+unsigned long long PurchaseIndex::SampleChecksum(string_view head, string_view tail,
+												 unsigned long long size) {
+	string sizeBytes;
+	AppendValue(sizeBytes, size);
+	return Fnv1a(tail, Fnv1a(head, Fnv1a(sizeBytes)));
+}
+
+/**
+ * Read the sampled checksum of a file on disk. Reads at most 128 KiB.
+ *
+ * @param fileName Name of the file.
+ * @param size Size of the file.
+ *
+ * @return Checksum as SampleChecksum(), or 0 if the file can't be read.
+ */
+unsigned long long PurchaseIndex::SourceChecksum(const string& fileName, unsigned long long size) {
+	ifstream inFS(fileName, ios::in | ios::binary);
+	if (!inFS.is_open()) {
+		return 0;
+	}
+
+	size_t sampleBytes = static_cast<size_t>(min<unsigned long long>(size, CHECKSUM_SAMPLE_BYTES));
+	string head(sampleBytes, '\0');
+	string tail(sampleBytes, '\0');
+	inFS.read(&head[0], sampleBytes);
+	inFS.seekg(static_cast<streamoff>(size - sampleBytes));
+	inFS.read(&tail[0], sampleBytes);
+	if (!inFS) {
+		return 0;
+	}
+
+	return SampleChecksum(head, tail, size);
+}
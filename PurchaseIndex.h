@@ -0,0 +1,87 @@
+/**
+ * PurchaseIndex.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See PurchaseIndex.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef PURCHASEINDEX_H
+#define PURCHASEINDEX_H
+
+#include "ItemDictionary.h"
+#include "MappedFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class PurchaseIndex {
+public:
+	PurchaseIndex();
+
+	bool LoadFile(const string& fileName);
+	bool RefreshFile(const string& fileName);
+	void Clear();
+	void Merge(const PurchaseIndex& other);
+	bool LoadSnapshot(const string& snapshotName, const string& fileName);
+	bool SaveSnapshot(const string& snapshotName);
+	bool HasUnsavedScan() const;
+	const string& GetSourceName() const;
+	uint32_t AddPurchase(string_view item);
+	uint32_t AddPurchases(string_view item, unsigned long long count);
+
+	unsigned int GetThreadCount() const;
+	void SetThreadCount(unsigned int threadCount);
+
+	size_t ItemCount() const;
+	vector<string> GetItems() const;
+	uint32_t FindItem(string_view item) const;
+	string_view ItemAt(uint32_t id) const;
+	unsigned long long CountAt(uint32_t id) const;
+	unsigned long long CountOf(string_view item) const;
+	vector<unsigned long long> CountMany(const vector<string>& items) const;
+	const ItemDictionary& GetDictionary() const;
+	const vector<unsigned long long>& GetCounts() const;
+
+	string FormatItemCounts() const;
+
+	static string SnapshotName(const string& fileName);
+	static bool IsSnapshotName(const string& fileName);
+
+private:
+	/* Counts for one chunk of a file, indexed by the chunk's own item IDs. */
+	struct ChunkCounts {
+		ItemDictionary dictionary;
+		vector<unsigned long long> counts;
+	};
+
+	void ScanText(string_view text, MappedFile* mappedFile);
+	static void CountChunk(string_view text, MappedFile* mappedFile, ChunkCounts& chunk);
+	size_t ReadFrom(const MappedFile& inputFile, size_t begin);
+	bool IsAppendedTo(const MappedFile& inputFile, const string& fileName) const;
+	void RecordScan(const MappedFile& inputFile, const string& fileName, size_t size);
+	void UncountPendingItem();
+	void ForgetSource();
+	static unsigned long long SampleChecksum(string_view head, string_view tail, 
+											 unsigned long long size);
+	static unsigned long long SourceChecksum(const string& fileName, unsigned long long size);
+
+	unsigned int m_threadCount;
+	ItemDictionary m_dictionary;
+	vector<unsigned long long> m_counts;
+
+	string m_sourceName;
+	FileIdentity m_sourceIdentity;
+	size_t m_scannedBytes;
+	string m_scannedTail;
+	uint32_t m_pendingItem;
+	unsigned long long m_sourceChecksum;
+	FileIdentity m_snapshotIdentity;
+};
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * PyConvert.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Conversions between C++ values and Python objects, used by PyInterface::Call<R>() to pass
+ * arguments and read return values. Header only, because the conversions are templates chosen
+ * at compile time from the argument and return types.
+ *
+ * PyConvert<T> is specialized for:
+ * - integral types (int, long long, size_t, ...) and bool: Python int and bool.
+ * - float and double: Python float (Python ints are also accepted as return values).
+ * - string, string_view, const char*: Python str, built straight from the characters (UTF-8)
+ *   with no intermediate copy.
+ * - vector<T>: Python list as an argument; any list or tuple as a return value.
+ * - map<string, V>: Python dict.
+ *
+ * Each specialization has:
+ * - static PyObject* ToPython(const T& value): new reference, or nullptr with a Python error set.
+ * - static bool FromPython(PyObject* pValue, T& value): false with a Python error set if pValue
+ *   isn't the right type or is out of range.
+ * - static T ErrorValue(): returned by Call<T>() when the call or the conversion fails.
+ *
+ * Add a specialization to support another type with Call<R>().
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#pragma once
+
+#ifndef PYCONVERT_H
+#define PYCONVERT_H
+
+/* Python.h must see this first: "#" argument formats take Py_ssize_t lengths. */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+template <typename T, typename Enable = void>
+struct PyConvert;
+
+/* Integral types except bool. Out-of-range values fail with OverflowError. */
+template <typename T>
+struct PyConvert<T, typename enable_if<is_integral<T>::value && !is_same<T, bool>::value>::type> {
+	static PyObject* ToPython(const T& value) {
+		if (is_signed<T>::value) {
+			return PyLong_FromLongLong(static_cast<long long>(value));
+		}
+		return PyLong_FromUnsignedLongLong(static_cast<unsigned long long>(value));
+	}
+
+	static bool FromPython(PyObject* pValue, T& value) {
+		if (!PyLong_Check(pValue)) {
+			PyErr_SetString(PyExc_TypeError, "expected an int");
+			return false;
+		}
+		if (is_signed<T>::value) {
+			long long result = PyLong_AsLongLong(pValue);
+			if (result == -1 && PyErr_Occurred()) {
+				return false;
+			}
+			if (result < static_cast<long long>(numeric_limits<T>::min()) ||
+				result > static_cast<long long>(numeric_limits<T>::max())) {
+				PyErr_SetString(PyExc_OverflowError, "int out of range");
+				return false;
+			}
+			value = static_cast<T>(result);
+			return true;
+		}
+		unsigned long long result = PyLong_AsUnsignedLongLong(pValue);
+		if (result == static_cast<unsigned long long>(-1) && PyErr_Occurred()) {
+			return false;
+		}
+		if (result > static_cast<unsigned long long>(numeric_limits<T>::max())) {
+			PyErr_SetString(PyExc_OverflowError, "int out of range");
+			return false;
+		}
+		value = static_cast<T>(result);
+		return true;
+	}
+
+	/* -1 for signed types, as the CallIntFunc overloads returned; the maximum for unsigned. */
+	static T ErrorValue() {
+		return static_cast<T>(-1);
+	}
+};
+
+template <>
+struct PyConvert<bool> {
+	static PyObject* ToPython(const bool& value) {
+		return PyBool_FromLong(value ? 1 : 0);
+	}
+
+	static bool FromPython(PyObject* pValue, bool& value) {
+		int result = PyObject_IsTrue(pValue);
+		if (result < 0) {
+			return false;
+		}
+		value = result != 0;
+		return true;
+	}
+
+	static bool ErrorValue() {
+		return false;
+	}
+};
+
+/* float and double. */
+template <typename T>
+struct PyConvert<T, typename enable_if<is_floating_point<T>::value>::type> {
+	static PyObject* ToPython(const T& value) {
+		return PyFloat_FromDouble(static_cast<double>(value));
+	}
+
+	static bool FromPython(PyObject* pValue, T& value) {
+		double result = PyFloat_AsDouble(pValue);
+		if (result == -1.0 && PyErr_Occurred()) {
+			return false;
+		}
+		value = static_cast<T>(result);
+		return true;
+	}
+
+	static T ErrorValue() {
+		return static_cast<T>(-1.0);
+	}
+};
+
+template <>
+struct PyConvert<string_view> {
+	static PyObject* ToPython(const string_view& value) {
+		return PyUnicode_FromStringAndSize(value.data(), static_cast<Py_ssize_t>(value.size()));
+	}
+
+	// No FromPython: a string_view can't own the characters of a Python str.
+};
+
+template <>
+struct PyConvert<string> {
+	static PyObject* ToPython(const string& value) {
+		return PyConvert<string_view>::ToPython(value);
+	}
+
+	static bool FromPython(PyObject* pValue, string& value) {
+		Py_ssize_t length;
+		const char* chars = PyUnicode_AsUTF8AndSize(pValue, &length);
+		if (chars == nullptr) {
+			return false;
+		}
+		value.assign(chars, static_cast<size_t>(length));
+		return true;
+	}
+
+	static string ErrorValue() {
+		return string();
+	}
+};
+
+template <>
+struct PyConvert<const char*> {
+	static PyObject* ToPython(const char* const& value) {
+		if (value == nullptr) {
+			Py_RETURN_NONE;
+		}
+		return PyUnicode_FromString(value);
+	}
+};
+
+template <>
+struct PyConvert<char*> {
+	static PyObject* ToPython(char* const& value) {
+		return PyConvert<const char*>::ToPython(value);
+	}
+};
+
+template <typename T>
+struct PyConvert<vector<T>> {
+	static PyObject* ToPython(const vector<T>& values) {
+		PyObject* pList = PyList_New(static_cast<Py_ssize_t>(values.size()));
+		if (pList == nullptr) {
+			return nullptr;
+		}
+		for (size_t i = 0; i < values.size(); ++i) {
+			PyObject* pItem = PyConvert<T>::ToPython(values[i]);
+			if (pItem == nullptr) {
+				Py_DECREF(pList);
+				return nullptr;
+			}
+			// PyList_SET_ITEM steals the reference to pItem
+			PyList_SET_ITEM(pList, static_cast<Py_ssize_t>(i), pItem);
+		}
+		return pList;
+	}
+
+	static bool FromPython(PyObject* pValue, vector<T>& values) {
+		if (!PyList_Check(pValue) && !PyTuple_Check(pValue)) {
+			PyErr_SetString(PyExc_TypeError, "expected a list or tuple");
+			return false;
+		}
+		// pValue is a list or tuple, so PySequence_Fast returns it with a new reference.
+		PyObject* pSequence = PySequence_Fast(pValue, "expected a list or tuple");
+		Py_ssize_t size = PySequence_Fast_GET_SIZE(pSequence);
+		PyObject** pItems = PySequence_Fast_ITEMS(pSequence);
+
+		values.clear();
+		values.reserve(static_cast<size_t>(size));
+		for (Py_ssize_t i = 0; i < size; ++i) {
+			T value;
+			if (!PyConvert<T>::FromPython(pItems[i], value)) {
+				Py_DECREF(pSequence);
+				return false;
+			}
+			values.push_back(move(value));
+		}
+		Py_DECREF(pSequence);
+		return true;
+	}
+
+	static vector<T> ErrorValue() {
+		return vector<T>();
+	}
+};
+
+template <typename V>
+struct PyConvert<map<string, V>> {
+	static PyObject* ToPython(const map<string, V>& values) {
+		PyObject* pDict = PyDict_New();
+		if (pDict == nullptr) {
+			return nullptr;
+		}
+		for (const auto& entry : values) {
+			// Keys are built with their length, not as C strings, so names with a NUL in them
+			// stay distinct.
+			PyObject* pKey = PyConvert<string>::ToPython(entry.first);
+			PyObject* pValue = (pKey == nullptr) ? nullptr : PyConvert<V>::ToPython(entry.second);
+			if (pValue == nullptr || PyDict_SetItem(pDict, pKey, pValue) != 0) {
+				Py_XDECREF(pKey);
+				Py_XDECREF(pValue);
+				Py_DECREF(pDict);
+				return nullptr;
+			}
+			Py_DECREF(pKey);
+			Py_DECREF(pValue);
+		}
+		return pDict;
+	}
+
+	static bool FromPython(PyObject* pValue, map<string, V>& values) {
+		if (!PyDict_Check(pValue)) {
+			PyErr_SetString(PyExc_TypeError, "expected a dict");
+			return false;
+		}
+
+		values.clear();
+		PyObject* pKey;
+		PyObject* pItem;
+		Py_ssize_t position = 0;
+		// pKey and pItem are borrowed references
+		while (PyDict_Next(pValue, &position, &pKey, &pItem)) {
+			string key;
+			V value;
+			if (!PyConvert<string>::FromPython(pKey, key) ||
+				!PyConvert<V>::FromPython(pItem, value)) {
+				return false;
+			}
+			values.emplace(move(key), move(value));
+		}
+		return true;
+	}
+
+	static map<string, V> ErrorValue() {
+		return map<string, V>();
+	}
+};
+
+#endif
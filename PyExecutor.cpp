@@ -0,0 +1,136 @@
+/**
+ * PyExecutor.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Runs Python calls on a dedicated worker thread, so the console stays responsive while a long
+ * call (e.g. ChartItems on a big file) runs. The worker thread owns a PyInterface: it starts the
+ * interpreter, imports the module, makes every call, and finalizes the interpreter, so the GIL
+ * never leaves that thread and no other thread needs to take it.
+ *
+ * Use:
+ * - Submit<R>(name, args...) queues a call to a Python function, as PyInterface::Call<R>(), and
+ * returns a future for its result. Run(task) queues any callable taking a PyInterface&.
+ * - Queued calls run one at a time in the order they were submitted.
+ * - The caller may wait on the future, poll it with wait_for() to show progress (as
+ * GrocerMenuFuncs does), or go on queueing more work.
+ * - Shutdown() (or the destructor) stops accepting calls, waits for the queued calls to finish,
+ * and finalizes the interpreter on the worker thread.
+ *
+ * Thread notes:
+ * - Don't use other PyInterface objects while a PyExecutor is running: they share its
+ * interpreter but not its thread.
+ * - The "grocer" module (see GrocerPyModule.cpp) reads a shared PurchaseIndex from the worker
+ * thread. Don't modify a shared index while calls that may read it are queued or running.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "PyExecutor.h"
+
+using namespace std;
+
+/**
+ * Constructor. Starts the worker thread, which starts the Python interpreter and imports the
+ * module. Calls may be submitted right away; they run once the module is imported.
+ *
+ * @param pyModuleName String of Python filename _without .py extension_ to load from. Must stay
+ * valid for the life of the executor (e.g. a string literal).
+ */
+PyExecutor::PyExecutor(const char* pyModuleName) {
+	m_pyModuleName = pyModuleName;
+	m_pendingCount = 0;
+	m_stopping = false;
+	m_worker = thread(&PyExecutor::WorkerLoop, this);
+}
+
+/**
+ * Destructor. Finishes the queued calls and finalizes the interpreter. See Shutdown().
+ */
+PyExecutor::~PyExecutor() {
+	Shutdown();
+}
+
+/**
+ * Share a PurchaseIndex's counts with Python code through the "grocer" module, as
+ * PyInterface::SetPurchaseIndex(). Queued, so calls submitted before this still see the index
+ * that was shared before.
+ *
+ * @param purchaseIndex Index to share, or nullptr to stop sharing. Must stay alive while shared.
+ */
+void PyExecutor::SetPurchaseIndex(const PurchaseIndex* purchaseIndex) {
+	Run([purchaseIndex](PyInterface& pyInterface) {
+		pyInterface.SetPurchaseIndex(purchaseIndex);
+	});
+}
+
+/**
+ * @return Number of calls queued or running.
+ */
+size_t PyExecutor::GetPendingCount() {
+	lock_guard<mutex> lock(m_mutex);
+	return m_pendingCount;
+}
+
+/**
+ * Stop accepting calls, wait for the queued calls to finish, and finalize the interpreter. Later
+ * calls to Submit() and Run() return futures holding a runtime_error. Safe to call more than once.
+ */
+void PyExecutor::Shutdown() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_queueChanged.notify_one();
+
+	if (m_worker.joinable()) {
+		m_worker.join();
+	}
+}
+
+/**
+ * Add a task to the end of the queue.
+ *
+ * @param task Task to run on the worker thread.
+ *
+ * @return false if the executor has been shut down and the task wasn't queued.
+ */
+bool PyExecutor::Enqueue(function<void(PyInterface&)> task) {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_stopping) {
+			return false;
+		}
+		m_queue.push_back(move(task));
+		++m_pendingCount;
+	}
+	m_queueChanged.notify_one();
+	return true;
+}
+
+/**
+ * Body of the worker thread. Owns the PyInterface, so the interpreter is started and finalized
+ * on this thread, and runs queued tasks in order until shut down and the queue is empty.
+ */
+void PyExecutor::WorkerLoop() {
+	PyInterface pyInterface(m_pyModuleName);
+
+	while (true) {
+		function<void(PyInterface&)> task;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_queueChanged.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+			if (m_queue.empty()) {
+				break;
+			}
+			task = move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		task(pyInterface);
+
+		lock_guard<mutex> lock(m_mutex);
+		--m_pendingCount;
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * PyExecutor.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See PyExecutor.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef PYEXECUTOR_H
+#define PYEXECUTOR_H
+
+#include "PyInterface.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+using namespace std;
+
+class PyExecutor {
+public:
+	PyExecutor(const char* pyModuleName = "PythonCode");
+	~PyExecutor();
+	PyExecutor(const PyExecutor&) = delete;
+	PyExecutor& operator=(const PyExecutor&) = delete;
+
+	template <typename R = void, typename... Args>
+	future<R> Submit(const string& proc, const Args&... args);
+	template <typename F>
+	future<typename invoke_result<F, PyInterface&>::type> Run(F task);
+
+	void SetPurchaseIndex(const PurchaseIndex* purchaseIndex);
+	size_t GetPendingCount();
+	void Shutdown();
+
+private:
+	/* Type a Submit() argument is stored as until the call runs: views and C strings are copied
+	 * into strings, so the caller's buffers needn't outlive the call. */
+	template <typename T>
+	struct Stored {
+		typedef typename decay<T>::type type;
+	};
+
+	bool Enqueue(function<void(PyInterface&)> task);
+	void WorkerLoop();
+
+	const char* m_pyModuleName;
+	mutex m_mutex;
+	condition_variable m_queueChanged;
+	deque<function<void(PyInterface&)>> m_queue;
+	size_t m_pendingCount;
+	bool m_stopping;
+	thread m_worker;
+};
+
+template <>
+struct PyExecutor::Stored<string_view> {
+	typedef string type;
+};
+
+template <>
+struct PyExecutor::Stored<const char*> {
+	typedef string type;
+};
+
+template <>
+struct PyExecutor::Stored<char*> {
+	typedef string type;
+};
+
+/**
+ * Queue a call to the Python function named "proc", as PyInterface::Call<R>(proc, args...), and
+ * return its result as a future. The arguments are copied (string_views and C strings into
+ * strings), so they needn't outlive the call. Python's sys.stdout is flushed after the call, so
+ * anything it printed is written before the future is ready. E.g.:
+ *   future<int> charted = pyExecutor.Submit<int>("ChartItems", inputFileName, outputFileName);
+ *   ...
+ *   int result = charted.get();
+ *
+ * Defined in this header because it is a template.
+ *
+ * @param proc Name of function in Python module.
+ * @param args Arguments for the function: any types with a PyConvert specialization.
+ *
+ * @return Future for the function's result, or PyConvert<R>::ErrorValue() if the call failed.
+ * Holds a runtime_error if the executor has been shut down.
+ */
+template <typename R, typename... Args>
+future<R> PyExecutor::Submit(const string& proc, const Args&... args) {
+	// decay<const Args> turns string literals into const char*, as in PyInterface::Call<R>().
+	tuple<typename Stored<typename decay<const Args>::type>::type...> storedArgs(args...);
+	return Run([proc, storedArgs](PyInterface& pyInterface) {
+		return apply([&pyInterface, &proc](const auto&... args) {
+			if constexpr (is_void<R>::value) {
+				pyInterface.Call<R>(proc, args...);
+				pyInterface.FlushOutput();
+			}
+			else {
+				R result = pyInterface.Call<R>(proc, args...);
+				pyInterface.FlushOutput();
+				return result;
+			}
+		}, storedArgs);
+	});
+}
+
+/**
+ * Queue a task that uses the executor's PyInterface, e.g. several calls that must run together,
+ * and return its result as a future. The task runs on the executor's thread after every task
+ * queued before it. An exception thrown by the task is rethrown by the future's get().
+ *
+ * Defined in this header because it is a template.
+ *
+ * @param task Callable taking a PyInterface&.
+ *
+ * @return Future for the task's result. Holds a runtime_error if the executor has been shut down.
+ */
+template <typename F>
+future<typename invoke_result<F, PyInterface&>::type> PyExecutor::Run(F task) {
+	typedef typename invoke_result<F, PyInterface&>::type R;
+
+	// function<> must be copyable and packaged_task isn't, so the queue holds a shared one.
+	auto pTask = make_shared<packaged_task<R(PyInterface&)>>(move(task));
+	future<R> result = pTask->get_future();
+	if (!Enqueue([pTask](PyInterface& pyInterface) { (*pTask)(pyInterface); })) {
+		promise<R> refused;
+		refused.set_exception(make_exception_ptr(runtime_error("PyExecutor is shut down")));
+		return refused.get_future();
+	}
+	return result;
+}
+
+#endif
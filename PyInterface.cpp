@@ -4,11 +4,14 @@
  *    Author: James Furman
  *    Date: 2022-12-11
  * 
- * Interface to call methods from an attached python file. Presently can call Python functions
- * with no return in Python (returns void), int return, float return in Python (returns double), 
- * and list-of-strings return (returns vector<string>).
+ * Interface to call methods from an attached python file. Call<R>(name, args...) (defined in 
+ * PyInterface.h) calls a Python function with any number of arguments and converts its return 
+ * value to R, both chosen at compile time: no return (void), int and other integers, double,
+ * string, vector<T> from a list or tuple, and map<string, V> from a dict. Arguments may be any
+ * of those types, string_view, or string literals. The older CallIntFunc, CallDoubleFunc, 
+ * CallListFunc, and CallProcedure functions are kept as shorthands for common Call<R>() uses.
  * 
- * Extensible to support other return types. 
+ * Extensible to support other types: add a PyConvert specialization (see PyConvert.h).
  * 
  * Use:
  * - .py file must be located in Release repo. In MS VS, use Release x64 mode and locate .py
@@ -18,6 +21,40 @@
  * "ProjectPyExt.py", call should be: PyInterface("ProjectPyExt");
  * - Multiple .py files may be loaded with one PyInterface object each. 
  * 
+ * Session notes:
+ * - The Python interpreter is started once, when the first PyInterface object is constructed, and
+ * finalized when the last one is destroyed. The module is imported once per object and each 
+ * function handle is resolved once and cached by name, so a call costs one Python function call
+ * rather than a full interpreter boot, import, and teardown.
+ * - Because the interpreter outlives each call, module-level state in the .py file persists
+ * between calls for the life of the PyInterface object. 
+ * - PyInterface objects are not copyable; pass them by pointer (as GrocerBatch does).
+ * - A PyInterface must be used on the thread that created it. To call Python without blocking
+ * the calling thread, use a PyExecutor (see PyExecutor.cpp), which owns a PyInterface on its own
+ * worker thread.
+ * - CaptureOutput() sends what Python prints to a buffer until ReleaseOutput() returns it, so a
+ * call that runs in the background can print its report once it is done.
+ * - The built-in module "grocer" (see GrocerPyModule.cpp) is registered before the interpreter
+ * starts, so Python code can "import grocer" to read counts shared with SetPurchaseIndex() 
+ * instead of re-reading the input file.
+ * - With LatencyStats enabled (see LatencyStats.cpp), each phase is timed: starting the 
+ * interpreter, importing the module, and for every Call<R>() converting the arguments, running
+ * the function, and converting the result.
+ * 
+ * Result cache:
+ * - Results of functions named with CacheResults() are kept, converted, in a least recently used
+ * cache of up to GetResultCacheCapacity() results. A call with the same arguments as a cached 
+ * call returns the cached result without entering the interpreter.
+ * - The key is the function name and every argument. A string argument that names an existing 
+ * file (or directory) also adds the file's identity to the key: device, inode, size, and 
+ * modification time. So when the file is appended to, rewritten, or replaced, the next call
+ * misses and reads the new version; the old result ages out of the cache.
+ * - Only cache functions whose result depends on nothing but their arguments and the files they
+ * read, and that have no side effects such as printing: a cached call doesn't run at all. Calls
+ * with no return value (Call<void>) and failed calls are never cached.
+ * - GetCacheHits() and GetCacheMisses() count lookups for cached functions. They may be read 
+ * from any thread.
+ * 
  * Bug notes:
  * - Hard to troubleshoot because of mixed code and Python interpreter. 
  * - First resort: Always check for console error messages from Python. 
@@ -34,325 +71,465 @@
  */
 
 #include "PyInterface.h"
+#include "GrocerPyModule.h"
+#include "MappedFile.h"
 
 using namespace std;
 
+/* Number of live PyInterface objects sharing the embedded interpreter. */
+int PyInterface::s_sessionCount = 0;
+
 /**
  * Constructor takes string for Python filename _without .py extension_ to load from. Default 
  * constructor will load from "PythonCode.py"
  * 
+ * Starts the Python interpreter if no other PyInterface object has already done so, then imports
+ * the module. The module stays loaded until this object is destroyed. 
+ * 
  * @param pyModuleName String of Python filename _without .py extension_ to load from.
  */
 PyInterface::PyInterface(const char* pyModuleName) {
 	this->m_pyModuleName = pyModuleName;
+	this->m_cacheCapacity = DEFAULT_RESULT_CACHE_CAPACITY;
+	this->m_cacheHits = 0;
+	this->m_cacheMisses = 0;
+	this->m_savedStdout = nullptr;
+
+	if (s_sessionCount == 0) {
+		ScopedTimer timer(LatencyStats::Metric::PyInitialize);
+		GrocerPyModule::Register();
+		Py_Initialize();
+	}
+	++s_sessionCount;
+
+	ScopedTimer timer(LatencyStats::Metric::PyImport);
+	this->m_pyModule = PyImport_ImportModule(this->m_pyModuleName);
+	if (this->m_pyModule == nullptr) {
+		PyErr_Print();
+	}
+}
+
+/**
+ * Destructor. Releases cached function handles and the module, and finalizes the Python 
+ * interpreter if this is the last PyInterface object using it.
+ */
+PyInterface::~PyInterface() {
+	for (auto& cached : m_functionCache) {
+		Py_XDECREF(cached.second);
+	}
+	m_functionCache.clear();
+	ClearResultCache();
+	ReleaseOutput();
+	Py_XDECREF(m_pyModule);
+	m_pyModule = nullptr;
+
+	--s_sessionCount;
+	if (s_sessionCount == 0) {
+		Py_Finalize();
+	}
+}
+
+/**
+ * Look up a callable named "proc" in the loaded module. The handle is resolved on first use and
+ * cached by name for the life of this object.
+ * 
+ * @param proc Name of function in Python module.
+ * 
+ * @return Borrowed reference to the callable, or nullptr (with the Python error printed) if the
+ * module failed to load or has no callable by that name.
+ */
+PyObject* PyInterface::GetFunction(const string& proc) {
+	auto cached = m_functionCache.find(proc);
+	if (cached != m_functionCache.end()) {
+		return cached->second;
+	}
+
+	if (m_pyModule == nullptr) {
+		cout << "Python module " << m_pyModuleName << " is not loaded." << endl;
+		return nullptr;
+	}
+
+	PyObject* pFunc = PyObject_GetAttrString(m_pyModule, proc.c_str());
+	if (pFunc == nullptr || !PyCallable_Check(pFunc)) {
+		PyErr_Print();
+		Py_XDECREF(pFunc);
+		return nullptr;
+	}
+
+	m_functionCache.emplace(proc, pFunc);
+	return pFunc;
+}
+
+/**
+ * Call the cached Python function named "proc" with the vectorcall protocol. Used by Call<R>().
+ * 
+ * @param proc Name of function in Python module.
+ * @param pArgs Borrowed references to the arguments. pArgs[-1] must be writable scratch space
+ * (PY_VECTORCALL_ARGUMENTS_OFFSET). If any argument is nullptr (a failed conversion, with the 
+ * Python error set), the function isn't called.
+ * @param argCount Number of arguments.
+ * 
+ * @return New reference to the function's result, or nullptr (with the Python error printed) if
+ * the call failed. 
+ */
+PyObject* PyInterface::CallVector(const string& proc, PyObject* const* pArgs, size_t argCount) {
+	for (size_t i = 0; i < argCount; ++i) {
+		if (pArgs[i] == nullptr) {
+			PyErr_Print();
+			cout << "Couldn't convert argument " << i + 1 << " for " << proc << "." << endl;
+			return nullptr;
+		}
+	}
+
+	PyObject* pFunc = GetFunction(proc);
+	if (pFunc == nullptr) {
+		return nullptr;
+	}
+
+	PyObject* presult = PyObject_Vectorcall(pFunc, pArgs, argCount | PY_VECTORCALL_ARGUMENTS_OFFSET,
+											nullptr);
+	if (presult == nullptr) {
+		PyErr_Print();
+	}
+	return presult;
 }
 
 
 /**
  * Call a Python function named "proc" that takes no arguments. E.g., if Python module contains
  * "def ThisPyFunc:..." (with full function definition), CallProcedure("ThisPyFunc") will call 
- * that Python function.
+ * that Python function. Same as Call(proc).
  * 
  * @param proc name of function to call in Python module.
  */
 void PyInterface::CallProcedure(string proc) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	Py_Initialize();
-	PyObject* my_module = PyImport_ImportModule(this->m_pyModuleName);
-	PyErr_Print();
-	PyObject* my_function = PyObject_GetAttrString(my_module, procname);
-	PyObject* my_result = PyObject_CallObject(my_function, NULL);
-	Py_Finalize();
-
-	delete[] procname;
+	Call(proc);
 }
 
 /**
  * Call a Python function named "proc" that has two string parameters, passing param1 and param2
  * values as args to those two params. Returns an int that can do nothing, function as an exit code
  * in the Python function, or represent something specific to the contents of the Python function.
+ * Same as Call<int>(proc, param1, param2).
  * 
  * @param proc Name of function in Python code to call. Must have two string parameters.
  * @param param1 String of the first argument for Python function.
  * @param param2 String of the second argument for Python function.
  * 
- * @return int that can serve various functions (or none). 
+ * @return int that can serve various functions (or none). -1 if the call failed.
  */
 int PyInterface::CallIntFunc(string proc, string param1, string param2) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	char* param1val = new char[param1.length() + 1];
-	strcpy(param1val, param1.c_str());
-
-	char* param2val = new char[param2.length() + 1];
-	strcpy(param2val, param2.c_str());
-
-	PyObject* pName, * pModule, * pDict, * pFunc, * pValue = nullptr, * presult = nullptr;
-	Py_Initialize();
-	pName = PyUnicode_FromString((char*)this->m_pyModuleName);
-	pModule = PyImport_Import(pName);
-	pDict = PyModule_GetDict(pModule);
-	pFunc = PyDict_GetItemString(pDict, procname);
-	if (PyCallable_Check(pFunc)) {
-		pValue = Py_BuildValue("(zz)", param1val, param2val);
-		PyErr_Print();
-		presult = PyObject_CallObject(pFunc, pValue);
-		PyErr_Print();
-	}
-	else {
-		PyErr_Print();
-	}
-
-	//printf("Result is %d\n", _PyLong_AsInt(presult));
-	Py_DECREF(pValue);
-	// Clean up
-	Py_DECREF(pModule);
-	Py_DECREF(pName);
-	// Finish the Python Interpreter
-	Py_Finalize();
-
-	// clean 
-	delete[] procname;
-	delete[] param1val;
-	delete[] param2val;
-
-	return _PyLong_AsInt(presult);
+	return Call<int>(proc, param1, param2);
 }
 
 /**
  * Call a Python function named "proc" that has one string parameter, passing param value as 
  * the arg to that param. Returns an int that can do nothing, function as an exit code in the 
  * Python function, or represent something specific to the contents of the Python function.
+ * Same as Call<int>(proc, param).
  * 
  * @param proc Name of function in Python code to call. Must have one string parameter.
  * @param param String of the argument for Python function.
  * 
- * @return int that can serve various functions (or none). 
+ * @return int that can serve various functions (or none). -1 if the call failed.
  */
 int PyInterface::CallIntFunc(string proc, string param) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	char* paramval = new char[param.length() + 1];
-	strcpy(paramval, param.c_str());
-
-
-	PyObject* pName, * pModule, * pDict, * pFunc, * pValue = nullptr, * presult = nullptr;
-	// Initialize the Python Interpreter
-	Py_Initialize();
-	// Build the name object
-	pName = PyUnicode_FromString((char*)this->m_pyModuleName);
-	// Load the module object
-	pModule = PyImport_Import(pName);
-	// pDict is a borrowed reference 
-	pDict = PyModule_GetDict(pModule);
-
-	// pFunc is also a borrowed reference
-	pFunc = PyDict_GetItemString(pDict, procname);
-	if (PyCallable_Check(pFunc)) {
-		pValue = Py_BuildValue("(z)", paramval);
-		PyErr_Print();
-		presult = PyObject_CallObject(pFunc, pValue);
-		PyErr_Print();
-	}
-	else {
-		PyErr_Print();
-	}
-	//printf("Result is %d\n", _PyLong_AsInt(presult));
-	Py_DECREF(pValue);
-	// Clean up
-	Py_DECREF(pModule);
-	Py_DECREF(pName);
-	// Finish the Python Interpreter
-	Py_Finalize();
-
-	// clean 
-	delete[] procname;
-	delete[] paramval;
-
-
-	return _PyLong_AsInt(presult);
+	return Call<int>(proc, param);
 }
 
 /**
  * Call a Python function named "proc" that has one int parameter, passing-by const param as 
  * the arg to that param. Returns an int that can do nothing, function as an exit code in the 
  * Python function, or represent something specific to the contents of the Python function.
+ * Same as Call<int>(proc, param).
  * 
  * @param proc Name of function in Python code to call. Must have one int parameter.
  * @param param int of the argument for Python function.
  * 
- * @return int that can serve various functions (or none). 
-
+ * @return int that can serve various functions (or none). -1 if the call failed.
  */
 int PyInterface::CallIntFunc(string proc, const int& param) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	PyObject* pName, * pModule, * pDict, * pFunc, * pValue = nullptr, * presult = nullptr;
-	// Initialize the Python Interpreter
-	Py_Initialize();
-	// Build the name object
-	pName = PyUnicode_FromString((char*)this->m_pyModuleName);
-	// Load the module object
-	pModule = PyImport_Import(pName);
-	// pDict is a borrowed reference 
-	pDict = PyModule_GetDict(pModule);
-	// pFunc is also a borrowed reference 
-	pFunc = PyDict_GetItemString(pDict, procname);
-	if (PyCallable_Check(pFunc)) {
-		pValue = Py_BuildValue("(i)", param);
-		PyErr_Print();
-		presult = PyObject_CallObject(pFunc, pValue);
-		PyErr_Print();
-	}
-	else {
-		PyErr_Print();
-	}
-	//printf("Result is %d\n", _PyLong_AsInt(presult));
-	Py_DECREF(pValue);
-	// Clean up
-	Py_DECREF(pModule);
-	Py_DECREF(pName);
-	// Finish the Python Interpreter
-	Py_Finalize();
-
-	// clean 
-	delete[] procname;
-
-	return _PyLong_AsInt(presult);
+	return Call<int>(proc, param);
 }
 
 /**
  * Call a Python function named "proc" that has one floating-point parameter, passing param values 
  * as the arg to that param. Returns a double that can do nothing, function as an exit code in the
  * Python function, or represent something specific to the contents of the Python function.
+ * Same as Call<double>(proc, param).
  * 
  * @param proc Name of function in Python code to call. Must have one floating-point parameter.
  * @param param Double of the argument for Python function.
  * 
- * @return double that can serve various functions (or none). 
-
+ * @return double that can serve various functions (or none). -1.0 if the call failed.
  */
 double PyInterface::CallDoubleFunc(string proc, double param) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	PyObject* pName, * pModule, * pDict, * pFunc, * pValue = nullptr, * presult = nullptr;
-	// Initialize the Python Interpreter
-	Py_Initialize();
-	// Build the name object
-	pName = PyUnicode_FromString((char*)this->m_pyModuleName);
-	// Load the module object
-	pModule = PyImport_Import(pName);
-	// pDict is a borrowed reference 
-	pDict = PyModule_GetDict(pModule);
-	// pFunc is also a borrowed reference 
-	pFunc = PyDict_GetItemString(pDict, procname);
-	if (PyCallable_Check(pFunc)) {
-		pValue = Py_BuildValue("(d)", param);
-		PyErr_Print();
-		presult = PyObject_CallObject(pFunc, pValue);
-		PyErr_Print();
-	}
-	else {
-		PyErr_Print();
-	}
-	//printf("Result is %d\n", _PyLong_AsInt(presult));
-	Py_DECREF(pValue);
-	// Clean up
-	Py_DECREF(pModule);
-	Py_DECREF(pName);
-	// Finish the Python Interpreter
-	Py_Finalize();
-
-	// clean 
-	delete[] procname;
-
-	return PyFloat_AsDouble(presult);
-	//return _PyLong_AsInt(presult);
+	return Call<double>(proc, param);
 }
 
-
 /**
  * Call a Python function named "proc" that has one string parameter, passing param value as 
  * the arg to that param. Returns a vector<string> constructed from a list of strings returned
- * by the Python function. 
+ * by the Python function. Same as Call<vector<string>>(proc, param).
  * 
  * Bugs:
- * - If a list is not successfully returned by the Python function, this method *may* return an
- * empty vector<string>. 
- * - This method must take a list returned by Python, declare a C++ vector, and iterate through 
- * the Python list, pushing back each value to the vector. Check for issues in for-loop near the
- * end. 
- * - Check that the data type of _every item in the returned Python list_ matches the data type of
- * this function's return vector. 
+ * - If a list of strings is not successfully returned by the Python function (including if any
+ * item in it is not a string), this method returns an empty vector<string>. 
  * 
  * @param proc Name of function in Python code to call. Must have one string parameter.
  * @param param String of the argument for Python function.
  * 
  * @return vector<string> constructed from a list of strings returned by the Python function. 
-
  */
 vector<string> PyInterface::CallListFunc(string proc, string param) {
-	char* procname = new char[proc.length() + 1];
-	strcpy(procname, proc.c_str());
-
-	char* paramval = new char[param.length() + 1];
-	strcpy(paramval, param.c_str());
-
-	PyObject* pName, * pModule, * pDict, * pFunc, * pValue = nullptr, * presult = nullptr, * pListItem = nullptr;
-	// Initialize the Python Interpreter
-	Py_Initialize();
-	// Build the name object
-	pName = PyUnicode_FromString((char*)this->m_pyModuleName);
-	// Load the module object
-	pModule = PyImport_Import(pName);
-	// pDict is a borrowed reference 
-	pDict = PyModule_GetDict(pModule);
-	// pFunc is also a borrowed reference 
-	pFunc = PyDict_GetItemString(pDict, procname);
-	if (PyCallable_Check(pFunc)) {
-		pValue = Py_BuildValue("(z)", paramval);
-		PyErr_Print();
-		presult = PyObject_CallObject(pFunc, pValue);
-		PyErr_Print();
+	return Call<vector<string>>(proc, param);
+}
+
+/**
+ * Flush Python's sys.stdout. Python buffers its own output separately from cout, so when output
+ * is redirected to a file or pipe, text printed by Python functions can otherwise appear after
+ * text printed by C++ after the call. Flush cout before the call and this after it to keep them
+ * in order.
+ */
+void PyInterface::FlushOutput() {
+	// pStdout is a borrowed reference
+	PyObject* pStdout = PySys_GetObject("stdout");
+	if (pStdout == nullptr) {
+		return;
 	}
-	else {
+
+	PyObject* presult = PyObject_CallMethod(pStdout, "flush", nullptr);
+	if (presult == nullptr) {
 		PyErr_Print();
 	}
-	//printf("Result is %d\n", _PyLong_AsInt(presult));
-
-	Py_DECREF(pValue);
-	// Clean up
-	Py_DECREF(pModule);
-	Py_DECREF(pName);
-	// Finish the Python Interpreter
-	Py_Finalize();
-
-	// clean 
-	delete[] procname;
-	delete[] paramval;
-
-	vector<string> returnList;
-
-	if (presult != nullptr) {
-		if (PyList_Check(presult)) {
-			for (int i = 0; i < PyList_Size(presult); ++i) {
-				pListItem = PyList_GetItem(presult, i);
-				returnList.push_back(PyUnicode_AsUTF8(pListItem));
-			}
-			Py_DECREF(pListItem);
-			return returnList;
-		}
-		else {
+	Py_XDECREF(presult);
+}
+
+/**
+ * Send what Python functions print to sys.stdout to a new io.StringIO instead, until 
+ * ReleaseOutput(). Lets a caller print a call's output later as a whole, e.g. when the call runs
+ * in the background while the console is used for something else. Python errors are printed to
+ * sys.stderr and aren't captured.
+ * 
+ * @return true if output is being captured (including by an earlier call), false if sys.stdout
+ * couldn't be replaced, so output still goes to it.
+ */
+bool PyInterface::CaptureOutput() {
+	if (m_savedStdout != nullptr) {
+		return true;
+	}
+
+	// pStdout is a borrowed reference
+	PyObject* pStdout = PySys_GetObject("stdout");
+	PyObject* pIo = PyImport_ImportModule("io");
+	PyObject* pBuffer = (pIo == nullptr) ? nullptr : PyObject_CallMethod(pIo, "StringIO", nullptr);
+	Py_XDECREF(pIo);
+	if (pStdout == nullptr || pBuffer == nullptr) {
+		if (PyErr_Occurred()) {
 			PyErr_Print();
 		}
+		Py_XDECREF(pBuffer);
+		return false;
+	}
+
+	Py_INCREF(pStdout);
+	if (PySys_SetObject("stdout", pBuffer) != 0) {
+		PyErr_Print();
+		Py_DECREF(pStdout);
+		Py_DECREF(pBuffer);
+		return false;
+	}
+	// sys holds its own reference to the buffer now.
+	Py_DECREF(pBuffer);
+	m_savedStdout = pStdout;
+	return true;
+}
+
+/**
+ * Stop capturing output and put sys.stdout back as it was before CaptureOutput().
+ * 
+ * @return Everything Python printed since CaptureOutput(), or "" if output wasn't captured.
+ */
+string PyInterface::ReleaseOutput() {
+	if (m_savedStdout == nullptr) {
+		return "";
+	}
+
+	string output;
+	// pBuffer is a borrowed reference
+	PyObject* pBuffer = PySys_GetObject("stdout");
+	PyObject* pValue = (pBuffer == nullptr) ? nullptr
+		: PyObject_CallMethod(pBuffer, "getvalue", nullptr);
+	if ((pValue == nullptr || !PyConvert<string>::FromPython(pValue, output)) &&
+		PyErr_Occurred()) {
+		PyErr_Print();
+	}
+	Py_XDECREF(pValue);
+
+	if (PySys_SetObject("stdout", m_savedStdout) != 0) {
+		PyErr_Print();
+	}
+	Py_DECREF(m_savedStdout);
+	m_savedStdout = nullptr;
+	return output;
+}
+
+/**
+ * Share a PurchaseIndex's counts with Python code through the built-in "grocer" module (see
+ * GrocerPyModule.cpp). There is one interpreter, so the index is shared with every PyInterface.
+ * 
+ * @param purchaseIndex Index to share, or nullptr to stop sharing. Must stay alive while shared.
+ */
+void PyInterface::SetPurchaseIndex(const PurchaseIndex* purchaseIndex) {
+	GrocerPyModule::SetPurchaseIndex(purchaseIndex);
+}
+
+/**
+ * Turn result caching on or off for one Python function. See top of file for which functions
+ * may be cached. Results already cached for the function are left to age out.
+ * 
+ * @param proc Name of function in Python module.
+ * @param cacheResults true to cache the function's results, false to call it every time.
+ */
+void PyInterface::CacheResults(const string& proc, bool cacheResults) {
+	if (cacheResults) {
+		m_cachedFunctions.insert(proc);
+	}
+	else {
+		m_cachedFunctions.erase(proc);
+	}
+}
+
+/**
+ * Drop every cached result. Functions stay cached; the hit and miss counts are kept.
+ */
+void PyInterface::ClearResultCache() {
+	m_cacheIndex.clear();
+	m_cacheEntries.clear();
+}
+
+/**
+ * Look up a cached result and mark it most recently used. Counts a hit or a miss.
+ * 
+ * @param key Function name and arguments, built by AppendCacheKey().
+ * @param resultType Type the result was converted to. A result cached as another type misses.
+ * 
+ * @return The cached result, valid until the next StoreCachedResult() or ClearResultCache(), or
+ * nullptr if there is none.
+ */
+const any* PyInterface::FindCachedResult(const string& key, const type_info& resultType) {
+	auto found = m_cacheIndex.find(key);
+	if (found == m_cacheIndex.end() || found->second->result.type() != resultType) {
+		m_cacheMisses.fetch_add(1, memory_order_relaxed);
+		return nullptr;
 	}
 
-	return {};
+	m_cacheEntries.splice(m_cacheEntries.begin(), m_cacheEntries, found->second);
+	m_cacheHits.fetch_add(1, memory_order_relaxed);
+	return &found->second->result;
 }
 
+/**
+ * Cache a result as the most recently used, replacing any result with the same key, and evict
+ * the least recently used results over the capacity.
+ * 
+ * @param key Function name and arguments, built by AppendCacheKey().
+ * @param result Converted result.
+ */
+void PyInterface::StoreCachedResult(const string& key, any result) {
+	if (m_cacheCapacity == 0) {
+		return;
+	}
+
+	auto found = m_cacheIndex.find(key);
+	if (found != m_cacheIndex.end()) {
+		found->second->result = move(result);
+		m_cacheEntries.splice(m_cacheEntries.begin(), m_cacheEntries, found->second);
+		return;
+	}
+
+	m_cacheEntries.push_front({ key, move(result) });
+	m_cacheIndex.emplace(key, m_cacheEntries.begin());
+	while (m_cacheEntries.size() > m_cacheCapacity) {
+		m_cacheIndex.erase(m_cacheEntries.back().key);
+		m_cacheEntries.pop_back();
+	}
+}
+
+/**
+ * Append a string to a result cache key: its length and characters, and if it names an existing
+ * file, the file's identity, so the key changes when the file does.
+ * 
+ * @param key Key to append to.
+ * @param value String argument.
+ */
+void PyInterface::AppendCacheKey(string& key, string_view value) {
+	key += '\0';
+	key += 's';
+	key += to_string(value.size());
+	key += ':';
+	key += value;
+
+	FileIdentity identity;
+	if (!value.empty() && MappedFile::StatFile(string(value), identity)) {
+		key += 'F';
+		key.append(reinterpret_cast<const char*>(&identity), sizeof(identity));
+	}
+}
+
+/**
+ * Append a string to a result cache key. See AppendCacheKey(string&, string_view).
+ * 
+ * @param key Key to append to.
+ * @param value String argument.
+ */
+void PyInterface::AppendCacheKey(string& key, const string& value) {
+	AppendCacheKey(key, string_view(value));
+}
+
+/**
+ * Append a C string to a result cache key. See AppendCacheKey(string&, string_view).
+ * 
+ * @param key Key to append to.
+ * @param value String argument.
+ */
+void PyInterface::AppendCacheKey(string& key, const char* value) {
+	AppendCacheKey(key, string_view(value));
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Most results kept by the result cache.
+ */
+size_t PyInterface::GetResultCacheCapacity() const {
+	return m_cacheCapacity;
+}
+
+/**
+ * Set the most results kept by the result cache, evicting the least recently used results over
+ * the new capacity.
+ * 
+ * @param capacity Number of results. 0 keeps none.
+ */
+void PyInterface::SetResultCacheCapacity(size_t capacity) {
+	m_cacheCapacity = capacity;
+	while (m_cacheEntries.size() > m_cacheCapacity) {
+		m_cacheIndex.erase(m_cacheEntries.back().key);
+		m_cacheEntries.pop_back();
+	}
+}
+
+/**
+ * @return Number of calls to cached functions answered from the cache.
+ */
+unsigned long long PyInterface::GetCacheHits() const {
+	return m_cacheHits.load(memory_order_relaxed);
+}
+
+/**
+ * @return Number of calls to cached functions that had to call Python.
+ */
+unsigned long long PyInterface::GetCacheMisses() const {
+	return m_cacheMisses.load(memory_order_relaxed);
+}
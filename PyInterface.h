@@ -12,18 +12,41 @@
 #ifndef PYINTERFACE_H
 #define PYINTERFACE_H
 
+/* Python.h must see this first: "#" argument formats take Py_ssize_t lengths. */
+#define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <iostream>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
+#include <any>
+#include <atomic>
 #include <cmath>
+#include <list>
 #include <string>
+#include <string_view>
+#include <typeinfo>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "PyConvert.h"
+#include "PurchaseIndex.h"
+#include "LatencyStats.h"
 
 using namespace std;
 
 class PyInterface {
 public:
+	/* Most results kept by the result cache, unless set otherwise. */
+	static const size_t DEFAULT_RESULT_CACHE_CAPACITY = 64;
+
 	PyInterface(const char* pyModuleName = "PythonCode");
+	~PyInterface();
+	PyInterface(const PyInterface&) = delete;
+	PyInterface& operator=(const PyInterface&) = delete;
+
+	template <typename R = void, typename... Args>
+	R Call(const string& proc, const Args&... args);
 
 	void CallProcedure(string pName);
 	int CallIntFunc(string proc, string param);
@@ -31,9 +54,177 @@ public:
 	int CallIntFunc(string proc, const int& param);
 	double CallDoubleFunc(string proc, double param);
 	vector<string> CallListFunc(string proc, string param);
+	void FlushOutput();
+	bool CaptureOutput();
+	string ReleaseOutput();
+	void SetPurchaseIndex(const PurchaseIndex* purchaseIndex);
+
+	void CacheResults(const string& proc, bool cacheResults = true);
+	void ClearResultCache();
+	size_t GetResultCacheCapacity() const;
+	void SetResultCacheCapacity(size_t capacity);
+	unsigned long long GetCacheHits() const;
+	unsigned long long GetCacheMisses() const;
 
 private:
+	/* A cached result, keyed by function name and arguments (see AppendCacheKey()). */
+	struct CacheEntry {
+		string key;
+		any result;
+	};
+	// Worker processes pass decoded arguments straight to CallVector().
+	friend class PyWorkerPool;
+
+	PyObject* GetFunction(const string& proc);
+	PyObject* CallVector(const string& proc, PyObject* const* pArgs, size_t argCount);
+
+	const any* FindCachedResult(const string& key, const type_info& resultType);
+	void StoreCachedResult(const string& key, any result);
+	static void AppendCacheKey(string& key, string_view value);
+	static void AppendCacheKey(string& key, const string& value);
+	static void AppendCacheKey(string& key, const char* value);
+	template <typename T>
+	static typename enable_if<is_arithmetic<T>::value>::type AppendCacheKey(string& key,
+																			 const T& value);
+	template <typename T>
+	static void AppendCacheKey(string& key, const vector<T>& values);
+	template <typename V>
+	static void AppendCacheKey(string& key, const map<string, V>& values);
+
 	const char* m_pyModuleName;
+	PyObject* m_pyModule;
+	unordered_map<string, PyObject*> m_functionCache;
+	/* sys.stdout while CaptureOutput() has replaced it, else nullptr. */
+	PyObject* m_savedStdout;
+
+	/* Result cache: most recently used first, with an index by key. */
+	unordered_set<string> m_cachedFunctions;
+	list<CacheEntry> m_cacheEntries;
+	unordered_map<string, list<CacheEntry>::iterator> m_cacheIndex;
+	size_t m_cacheCapacity;
+	atomic<unsigned long long> m_cacheHits;
+	atomic<unsigned long long> m_cacheMisses;
+
+	static int s_sessionCount;
 };
 
-#endif
\ No newline at end of file
+/**
+ * Call a Python function named "proc" with any number of arguments, converting each argument 
+ * and the return value by type at compile time (see PyConvert.h). Arguments are passed with the
+ * vectorcall protocol, so no argument tuple is built, and strings are handed to Python straight
+ * from their characters. E.g.:
+ *   int count = Call<int>("CountOneItem", fileName, string_view("Peas"));
+ *   vector<string> items = Call<vector<string>>("GetItems", fileName);
+ *   map<string, int> counts = Call<map<string, int>>("CountAllItems", fileName);
+ *   Call("CountItems", fileName);	// return value ignored
+ * 
+ * If results of "proc" are cached (see CacheResults()), a call with the same arguments as an
+ * earlier one, and the same versions of any files they name, returns the earlier result without
+ * calling Python.
+ * 
+ * Defined in this header because it is a template.
+ * 
+ * @param proc Name of function in Python module.
+ * @param args Arguments for the function: any types with a PyConvert specialization.
+ * 
+ * @return The function's result converted to R, or PyConvert<R>::ErrorValue() (-1 for int, as 
+ * the CallIntFunc overloads) if the call failed or returned the wrong type. The Python error is
+ * printed.
+ */
+template <typename R, typename... Args>
+R PyInterface::Call(const string& proc, const Args&... args) {
+	string cacheKey;
+	if constexpr (!is_void<R>::value) {
+		if (!m_cachedFunctions.empty() && m_cachedFunctions.count(proc) != 0) {
+			cacheKey = proc;
+			(AppendCacheKey(cacheKey, args), ...);
+			const any* cached = FindCachedResult(cacheKey, typeid(R));
+			if (cached != nullptr) {
+				return any_cast<const R&>(*cached);
+			}
+		}
+	}
+
+	// Slot 0 is left free so Python may borrow it when forwarding the call (see 
+	// PY_VECTORCALL_ARGUMENTS_OFFSET). decay<const Args> turns string literals into const char*.
+	ScopedTimer timer(LatencyStats::Metric::PyArguments);
+	PyObject* pArgs[sizeof...(Args) + 1] = { 
+		nullptr, PyConvert<typename decay<const Args>::type>::ToPython(args)... };
+	timer.Next(LatencyStats::Metric::PyCall);
+	PyObject* presult = CallVector(proc, pArgs + 1, sizeof...(Args));
+	timer.Next(LatencyStats::Metric::PyResult);
+	for (size_t i = 1; i <= sizeof...(Args); ++i) {
+		Py_XDECREF(pArgs[i]);
+	}
+
+	if constexpr (is_void<R>::value) {
+		Py_XDECREF(presult);
+	}
+	else {
+		if (presult == nullptr) {
+			return PyConvert<R>::ErrorValue();
+		}
+		R result;
+		if (!PyConvert<R>::FromPython(presult, result)) {
+			PyErr_Print();
+			cout << proc << " returned an unexpected type." << endl;
+			result = PyConvert<R>::ErrorValue();
+		}
+		// Failed calls aren't cached, so they are retried.
+		else if (!cacheKey.empty()) {
+			StoreCachedResult(cacheKey, result);
+		}
+		Py_DECREF(presult);
+		return result;
+	}
+}
+
+/**
+ * Append a number to a result cache key. Numbers of different types make different keys.
+ * 
+ * @param key Key to append to.
+ * @param value Integer, floating-point, or bool argument.
+ */
+template <typename T>
+typename enable_if<is_arithmetic<T>::value>::type PyInterface::AppendCacheKey(string& key,
+																			   const T& value) {
+	key += '\0';
+	key += is_floating_point<T>::value ? 'f' : (is_signed<T>::value ? 'i' : 'u');
+	key += static_cast<char>(sizeof(T));
+	key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Append a list to a result cache key: its length, then each element.
+ * 
+ * @param key Key to append to.
+ * @param values List argument.
+ */
+template <typename T>
+void PyInterface::AppendCacheKey(string& key, const vector<T>& values) {
+	key += '\0';
+	key += 'v';
+	key += to_string(values.size());
+	for (const T& value : values) {
+		AppendCacheKey(key, value);
+	}
+}
+
+/**
+ * Append a dict to a result cache key: its size, then each key and value in key order.
+ * 
+ * @param key Key to append to.
+ * @param values Dict argument.
+ */
+template <typename V>
+void PyInterface::AppendCacheKey(string& key, const map<string, V>& values) {
+	key += '\0';
+	key += 'm';
+	key += to_string(values.size());
+	for (const auto& value : values) {
+		AppendCacheKey(key, value.first);
+		AppendCacheKey(key, value.second);
+	}
+}
+
+#endif
@@ -0,0 +1,394 @@
+/**
+ * PyWire.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Byte format for passing Python function arguments and results between processes, used by
+ * PyWorkerPool (see PyWorkerPool.cpp) to talk to its worker processes. The host side converts C++
+ * values with PyWire<T>, as PyInterface::Call<R>() converts them with PyConvert<T>; the worker side
+ * converts the same bytes to and from Python objects. Header only, because the conversions are
+ * templates chosen at compile time from the argument and return types.
+ *
+ * Every value starts with a one-byte tag, and all numbers are little-endian:
+ *   'n'  None
+ *   'b'  bool: one byte, 0 or 1
+ *   'i'  int: int64
+ *   'd'  float: IEEE 754 double
+ *   's'  str: uint32 length, then the UTF-8 characters
+ *   'l'  list or tuple: uint32 count, then each item
+ *   'm'  dict: uint32 count, then each key (a str) and its value
+ * Messages between processes are framed by a uint32 length (see PyWorkerPool).
+ *
+ * PyWire<T> is specialized for the same types as PyConvert<T>: integral types and bool, float and
+ * double, string (and string_view and C strings as arguments), vector<T>, and map<string, V>.
+ * Each specialization has:
+ * - static bool Write(string& buffer, const T& value): appends the value; false if it can't be
+ *   represented (e.g. an unsigned value above the int64 range).
+ * - static bool Read(string_view& buffer, T& value): reads one value from the front of buffer and
+ *   advances it; false if the next value isn't of a matching type or the buffer is short.
+ * - static T ErrorValue(): as PyConvert<T>::ErrorValue().
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#pragma once
+
+#ifndef PYWIRE_H
+#define PYWIRE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/* Tags and primitive encodings shared by PyWire<T> and the worker side of PyWorkerPool. */
+class PyWireFormat {
+public:
+	static const char TAG_NONE = 'n';
+	static const char TAG_BOOL = 'b';
+	static const char TAG_INT = 'i';
+	static const char TAG_FLOAT = 'd';
+	static const char TAG_STR = 's';
+	static const char TAG_LIST = 'l';
+	static const char TAG_DICT = 'm';
+
+	/* Append an integer, little-endian. */
+	template <typename T>
+	static void AppendValue(string& buffer, T value) {
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			buffer += static_cast<char>((static_cast<unsigned long long>(value) >> (8 * i)) & 0xFF);
+		}
+	}
+
+	/* Read a little-endian integer from the front of buffer. */
+	template <typename T>
+	static bool ReadValue(string_view& buffer, T& value) {
+		if (buffer.size() < sizeof(T)) {
+			return false;
+		}
+		unsigned long long result = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			result |= static_cast<unsigned long long>(static_cast<unsigned char>(buffer[i])) << (8 * i);
+		}
+		value = static_cast<T>(result);
+		buffer.remove_prefix(sizeof(T));
+		return true;
+	}
+
+	/* Append a tag followed by a uint32 count or length. */
+	static bool AppendSize(string& buffer, char tag, size_t size) {
+		if (size > numeric_limits<uint32_t>::max()) {
+			return false;
+		}
+		buffer += tag;
+		AppendValue(buffer, static_cast<uint32_t>(size));
+		return true;
+	}
+
+	/* Consume the next tag if it is the expected one. */
+	static bool ReadTag(string_view& buffer, char tag) {
+		if (buffer.empty() || buffer.front() != tag) {
+			return false;
+		}
+		buffer.remove_prefix(1);
+		return true;
+	}
+
+	/* Read a tag and the uint32 count or length after it. */
+	static bool ReadSize(string_view& buffer, char tag, uint32_t& size) {
+		string_view remaining = buffer;
+		if (!ReadTag(remaining, tag) || !ReadValue(remaining, size)) {
+			return false;
+		}
+		buffer = remaining;
+		return true;
+	}
+
+	static bool AppendStr(string& buffer, string_view value) {
+		if (!AppendSize(buffer, TAG_STR, value.size())) {
+			return false;
+		}
+		buffer += value;
+		return true;
+	}
+
+	/* Read a str. The view points into buffer's characters. */
+	static bool ReadStr(string_view& buffer, string_view& value) {
+		string_view remaining = buffer;
+		uint32_t length;
+		if (!ReadSize(remaining, TAG_STR, length) || remaining.size() < length) {
+			return false;
+		}
+		value = remaining.substr(0, length);
+		remaining.remove_prefix(length);
+		buffer = remaining;
+		return true;
+	}
+
+	static void AppendDouble(string& buffer, double value) {
+		static_assert(sizeof(double) == sizeof(uint64_t), "doubles are sent as 64 bits");
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		buffer += TAG_FLOAT;
+		AppendValue(buffer, bits);
+	}
+
+	/* Read a float, or an int or bool as a float. */
+	static bool ReadDouble(string_view& buffer, double& value) {
+		string_view remaining = buffer;
+		long long intValue;
+		if (ReadInt(remaining, intValue)) {
+			value = static_cast<double>(intValue);
+		}
+		else {
+			uint64_t bits;
+			if (!ReadTag(remaining, TAG_FLOAT) || !ReadValue(remaining, bits)) {
+				return false;
+			}
+			memcpy(&value, &bits, sizeof(value));
+		}
+		buffer = remaining;
+		return true;
+	}
+
+	/* Read an int, or a bool as an int. */
+	static bool ReadInt(string_view& buffer, long long& value) {
+		string_view remaining = buffer;
+		if (ReadTag(remaining, TAG_BOOL)) {
+			unsigned char boolValue;
+			if (!ReadValue(remaining, boolValue)) {
+				return false;
+			}
+			value = boolValue != 0;
+		}
+		else if (!ReadTag(remaining, TAG_INT) || !ReadValue(remaining, value)) {
+			return false;
+		}
+		buffer = remaining;
+		return true;
+	}
+};
+
+template <typename T, typename Enable = void>
+struct PyWire;
+
+/* Integral types except bool, sent as int64. */
+template <typename T>
+struct PyWire<T, typename enable_if<is_integral<T>::value && !is_same<T, bool>::value>::type> {
+	static bool Write(string& buffer, const T& value) {
+		if (!is_signed<T>::value &&
+			static_cast<unsigned long long>(value) >
+			static_cast<unsigned long long>(numeric_limits<long long>::max())) {
+			return false;
+		}
+		buffer += PyWireFormat::TAG_INT;
+		PyWireFormat::AppendValue(buffer, static_cast<long long>(value));
+		return true;
+	}
+
+	static bool Read(string_view& buffer, T& value) {
+		string_view remaining = buffer;
+		long long result;
+		if (!PyWireFormat::ReadInt(remaining, result)) {
+			return false;
+		}
+		if (is_signed<T>::value ?
+			(result < static_cast<long long>(numeric_limits<T>::min()) ||
+			 result > static_cast<long long>(numeric_limits<T>::max())) :
+			(result < 0 ||
+			 static_cast<unsigned long long>(result) >
+			 static_cast<unsigned long long>(numeric_limits<T>::max()))) {
+			return false;
+		}
+		value = static_cast<T>(result);
+		buffer = remaining;
+		return true;
+	}
+
+	/* As PyConvert<T>::ErrorValue(). */
+	static T ErrorValue() {
+		return static_cast<T>(-1);
+	}
+};
+
+template <>
+struct PyWire<bool> {
+	static bool Write(string& buffer, const bool& value) {
+		buffer += PyWireFormat::TAG_BOOL;
+		buffer += static_cast<char>(value ? 1 : 0);
+		return true;
+	}
+
+	static bool Read(string_view& buffer, bool& value) {
+		long long result;
+		if (!PyWireFormat::ReadInt(buffer, result)) {
+			return false;
+		}
+		value = result != 0;
+		return true;
+	}
+
+	static bool ErrorValue() {
+		return false;
+	}
+};
+
+/* float and double. */
+template <typename T>
+struct PyWire<T, typename enable_if<is_floating_point<T>::value>::type> {
+	static bool Write(string& buffer, const T& value) {
+		PyWireFormat::AppendDouble(buffer, static_cast<double>(value));
+		return true;
+	}
+
+	static bool Read(string_view& buffer, T& value) {
+		double result;
+		if (!PyWireFormat::ReadDouble(buffer, result)) {
+			return false;
+		}
+		value = static_cast<T>(result);
+		return true;
+	}
+
+	static T ErrorValue() {
+		return static_cast<T>(-1.0);
+	}
+};
+
+template <>
+struct PyWire<string_view> {
+	static bool Write(string& buffer, const string_view& value) {
+		return PyWireFormat::AppendStr(buffer, value);
+	}
+
+	// No Read: a string_view can't own the characters of a reply.
+};
+
+template <>
+struct PyWire<string> {
+	static bool Write(string& buffer, const string& value) {
+		return PyWireFormat::AppendStr(buffer, value);
+	}
+
+	static bool Read(string_view& buffer, string& value) {
+		string_view result;
+		if (!PyWireFormat::ReadStr(buffer, result)) {
+			return false;
+		}
+		value.assign(result.data(), result.size());
+		return true;
+	}
+
+	static string ErrorValue() {
+		return string();
+	}
+};
+
+template <>
+struct PyWire<const char*> {
+	static bool Write(string& buffer, const char* const& value) {
+		if (value == nullptr) {
+			buffer += PyWireFormat::TAG_NONE;
+			return true;
+		}
+		return PyWireFormat::AppendStr(buffer, value);
+	}
+};
+
+template <>
+struct PyWire<char*> {
+	static bool Write(string& buffer, char* const& value) {
+		return PyWire<const char*>::Write(buffer, value);
+	}
+};
+
+/* Sent as a list; read from a list or tuple. */
+template <typename T>
+struct PyWire<vector<T>> {
+	static bool Write(string& buffer, const vector<T>& values) {
+		if (!PyWireFormat::AppendSize(buffer, PyWireFormat::TAG_LIST, values.size())) {
+			return false;
+		}
+		for (const T& value : values) {
+			if (!PyWire<T>::Write(buffer, value)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool Read(string_view& buffer, vector<T>& values) {
+		string_view remaining = buffer;
+		uint32_t size;
+		if (!PyWireFormat::ReadSize(remaining, PyWireFormat::TAG_LIST, size)) {
+			return false;
+		}
+
+		values.clear();
+		// Each item takes at least one byte, which bounds the reservation for a corrupt size.
+		values.reserve(min<size_t>(size, remaining.size()));
+		for (uint32_t i = 0; i < size; ++i) {
+			T value;
+			if (!PyWire<T>::Read(remaining, value)) {
+				return false;
+			}
+			values.push_back(move(value));
+		}
+		buffer = remaining;
+		return true;
+	}
+
+	static vector<T> ErrorValue() {
+		return vector<T>();
+	}
+};
+
+template <typename V>
+struct PyWire<map<string, V>> {
+	static bool Write(string& buffer, const map<string, V>& values) {
+		if (!PyWireFormat::AppendSize(buffer, PyWireFormat::TAG_DICT, values.size())) {
+			return false;
+		}
+		for (const auto& entry : values) {
+			if (!PyWireFormat::AppendStr(buffer, entry.first) ||
+				!PyWire<V>::Write(buffer, entry.second)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool Read(string_view& buffer, map<string, V>& values) {
+		string_view remaining = buffer;
+		uint32_t size;
+		if (!PyWireFormat::ReadSize(remaining, PyWireFormat::TAG_DICT, size)) {
+			return false;
+		}
+
+		values.clear();
+		for (uint32_t i = 0; i < size; ++i) {
+			string key;
+			V value;
+			if (!PyWire<string>::Read(remaining, key) || !PyWire<V>::Read(remaining, value)) {
+				return false;
+			}
+			values.emplace(move(key), move(value));
+		}
+		buffer = remaining;
+		return true;
+	}
+
+	static map<string, V> ErrorValue() {
+		return map<string, V>();
+	}
+};
+
+#endif
@@ -0,0 +1,721 @@
+/**
+ * PyWorkerPool.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Runs Python functions in a pool of worker processes, each with its own interpreter, so
+ * independent calls (e.g. counting many store files) use more than one core. One embedded
+ * interpreter can only run one Python thread at a time, whatever PyExecutor or PyInterface does.
+ *
+ * Use:
+ * - PyWorkerPool pool(4); starts four worker processes, each of which imports the module
+ * ("PythonCode" by default) right away, so calls don't wait for it.
+ * - Submit<R>(name, args...) queues a call and returns a future PyWorkerReply<R>: the result,
+ * everything the function printed, and whether it succeeded. Output is captured rather than
+ * printed, so the caller can print each call's output in order however the calls interleave.
+ * - Arguments and results are converted as for PyInterface::Call<R>(), through PyWire<T> (see
+ * PyWire.h) instead of PyConvert<T>: integers, bool, floats, strings, vector<T>, and map<string, V>.
+ * - Calls run in parallel, one per worker, and start in the order they were submitted. A worker
+ * keeps its module's state between calls, but which worker runs a call isn't defined.
+ * - Shutdown() (or the destructor) finishes the queued calls and stops the workers.
+ *
+ * Worker processes:
+ * - A worker is this program started again with WORKER_OPTION, the module name, and the two
+ * channels to read requests from and write replies to. main() hands those arguments to
+ * RunWorker(), which serves calls with a PyInterface until the pool closes the channel.
+ * - On Linux, a worker is started with posix_spawn from /proc/self/exe and talks to the host
+ * over a Unix socket pair on file descriptor 3. On Windows, it is started with CreateProcess from
+ * the program's own path and talks over two anonymous pipes, whose handle values are passed on
+ * its command line.
+ * - Each message is a uint32 length (little-endian) followed by the message. A request is the
+ * function's name (a str) then a list of its arguments; a reply is REPLY_RESULT, the captured
+ * output (a str), and the result, or REPLY_FAILED and the captured output. Python errors are
+ * printed by the worker to stderr, which it shares with the host.
+ * - If a worker crashes or its channel breaks, the call it was running fails (succeeded is false),
+ * an error is printed, and the worker is killed and started again for the next call. The host
+ * process is unaffected. GetRestartCount() counts these restarts.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "PyWorkerPool.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+using namespace std;
+
+/* Command-line option that starts this program as a worker; followed by the module name. */
+const char* PyWorkerPool::WORKER_OPTION = "--py-worker=";
+/* Held while starting a worker, so no other worker inherits its channel. */
+mutex PyWorkerPool::s_spawnMutex;
+
+/* Largest message accepted from a channel. Guards against allocating for a corrupt length. */
+static const uint32_t MAX_MESSAGE_SIZE = 1u << 30;
+#ifndef _WIN32
+/* File descriptor of a worker's end of its channel. */
+static const int WORKER_CHANNEL = 3;
+#endif
+
+/**
+ * Constructor. Starts the worker processes, each on its own host thread.
+ *
+ * @param workerCount Number of worker processes. 0 uses one per hardware thread.
+ * @param pyModuleName String of Python filename _without .py extension_ to load in each worker.
+ * Must stay valid for the life of the pool (e.g. a string literal).
+ */
+PyWorkerPool::PyWorkerPool(unsigned int workerCount, const char* pyModuleName) {
+	m_pyModuleName = pyModuleName;
+	m_workerCount = (workerCount == 0) ? max(thread::hardware_concurrency(), 1u) : workerCount;
+	m_stopping = false;
+	m_restartCount = 0;
+
+	for (unsigned int i = 0; i < m_workerCount; ++i) {
+		m_workerThreads.emplace_back(&PyWorkerPool::ServeWorker, this);
+	}
+}
+
+/**
+ * Destructor. Finishes the queued calls and stops the workers. See Shutdown().
+ */
+PyWorkerPool::~PyWorkerPool() {
+	Shutdown();
+}
+
+/**
+ * @return Number of worker processes.
+ */
+unsigned int PyWorkerPool::GetWorkerCount() const {
+	return m_workerCount;
+}
+
+/**
+ * @return Number of times a worker has been restarted after crashing or breaking its channel.
+ */
+unsigned long long PyWorkerPool::GetRestartCount() const {
+	return m_restartCount;
+}
+
+/**
+ * Stop accepting calls, wait for the queued calls to finish, and stop the workers. Later calls
+ * to Submit() return futures holding a runtime_error. Safe to call more than once.
+ */
+void PyWorkerPool::Shutdown() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_queueChanged.notify_all();
+
+	for (thread& workerThread : m_workerThreads) {
+		if (workerThread.joinable()) {
+			workerThread.join();
+		}
+	}
+}
+
+/**
+ * Add a call to the end of the queue.
+ *
+ * @param task Encoded request and completion.
+ *
+ * @return false if the pool has been shut down and the call wasn't queued.
+ */
+bool PyWorkerPool::Enqueue(Task task) {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_stopping) {
+			return false;
+		}
+		m_queue.push_back(move(task));
+	}
+	m_queueChanged.notify_one();
+	return true;
+}
+
+/**
+ * Body of each host thread. Starts one worker process, then sends it queued calls one at a time
+ * until shut down and the queue is empty. Restarts the worker if it stops.
+ */
+void PyWorkerPool::ServeWorker() {
+	Worker worker;
+	worker.running = false;
+	StartWorker(worker);
+
+	while (true) {
+		Task task;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_queueChanged.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+			if (m_queue.empty()) {
+				break;
+			}
+			task = move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		string reply;
+		if (!worker.running && !StartWorker(worker)) {
+			reply.clear();
+		}
+		else if (!Exchange(worker, task.request, reply)) {
+			cerr << "A Python worker stopped during a call. Restarting it." << endl;
+			StopWorker(worker, true);
+			++m_restartCount;
+			StartWorker(worker);
+			reply.clear();
+		}
+		task.complete(reply);
+	}
+
+	StopWorker(worker, false);
+}
+
+/**
+ * Send a request to a worker and wait for its reply.
+ *
+ * @param worker Running worker.
+ * @param request Encoded request.
+ * @param reply Receives the encoded reply.
+ *
+ * @return false if the channel broke: the worker crashed or exited.
+ */
+bool PyWorkerPool::Exchange(Worker& worker, const string& request, string& reply) {
+	return WriteFrame(worker.requestChannel, request) && ReadFrame(worker.replyChannel, reply);
+}
+
+/**
+ * Start a worker process and open the channel to it.
+ *
+ * @param worker Worker to start. Must not be running.
+ *
+ * @return true if the worker was started. Prints an error otherwise.
+ */
+bool PyWorkerPool::StartWorker(Worker& worker) {
+	lock_guard<mutex> lock(s_spawnMutex);
+	string moduleOption = string(WORKER_OPTION) + m_pyModuleName;
+
+#ifdef _WIN32
+	// The worker's ends are inheritable; the host's ends aren't.
+	SECURITY_ATTRIBUTES inheritable = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE requestRead, requestWrite, replyRead, replyWrite;
+	if (!CreatePipe(&requestRead, &requestWrite, &inheritable, 0)) {
+		cerr << "Couldn't start a Python worker." << endl;
+		return false;
+	}
+	if (!CreatePipe(&replyRead, &replyWrite, &inheritable, 0)) {
+		CloseHandle(requestRead);
+		CloseHandle(requestWrite);
+		cerr << "Couldn't start a Python worker." << endl;
+		return false;
+	}
+	SetHandleInformation(requestWrite, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(replyRead, HANDLE_FLAG_INHERIT, 0);
+
+	char programPath[MAX_PATH];
+	DWORD pathLength = GetModuleFileNameA(nullptr, programPath, MAX_PATH);
+	string commandLine = "\"" + string(programPath, pathLength) + "\" " + moduleOption + " " +
+		to_string(reinterpret_cast<uintptr_t>(requestRead)) + "," +
+		to_string(reinterpret_cast<uintptr_t>(replyWrite));
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo;
+	BOOL started = pathLength > 0 && pathLength < MAX_PATH &&
+		CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr,
+					   &startupInfo, &processInfo);
+	CloseHandle(requestRead);
+	CloseHandle(replyWrite);
+	if (!started) {
+		CloseHandle(requestWrite);
+		CloseHandle(replyRead);
+		cerr << "Couldn't start a Python worker." << endl;
+		return false;
+	}
+	CloseHandle(processInfo.hThread);
+
+	worker.processHandle = processInfo.hProcess;
+	worker.requestChannel = reinterpret_cast<intptr_t>(requestWrite);
+	worker.replyChannel = reinterpret_cast<intptr_t>(replyRead);
+#else
+	int channels[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, channels) != 0) {
+		cerr << "Couldn't start a Python worker." << endl;
+		return false;
+	}
+	fcntl(channels[0], F_SETFD, FD_CLOEXEC);
+	fcntl(channels[1], F_SETFD, FD_CLOEXEC);
+	// dup2 onto the same descriptor wouldn't clear FD_CLOEXEC, so keep the worker's end off it.
+	if (channels[1] == WORKER_CHANNEL) {
+		channels[1] = fcntl(WORKER_CHANNEL, F_DUPFD_CLOEXEC, WORKER_CHANNEL + 1);
+		close(WORKER_CHANNEL);
+	}
+
+	string channelOption = to_string(WORKER_CHANNEL) + "," + to_string(WORKER_CHANNEL);
+	char* workerArgs[] = { const_cast<char*>("/proc/self/exe"), &moduleOption[0],
+						   &channelOption[0], nullptr };
+	posix_spawn_file_actions_t fileActions;
+	posix_spawn_file_actions_init(&fileActions);
+	posix_spawn_file_actions_adddup2(&fileActions, channels[1], WORKER_CHANNEL);
+	pid_t processId;
+	int spawnResult = (channels[1] < 0) ? EBADF
+		: posix_spawn(&processId, workerArgs[0], &fileActions, nullptr, workerArgs, environ);
+	posix_spawn_file_actions_destroy(&fileActions);
+	if (channels[1] >= 0) {
+		close(channels[1]);
+	}
+	if (spawnResult != 0) {
+		close(channels[0]);
+		cerr << "Couldn't start a Python worker." << endl;
+		return false;
+	}
+
+	worker.processId = processId;
+	worker.requestChannel = channels[0];
+	worker.replyChannel = channels[0];
+#endif
+
+	worker.running = true;
+	return true;
+}
+
+/**
+ * Close the channel to a worker and wait for it to exit. A worker exits by itself when its
+ * channel is closed.
+ *
+ * @param worker Worker to stop. Nothing is done if it isn't running.
+ * @param kill true to kill the worker rather than let it finish, e.g. after its channel broke.
+ */
+void PyWorkerPool::StopWorker(Worker& worker, bool kill) {
+	if (!worker.running) {
+		return;
+	}
+	worker.running = false;
+
+#ifdef _WIN32
+	CloseHandle(reinterpret_cast<HANDLE>(worker.requestChannel));
+	CloseHandle(reinterpret_cast<HANDLE>(worker.replyChannel));
+	if (kill) {
+		TerminateProcess(worker.processHandle, 1);
+	}
+	WaitForSingleObject(worker.processHandle, INFINITE);
+	CloseHandle(worker.processHandle);
+#else
+	close(static_cast<int>(worker.requestChannel));
+	if (kill) {
+		::kill(worker.processId, SIGKILL);
+	}
+	while (waitpid(worker.processId, nullptr, 0) < 0 && errno == EINTR) {
+	}
+#endif
+}
+
+/* -------------------- Worker process -------------------- */
+
+/**
+ * Serve calls from a PyWorkerPool until it closes the channel. Called by main() when this
+ * program is started with WORKER_OPTION; not for other use.
+ *
+ * @param pyModuleName Name of the Python module to import.
+ * @param channels "REQUEST,REPLY": the file descriptors (POSIX) or handle values (Windows) to
+ * read requests from and write replies to.
+ *
+ * @return Exit code for the worker process: 0 when the channel is closed, 1 if the module
+ * couldn't be imported, 2 if channels is malformed.
+ */
+int PyWorkerPool::RunWorker(const string& pyModuleName, const string& channels) {
+	intptr_t requestChannel;
+	intptr_t replyChannel;
+	try {
+		size_t separator = channels.find(',');
+		if (separator == string::npos) {
+			return 2;
+		}
+		requestChannel = static_cast<intptr_t>(stoll(channels.substr(0, separator)));
+		replyChannel = static_cast<intptr_t>(stoll(channels.substr(separator + 1)));
+	}
+	// stoll throws invalid_argument or out_of_range for a bad number.
+	catch (logic_error& excpt) {
+		return 2;
+	}
+
+	PyInterface pyInterface(pyModuleName.c_str());
+	if (pyInterface.m_pyModule == nullptr) {
+		return 1;
+	}
+	// Each call's output is captured in a new io.StringIO.
+	PyObject* pIoModule = PyImport_ImportModule("io");
+	PyObject* pStringIO = (pIoModule == nullptr) ? nullptr
+		: PyObject_GetAttrString(pIoModule, "StringIO");
+	Py_XDECREF(pIoModule);
+	if (pStringIO == nullptr) {
+		PyErr_Print();
+		return 1;
+	}
+
+	string request;
+	string reply;
+	while (ReadFrame(requestChannel, request)) {
+		reply.clear();
+		ServeRequest(pyInterface, pStringIO, request, reply);
+		if (!WriteFrame(replyChannel, reply)) {
+			break;
+		}
+	}
+
+	Py_DECREF(pStringIO);
+	return 0;
+}
+
+/**
+ * Run one request in a worker: decode the function name and arguments, call the function with
+ * sys.stdout redirected to a new StringIO, and encode the reply.
+ *
+ * @param pyInterface Worker's interface to the module.
+ * @param pStringIO The io.StringIO class.
+ * @param request Encoded request.
+ * @param reply Receives the encoded reply.
+ */
+void PyWorkerPool::ServeRequest(PyInterface& pyInterface, PyObject* pStringIO,
+								const string& request, string& reply) {
+	string_view remaining(request);
+	string_view proc;
+	uint32_t argCount = 0;
+	bool decoded = PyWireFormat::ReadStr(remaining, proc) &&
+		PyWireFormat::ReadSize(remaining, PyWireFormat::TAG_LIST, argCount) &&
+		argCount <= remaining.size();
+
+	// Slot 0 is left free for PY_VECTORCALL_ARGUMENTS_OFFSET, as in PyInterface::Call<R>().
+	vector<PyObject*> pArgs(decoded ? argCount + 1 : 1, nullptr);
+	for (uint32_t i = 1; decoded && i <= argCount; ++i) {
+		pArgs[i] = DecodeObject(remaining);
+		decoded = pArgs[i] != nullptr;
+	}
+
+	PyObject* presult = nullptr;
+	PyObject* pOutput = PyObject_CallObject(pStringIO, nullptr);
+	PyObject* pStdout = PySys_GetObject("stdout");
+	Py_XINCREF(pStdout);
+	if (!decoded) {
+		PyErr_Print();
+		cerr << "A Python worker received a malformed request." << endl;
+	}
+	else if (pOutput == nullptr || PySys_SetObject("stdout", pOutput) != 0) {
+		PyErr_Print();
+	}
+	else {
+		presult = pyInterface.CallVector(string(proc), pArgs.data() + 1, argCount);
+		PySys_SetObject("stdout", pStdout);
+	}
+	Py_XDECREF(pStdout);
+	for (PyObject* pArg : pArgs) {
+		Py_XDECREF(pArg);
+	}
+
+	string output;
+	PyObject* pText = (pOutput == nullptr) ? nullptr
+		: PyObject_CallMethod(pOutput, "getvalue", nullptr);
+	Py_ssize_t textLength;
+	const char* text = (pText == nullptr) ? nullptr : PyUnicode_AsUTF8AndSize(pText, &textLength);
+	if (text != nullptr) {
+		output.assign(text, static_cast<size_t>(textLength));
+	}
+	else if (PyErr_Occurred()) {
+		PyErr_Print();
+	}
+	Py_XDECREF(pText);
+	Py_XDECREF(pOutput);
+
+	string value;
+	if (presult != nullptr && !EncodeObject(presult, value)) {
+		PyErr_Print();
+		cerr << proc << " returned a value that can't be sent to the host." << endl;
+		Py_CLEAR(presult);
+	}
+	bool succeeded = presult != nullptr;
+	Py_XDECREF(presult);
+
+	reply += succeeded ? REPLY_RESULT : REPLY_FAILED;
+	if (!PyWireFormat::AppendStr(reply, output)) {
+		reply.resize(1);
+		PyWireFormat::AppendStr(reply, "");
+	}
+	if (succeeded) {
+		reply += value;
+	}
+}
+
+/**
+ * Encode a Python object in the PyWire format.
+ *
+ * @param pValue Object to encode: None, bool, int, float, str, list, tuple, or dict with str keys,
+ * nested to any depth.
+ * @param buffer Receives the encoded object.
+ *
+ * @return true, or false with a Python error set if the object (or anything in it) can't be sent.
+ */
+bool PyWorkerPool::EncodeObject(PyObject* pValue, string& buffer) {
+	if (pValue == Py_None) {
+		buffer += PyWireFormat::TAG_NONE;
+		return true;
+	}
+	// bool is a subclass of int, so it's checked first.
+	if (PyBool_Check(pValue)) {
+		buffer += PyWireFormat::TAG_BOOL;
+		buffer += static_cast<char>(pValue == Py_True ? 1 : 0);
+		return true;
+	}
+	if (PyLong_Check(pValue)) {
+		long long value = PyLong_AsLongLong(pValue);
+		if (value == -1 && PyErr_Occurred()) {
+			return false;
+		}
+		buffer += PyWireFormat::TAG_INT;
+		PyWireFormat::AppendValue(buffer, value);
+		return true;
+	}
+	if (PyFloat_Check(pValue)) {
+		PyWireFormat::AppendDouble(buffer, PyFloat_AS_DOUBLE(pValue));
+		return true;
+	}
+	if (PyUnicode_Check(pValue)) {
+		Py_ssize_t length;
+		const char* chars = PyUnicode_AsUTF8AndSize(pValue, &length);
+		return chars != nullptr &&
+			PyWireFormat::AppendStr(buffer, string_view(chars, static_cast<size_t>(length)));
+	}
+	if (PyList_Check(pValue) || PyTuple_Check(pValue)) {
+		// pValue is a list or tuple, so PySequence_Fast returns it with a new reference.
+		PyObject* pSequence = PySequence_Fast(pValue, "expected a list or tuple");
+		Py_ssize_t size = PySequence_Fast_GET_SIZE(pSequence);
+		PyObject** pItems = PySequence_Fast_ITEMS(pSequence);
+		bool encoded = PyWireFormat::AppendSize(buffer, PyWireFormat::TAG_LIST,
+												static_cast<size_t>(size));
+		for (Py_ssize_t i = 0; encoded && i < size; ++i) {
+			encoded = EncodeObject(pItems[i], buffer);
+		}
+		Py_DECREF(pSequence);
+		return encoded;
+	}
+	if (PyDict_Check(pValue)) {
+		if (!PyWireFormat::AppendSize(buffer, PyWireFormat::TAG_DICT,
+									  static_cast<size_t>(PyDict_Size(pValue)))) {
+			return false;
+		}
+		PyObject* pKey;
+		PyObject* pItem;
+		Py_ssize_t position = 0;
+		// pKey and pItem are borrowed references
+		while (PyDict_Next(pValue, &position, &pKey, &pItem)) {
+			if (!PyUnicode_Check(pKey)) {
+				PyErr_SetString(PyExc_TypeError, "dict keys sent to the host must be str");
+				return false;
+			}
+			if (!EncodeObject(pKey, buffer) || !EncodeObject(pItem, buffer)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	PyErr_Format(PyExc_TypeError, "can't send %s objects to the host", Py_TYPE(pValue)->tp_name);
+	return false;
+}
+
+/**
+ * Decode one object in the PyWire format from the front of buffer, and advance buffer past it.
+ *
+ * @param buffer Encoded objects.
+ *
+ * @return New reference to the object, or nullptr with a Python error set if buffer is malformed.
+ */
+PyObject* PyWorkerPool::DecodeObject(string_view& buffer) {
+	if (buffer.empty()) {
+		PyErr_SetString(PyExc_ValueError, "truncated request");
+		return nullptr;
+	}
+
+	char tag = buffer.front();
+	if (tag == PyWireFormat::TAG_NONE) {
+		buffer.remove_prefix(1);
+		Py_RETURN_NONE;
+	}
+	if (tag == PyWireFormat::TAG_BOOL) {
+		long long value;
+		if (PyWireFormat::ReadInt(buffer, value)) {
+			return PyBool_FromLong(static_cast<long>(value));
+		}
+	}
+	else if (tag == PyWireFormat::TAG_INT) {
+		long long value;
+		if (PyWireFormat::ReadInt(buffer, value)) {
+			return PyLong_FromLongLong(value);
+		}
+	}
+	else if (tag == PyWireFormat::TAG_FLOAT) {
+		double value;
+		if (PyWireFormat::ReadDouble(buffer, value)) {
+			return PyFloat_FromDouble(value);
+		}
+	}
+	else if (tag == PyWireFormat::TAG_STR) {
+		string_view value;
+		if (PyWireFormat::ReadStr(buffer, value)) {
+			return PyUnicode_FromStringAndSize(value.data(), static_cast<Py_ssize_t>(value.size()));
+		}
+	}
+	else if (tag == PyWireFormat::TAG_LIST) {
+		uint32_t size;
+		// Each item takes at least one byte, which bounds the allocation for a corrupt size.
+		if (PyWireFormat::ReadSize(buffer, PyWireFormat::TAG_LIST, size) && size <= buffer.size()) {
+			PyObject* pList = PyList_New(static_cast<Py_ssize_t>(size));
+			for (uint32_t i = 0; pList != nullptr && i < size; ++i) {
+				PyObject* pItem = DecodeObject(buffer);
+				if (pItem == nullptr) {
+					Py_CLEAR(pList);
+					break;
+				}
+				// PyList_SET_ITEM steals the reference to pItem
+				PyList_SET_ITEM(pList, static_cast<Py_ssize_t>(i), pItem);
+			}
+			return pList;
+		}
+	}
+	else if (tag == PyWireFormat::TAG_DICT) {
+		uint32_t size;
+		if (PyWireFormat::ReadSize(buffer, PyWireFormat::TAG_DICT, size)) {
+			PyObject* pDict = PyDict_New();
+			for (uint32_t i = 0; pDict != nullptr && i < size; ++i) {
+				PyObject* pKey = DecodeObject(buffer);
+				PyObject* pItem = (pKey == nullptr) ? nullptr : DecodeObject(buffer);
+				if (pItem == nullptr || PyDict_SetItem(pDict, pKey, pItem) != 0) {
+					Py_CLEAR(pDict);
+				}
+				Py_XDECREF(pKey);
+				Py_XDECREF(pItem);
+			}
+			return pDict;
+		}
+	}
+
+	if (!PyErr_Occurred()) {
+		PyErr_SetString(PyExc_ValueError, "malformed request");
+	}
+	return nullptr;
+}
+
+/* -------------------- Channels -------------------- */
+
+/**
+ * Write one message: its length, then the message.
+ *
+ * @param channel File descriptor or handle to write to.
+ * @param message Message to write.
+ *
+ * @return false if the channel broke.
+ */
+bool PyWorkerPool::WriteFrame(intptr_t channel, const string& message) {
+	if (message.size() > MAX_MESSAGE_SIZE) {
+		cerr << "A Python call's arguments or result are too large to send." << endl;
+		return false;
+	}
+	string frame;
+	frame.reserve(sizeof(uint32_t) + message.size());
+	PyWireFormat::AppendValue(frame, static_cast<uint32_t>(message.size()));
+	frame += message;
+	return WriteChannel(channel, frame.data(), frame.size());
+}
+
+/**
+ * Read one message written by WriteFrame().
+ *
+ * @param channel File descriptor or handle to read from.
+ * @param message Receives the message.
+ *
+ * @return false if the channel was closed or broke, or the message is too large.
+ */
+bool PyWorkerPool::ReadFrame(intptr_t channel, string& message) {
+	char header[sizeof(uint32_t)];
+	if (!ReadChannel(channel, header, sizeof(header))) {
+		return false;
+	}
+	string_view headerView(header, sizeof(header));
+	uint32_t size;
+	PyWireFormat::ReadValue(headerView, size);
+	if (size > MAX_MESSAGE_SIZE) {
+		return false;
+	}
+
+	message.resize(size);
+	return ReadChannel(channel, &message[0], size);
+}
+
+/**
+ * Write all of a buffer to a channel.
+ *
+ * @return false if the channel broke.
+ */
+bool PyWorkerPool::WriteChannel(intptr_t channel, const char* data, size_t size) {
+	while (size > 0) {
+#ifdef _WIN32
+		DWORD chunk = static_cast<DWORD>(min<size_t>(size, 1 << 20));
+		DWORD written;
+		if (!WriteFile(reinterpret_cast<HANDLE>(channel), data, chunk, &written, nullptr)) {
+			return false;
+		}
+#else
+		// MSG_NOSIGNAL: a worker that has exited breaks the channel instead of raising SIGPIPE.
+		ssize_t written = send(static_cast<int>(channel), data, size, MSG_NOSIGNAL);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+#endif
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+/**
+ * Read exactly size bytes from a channel.
+ *
+ * @return false if the channel was closed or broke first.
+ */
+bool PyWorkerPool::ReadChannel(intptr_t channel, char* data, size_t size) {
+	while (size > 0) {
+#ifdef _WIN32
+		DWORD chunk = static_cast<DWORD>(min<size_t>(size, 1 << 20));
+		DWORD received;
+		if (!ReadFile(reinterpret_cast<HANDLE>(channel), data, chunk, &received, nullptr) ||
+			received == 0) {
+			return false;
+		}
+#else
+		ssize_t received = recv(static_cast<int>(channel), data, size, 0);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return false;
+		}
+#endif
+		data += received;
+		size -= static_cast<size_t>(received);
+	}
+	return true;
+}
@@ -0,0 +1,211 @@
+/**
+ * PyWorkerPool.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See PyWorkerPool.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef PYWORKERPOOL_H
+#define PYWORKERPOOL_H
+
+#include "PyInterface.h"
+#include "PyWire.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/* Result of a call run by a PyWorkerPool worker. */
+template <typename R>
+struct PyWorkerReply {
+	R value;			// The function's result, or PyWire<R>::ErrorValue() if the call failed.
+	string output;		// Everything the function printed to sys.stdout.
+	bool succeeded;		// false if the call raised, returned the wrong type, or crashed the worker.
+};
+
+template <>
+struct PyWorkerReply<void> {
+	string output;
+	bool succeeded;
+};
+
+class PyWorkerPool {
+public:
+	PyWorkerPool(unsigned int workerCount, const char* pyModuleName = "PythonCode");
+	~PyWorkerPool();
+	PyWorkerPool(const PyWorkerPool&) = delete;
+	PyWorkerPool& operator=(const PyWorkerPool&) = delete;
+
+	template <typename R = void, typename... Args>
+	future<PyWorkerReply<R>> Submit(const string& proc, const Args&... args);
+
+	unsigned int GetWorkerCount() const;
+	unsigned long long GetRestartCount() const;
+	void Shutdown();
+
+	static const char* WORKER_OPTION;
+	static int RunWorker(const string& pyModuleName, const string& channels);
+
+private:
+	/* A call waiting for a worker: the encoded request, and what to do with the reply. An empty
+	 * reply means the call couldn't be delivered or the worker stopped while running it. */
+	struct Task {
+		string request;
+		function<void(string_view reply)> complete;
+	};
+
+	/* One worker process and the channel to it. */
+	struct Worker {
+		bool running;
+		intptr_t requestChannel;
+		intptr_t replyChannel;
+#ifdef _WIN32
+		void* processHandle;
+#else
+		int processId;
+#endif
+	};
+
+	static const char REPLY_RESULT = 'r';
+	static const char REPLY_FAILED = 'x';
+
+	bool Enqueue(Task task);
+	void ServeWorker();
+	bool StartWorker(Worker& worker);
+	void StopWorker(Worker& worker, bool kill);
+	bool Exchange(Worker& worker, const string& request, string& reply);
+
+	template <typename R>
+	static PyWorkerReply<R> DecodeReply(const string& proc, string_view reply);
+
+	static void ServeRequest(PyInterface& pyInterface, PyObject* pStringIO,
+							 const string& request, string& reply);
+	static bool EncodeObject(PyObject* pValue, string& buffer);
+	static PyObject* DecodeObject(string_view& buffer);
+	static bool WriteFrame(intptr_t channel, const string& message);
+	static bool ReadFrame(intptr_t channel, string& message);
+	static bool WriteChannel(intptr_t channel, const char* data, size_t size);
+	static bool ReadChannel(intptr_t channel, char* data, size_t size);
+
+	const char* m_pyModuleName;
+	unsigned int m_workerCount;
+	mutex m_mutex;
+	condition_variable m_queueChanged;
+	deque<Task> m_queue;
+	bool m_stopping;
+	atomic<unsigned long long> m_restartCount;
+	vector<thread> m_workerThreads;
+
+	static mutex s_spawnMutex;
+};
+
+/**
+ * Queue a call to the Python function named "proc" on the next free worker process and return
+ * its reply as a future. Calls run in parallel, one per worker, and are started in the order they
+ * were submitted. The arguments are encoded right away (see PyWire.h), so they needn't outlive
+ * the call. E.g.:
+ *   vector<future<PyWorkerReply<int>>> replies;
+ *   for (const string& fileName : fileNames) {
+ *       replies.push_back(pool.Submit<int>("CountItems", fileName));
+ *   }
+ *   for (auto& reply : replies) { cout << reply.get().output; }
+ *
+ * Defined in this header because it is a template.
+ *
+ * @param proc Name of function in the Python module.
+ * @param args Arguments for the function: any types with a PyWire specialization.
+ *
+ * @return Future for the reply: the function's result converted to R, what it printed, and
+ * whether it succeeded. Holds a runtime_error if the pool has been shut down.
+ */
+template <typename R, typename... Args>
+future<PyWorkerReply<R>> PyWorkerPool::Submit(const string& proc, const Args&... args) {
+	auto pReply = make_shared<promise<PyWorkerReply<R>>>();
+	future<PyWorkerReply<R>> result = pReply->get_future();
+
+	// A request is the function's name and a list of its arguments. decay<const Args> turns
+	// string literals into const char*, as in PyInterface::Call<R>().
+	Task task;
+	bool encoded = PyWireFormat::AppendStr(task.request, proc) &&
+		PyWireFormat::AppendSize(task.request, PyWireFormat::TAG_LIST, sizeof...(Args)) &&
+		(PyWire<typename decay<const Args>::type>::Write(task.request, args) && ...);
+	if (!encoded) {
+		cerr << "Couldn't send the arguments for " << proc << " to a Python worker." << endl;
+		pReply->set_value(DecodeReply<R>(proc, string_view()));
+		return result;
+	}
+
+	task.complete = [pReply, proc](string_view reply) {
+		pReply->set_value(DecodeReply<R>(proc, reply));
+	};
+	if (!Enqueue(move(task))) {
+		pReply->set_exception(make_exception_ptr(runtime_error("PyWorkerPool is shut down")));
+	}
+	return result;
+}
+
+/**
+ * Decode a worker's reply: a REPLY_RESULT or REPLY_FAILED byte, what the function printed, and
+ * for REPLY_RESULT the function's result (see PyWorkerPool.cpp).
+ *
+ * @param proc Name of the function called, for error messages.
+ * @param reply Reply bytes, or empty if the call wasn't delivered or its worker stopped.
+ *
+ * @return The reply. On any failure, value is PyWire<R>::ErrorValue() and succeeded is false.
+ */
+template <typename R>
+PyWorkerReply<R> PyWorkerPool::DecodeReply(const string& proc, string_view reply) {
+	PyWorkerReply<R> workerReply;
+	workerReply.succeeded = false;
+	if constexpr (!is_void<R>::value) {
+		workerReply.value = PyWire<R>::ErrorValue();
+	}
+
+	string_view output;
+	bool hasResult = PyWireFormat::ReadTag(reply, REPLY_RESULT);
+	if (!hasResult && !PyWireFormat::ReadTag(reply, REPLY_FAILED)) {
+		return workerReply;
+	}
+	if (!PyWireFormat::ReadStr(reply, output)) {
+		cerr << "Couldn't read the reply to " << proc << " from a Python worker." << endl;
+		return workerReply;
+	}
+	workerReply.output.assign(output.data(), output.size());
+	if (!hasResult) {
+		return workerReply;
+	}
+
+	if constexpr (is_void<R>::value) {
+		workerReply.succeeded = true;
+	}
+	else {
+		R value;
+		if (PyWire<R>::Read(reply, value)) {
+			workerReply.value = move(value);
+			workerReply.succeeded = true;
+		}
+		else {
+			cerr << proc << " returned an unexpected type." << endl;
+		}
+	}
+	return workerReply;
+}
+
+#endif
@@ -0,0 +1,305 @@
+/**
+ * ShardedCounter.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Purchase counts that many threads can add to at once, e.g. one thread per register feeding
+ * purchases live, while other threads read consistent snapshots. Counters are keyed by interned
+ * item ID, as in PurchaseIndex, and no lock is taken to count a purchase.
+ *
+ * Design:
+ * - Each producer thread gets a Writer from AddWriter(), with its own shard: a full set of
+ * counters on cache lines no other writer touches. A shard has a single writer, so counting is
+ * a plain load and store of a relaxed atomic, not a locked read-modify-write, and writers never
+ * contend. A purchase's total is the sum of its counters in every shard.
+ * - Shards hold counters in blocks of BLOCK_SIZE, allocated by the writer the first time it
+ * counts an item in the block, so memory grows with the items each writer has seen.
+ * - Item names are interned once per item by Intern() (a shared lock for names already known,
+ * an exclusive one for new names); producers should keep the IDs rather than intern per
+ * purchase.
+ *
+ * Snapshots:
+ * - Each shard is a seqlock: its sequence number is odd while its writer is applying a batch.
+ * Snapshot() copies a shard, then checks the sequence number is even and unchanged; if not, the
+ * copy may be torn and is taken again. So a snapshot has, from each writer, exactly the batches
+ * it had finished at some moment during the snapshot: a batch (BeginBatch()/EndBatch(), e.g. all
+ * items of one receipt) is never seen in part. A lone Add() is a batch of one.
+ * - Writers never wait for readers, except when a shard changes under a reader SNAPSHOT_ATTEMPTS
+ * times in a row: the reader then asks that writer to pause before its next batch, and copies
+ * the shard while it waits. The writer pauses for one shard copy at most.
+ * - Snapshots of different shards are taken one after another, not at one instant, so they are
+ * consistent per writer. Each counter only grows, so every snapshot is at least the previous one.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "ShardedCounter.h"
+
+using namespace std;
+
+/* Times a reader copies a shard that keeps changing before asking its writer to pause. */
+static const int SNAPSHOT_ATTEMPTS = 8;
+
+/**
+ * Shard constructor. No blocks until the writer counts an item.
+ */
+ShardedCounter::Shard::Shard() {
+	sequence.store(0, memory_order_relaxed);
+	readerWaiting.store(false, memory_order_relaxed);
+	batchDepth = 0;
+	for (atomic<atomic<unsigned long long>*>& block : blocks) {
+		block.store(nullptr, memory_order_relaxed);
+	}
+}
+
+/**
+ * Shard destructor. Frees the blocks.
+ */
+ShardedCounter::Shard::~Shard() {
+	for (atomic<atomic<unsigned long long>*>& block : blocks) {
+		delete[] block.load(memory_order_relaxed);
+	}
+}
+
+/**
+ * Default constructor. Creates a counter with no items and no writers.
+ */
+ShardedCounter::ShardedCounter() {
+	m_itemCount.store(0, memory_order_relaxed);
+	m_snapshotRetries.store(0, memory_order_relaxed);
+}
+
+/**
+ * Add a shard and return its writer. Call once per producer thread; shards are kept, with their
+ * counts, for the life of the counter.
+ *
+ * @return Writer for the new shard.
+ */
+ShardedCounter::Writer ShardedCounter::AddWriter() {
+	lock_guard<mutex> lock(m_shardsMutex);
+	m_shards.push_back(make_unique<Shard>());
+	return Writer(m_shards.back().get());
+}
+
+/**
+ * Get the ID of an item, assigning the next ID if it hasn't been seen before. Thread safe.
+ *
+ * @param item Item name.
+ *
+ * @return ID of the item, or ItemDictionary::NO_ITEM if the counter already has MAX_ITEMS items.
+ */
+uint32_t ShardedCounter::Intern(string_view item) {
+	{
+		shared_lock<shared_mutex> lock(m_dictionaryMutex);
+		uint32_t id = m_dictionary.Find(item);
+		if (id != ItemDictionary::NO_ITEM) {
+			return id;
+		}
+	}
+
+	unique_lock<shared_mutex> lock(m_dictionaryMutex);
+	if (m_dictionary.Size() >= MAX_ITEMS && m_dictionary.Find(item) == ItemDictionary::NO_ITEM) {
+		return ItemDictionary::NO_ITEM;
+	}
+	uint32_t id = m_dictionary.Intern(item);
+	m_itemCount.store(m_dictionary.Size(), memory_order_release);
+	return id;
+}
+
+/**
+ * Get the ID of an item without adding it. Thread safe.
+ *
+ * @param item Item name.
+ *
+ * @return ID of the item, or ItemDictionary::NO_ITEM if it hasn't been interned.
+ */
+uint32_t ShardedCounter::FindItem(string_view item) const {
+	shared_lock<shared_mutex> lock(m_dictionaryMutex);
+	return m_dictionary.Find(item);
+}
+
+/**
+ * Take a snapshot of every item's count, summed over all writers. Thread safe, and writers may
+ * keep counting. See top of file for what the snapshot is consistent with.
+ *
+ * @return Count of each item by ID, for IDs 0 to ItemCount() - 1 as of the snapshot.
+ */
+vector<unsigned long long> ShardedCounter::Snapshot() const {
+	vector<unsigned long long> totals;
+	vector<unsigned long long> shardCounts;
+	{
+		lock_guard<mutex> lock(m_shardsMutex);
+		for (const unique_ptr<Shard>& shard : m_shards) {
+			for (int attempt = 1; !CopyShard(*shard, attempt, shardCounts); ++attempt) {
+				m_snapshotRetries.fetch_add(1, memory_order_relaxed);
+			}
+			if (totals.size() < shardCounts.size()) {
+				totals.resize(shardCounts.size(), 0);
+			}
+			for (size_t id = 0; id < shardCounts.size(); ++id) {
+				totals[id] += shardCounts[id];
+			}
+		}
+	}
+
+	// Read after the shards: any item counted in them was interned before it was counted.
+	totals.resize(m_itemCount.load(memory_order_acquire), 0);
+	return totals;
+}
+
+/**
+ * Replace the contents of a PurchaseIndex with a snapshot, e.g. to report on it with
+ * FormatItemCounts() or a HistogramWriter. Item IDs are the same in both.
+ *
+ * @param index Index to fill.
+ */
+void ShardedCounter::SnapshotInto(PurchaseIndex& index) const {
+	vector<unsigned long long> counts = Snapshot();
+	index.Clear();
+	shared_lock<shared_mutex> lock(m_dictionaryMutex);
+	for (uint32_t id = 0; id < counts.size(); ++id) {
+		index.AddPurchases(m_dictionary.NameOf(id), counts[id]);
+	}
+}
+
+/**
+ * Copy one shard's counters, as a seqlock reader. From attempt SNAPSHOT_ATTEMPTS on, asks the
+ * shard's writer to pause before its next batch, so the copy can't be starved.
+ *
+ * @param shard Shard to copy.
+ * @param attempt Number of this attempt, from 1.
+ * @param counts Receives the shard's counters, one per ID in its allocated blocks.
+ *
+ * @return true if the copy is consistent, false if the writer changed the shard meanwhile.
+ */
+bool ShardedCounter::CopyShard(Shard& shard, int attempt, vector<unsigned long long>& counts) {
+	if (attempt == SNAPSHOT_ATTEMPTS) {
+		shard.readerWaiting.store(true, memory_order_seq_cst);
+	}
+
+	unsigned long long sequence = shard.sequence.load(memory_order_acquire);
+	bool copied = (sequence & 1) == 0;
+	counts.clear();
+	for (size_t blockIndex = 0; copied && blockIndex < MAX_BLOCKS; ++blockIndex) {
+		atomic<unsigned long long>* block = shard.blocks[blockIndex].load(memory_order_acquire);
+		if (block == nullptr) {
+			continue;
+		}
+		counts.resize((blockIndex + 1) * BLOCK_SIZE, 0);
+		for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+			counts[blockIndex * BLOCK_SIZE + i] = block[i].load(memory_order_relaxed);
+		}
+	}
+	atomic_thread_fence(memory_order_acquire);
+	copied = copied && shard.sequence.load(memory_order_relaxed) == sequence;
+
+	if (copied && attempt >= SNAPSHOT_ATTEMPTS) {
+		shard.readerWaiting.store(false, memory_order_release);
+	}
+	else if (!copied) {
+		this_thread::yield();
+	}
+	return copied;
+}
+
+/* -------------------- Accessors & Mutators -------------------- */
+
+/**
+ * @return Number of items interned. IDs run from 0 to ItemCount() - 1.
+ */
+size_t ShardedCounter::ItemCount() const {
+	return m_itemCount.load(memory_order_acquire);
+}
+
+/**
+ * @return Number of writers (shards) added.
+ */
+size_t ShardedCounter::WriterCount() const {
+	lock_guard<mutex> lock(m_shardsMutex);
+	return m_shards.size();
+}
+
+/**
+ * @return Number of shard copies that snapshots had to take again because a writer was in the
+ * middle of a batch. A measure of reader-writer contention.
+ */
+unsigned long long ShardedCounter::GetSnapshotRetries() const {
+	return m_snapshotRetries.load(memory_order_relaxed);
+}
+
+/* -------------------- Writer -------------------- */
+
+/**
+ * Default constructor. Creates a Writer with no shard, for assigning one from AddWriter() later.
+ * Must not be used to count until then.
+ */
+ShardedCounter::Writer::Writer() {
+	m_shard = nullptr;
+}
+
+/**
+ * Constructor used by AddWriter().
+ *
+ * @param shard The writer's shard.
+ */
+ShardedCounter::Writer::Writer(Shard* shard) {
+	m_shard = shard;
+}
+
+/**
+ * Move constructor. other no longer has a shard.
+ *
+ * @param other Writer to take the shard of.
+ */
+ShardedCounter::Writer::Writer(Writer&& other) noexcept {
+	m_shard = other.m_shard;
+	other.m_shard = nullptr;
+}
+
+/**
+ * Move assignment. other no longer has a shard.
+ *
+ * @param other Writer to take the shard of.
+ *
+ * @return This writer.
+ */
+ShardedCounter::Writer& ShardedCounter::Writer::operator=(Writer&& other) noexcept {
+	m_shard = other.m_shard;
+	if (this != &other) {
+		other.m_shard = nullptr;
+	}
+	return *this;
+}
+
+/**
+ * @return true if the writer has a shard to count into.
+ */
+bool ShardedCounter::Writer::IsValid() const {
+	return m_shard != nullptr;
+}
+
+/**
+ * Allocate a block of zeroed counters in the writer's shard.
+ *
+ * @param blockIndex Index of the block.
+ *
+ * @return The new block.
+ */
+atomic<unsigned long long>* ShardedCounter::Writer::AddBlock(size_t blockIndex) {
+	atomic<unsigned long long>* block = new atomic<unsigned long long>[BLOCK_SIZE];
+	for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+		block[i].store(0, memory_order_relaxed);
+	}
+	m_shard->blocks[blockIndex].store(block, memory_order_release);
+	return block;
+}
+
+/**
+ * Wait while a reader that couldn't get a consistent copy of this writer's shard copies it.
+ */
+void ShardedCounter::Writer::WaitForReader() {
+	while (m_shard->readerWaiting.load(memory_order_acquire)) {
+		this_thread::yield();
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * ShardedCounter.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See ShardedCounter.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef SHARDEDCOUNTER_H
+#define SHARDEDCOUNTER_H
+
+#include "ItemDictionary.h"
+#include "PurchaseIndex.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ShardedCounter {
+private:
+	/* Counters per block. Blocks are allocated as item IDs reach them. */
+	static const size_t BLOCK_SIZE = 4096;
+	/* Blocks per shard, which limits the number of items (see MAX_ITEMS). */
+	static const size_t MAX_BLOCKS = 4096;
+
+	/* One writer's counters, on cache lines no other writer touches. The sequence number is odd
+	 * while the writer is applying a batch (a seqlock), so readers can tell a torn copy. */
+	struct alignas(64) Shard {
+		atomic<unsigned long long> sequence;
+		atomic<bool> readerWaiting;		// A reader is waiting for the writer to pause.
+		unsigned int batchDepth;		// Open BeginBatch() calls. Used by the writer only.
+		atomic<atomic<unsigned long long>*> blocks[MAX_BLOCKS];
+
+		Shard();
+		~Shard();
+	};
+
+public:
+	/* Most distinct items. Intern() returns ItemDictionary::NO_ITEM past this. */
+	static const size_t MAX_ITEMS = BLOCK_SIZE * MAX_BLOCKS;
+
+	/* Adds purchases to one shard. Each producer thread needs its own Writer; a Writer must not
+	 * be used by two threads at once. Move-only. Defined in this header so the per-purchase
+	 * path is inlined. */
+	class Writer {
+	public:
+		Writer();
+		Writer(Writer&& other) noexcept;
+		Writer& operator=(Writer&& other) noexcept;
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
+
+		/* Add purchases of an item by ID. IDs of MAX_ITEMS or more are ignored. */
+		void Add(uint32_t id, unsigned long long count = 1) {
+			if (id >= MAX_ITEMS) {
+				return;
+			}
+			atomic<unsigned long long>* block = m_shard->blocks[id / BLOCK_SIZE].load(
+				memory_order_relaxed);
+			if (block == nullptr) {
+				block = AddBlock(id / BLOCK_SIZE);
+			}
+
+			bool inBatch = m_shard->batchDepth != 0;
+			if (!inBatch) {
+				BeginBatch();
+			}
+			atomic<unsigned long long>& counter = block[id % BLOCK_SIZE];
+			counter.store(counter.load(memory_order_relaxed) + count, memory_order_relaxed);
+			if (!inBatch) {
+				EndBatch();
+			}
+		}
+
+		/* Start a batch: the Add() calls until EndBatch() appear in snapshots all together or not
+		 * at all, e.g. every item of one receipt. Batches may nest. */
+		void BeginBatch() {
+			if (m_shard->batchDepth++ != 0) {
+				return;
+			}
+			if (m_shard->readerWaiting.load(memory_order_relaxed)) {
+				WaitForReader();
+			}
+			m_shard->sequence.store(m_shard->sequence.load(memory_order_relaxed) + 1,
+									memory_order_relaxed);
+			atomic_thread_fence(memory_order_release);
+		}
+
+		/* End a batch started by BeginBatch(). */
+		void EndBatch() {
+			if (--m_shard->batchDepth != 0) {
+				return;
+			}
+			m_shard->sequence.store(m_shard->sequence.load(memory_order_relaxed) + 1,
+									memory_order_release);
+		}
+
+		bool IsValid() const;
+
+	private:
+		friend class ShardedCounter;
+		explicit Writer(Shard* shard);
+		atomic<unsigned long long>* AddBlock(size_t blockIndex);
+		void WaitForReader();
+
+		Shard* m_shard;
+	};
+
+	ShardedCounter();
+	ShardedCounter(const ShardedCounter&) = delete;
+	ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+	Writer AddWriter();
+	uint32_t Intern(string_view item);
+	uint32_t FindItem(string_view item) const;
+
+	vector<unsigned long long> Snapshot() const;
+	void SnapshotInto(PurchaseIndex& index) const;
+	size_t ItemCount() const;
+	size_t WriterCount() const;
+	unsigned long long GetSnapshotRetries() const;
+
+private:
+	static bool CopyShard(Shard& shard, int attempt, vector<unsigned long long>& counts);
+
+	mutable shared_mutex m_dictionaryMutex;
+	ItemDictionary m_dictionary;
+	atomic<size_t> m_itemCount;
+
+	mutable mutex m_shardsMutex;
+	vector<unique_ptr<Shard>> m_shards;
+	mutable atomic<unsigned long long> m_snapshotRetries;
+};
+
+#endif
@@ -6,11 +6,68 @@
  *    Date: 2022-12-11
  * 
  * Refers to a specified .txt file listing items purchased in a given day. One item per line. 
- * The user has four options:
+ * The user has six options:
  * 1. List all items alongside the number of times each was purchased, 
  * 2. List all items, select one, and display the number of times that one was purchased, 
- * 3. See and save a histogram representing the number of times each item was purchased, or
- * 4. Exit the program
+ * 3. See and save a histogram representing the number of times each item was purchased, 
+ * 4. List a given number of the best-selling items, 
+ * 5. Show how long each part of the options so far has taken (with --stats), or
+ * 6. Exit the program
+ * 
+ * Run with a command after the options to print one report and exit without showing the menu
+ * (see GrocerBatch.cpp): 
+ *   CornerGrocerTracking [options] [-i FILE]... list | count ITEM|@FILE... | chart OUT | top K
+ * Exit codes are 0 on success, 1 if a file couldn't be read or written, and 2 for bad arguments.
+ * 
+ * Run with "serve SOCKET" to keep the -i inputs' counts in memory and answer COUNT, LIST, TOP, 
+ * CHART, and FILES requests on the Unix domain socket SOCKET until interrupted (see 
+ * GrocerServer.cpp), e.g. for dashboards that poll counts:
+ *   CornerGrocerTracking -i sales --refresh=10 serve /run/grocer.sock
+ * 
+ * Command-line options:
+ * -i FILE      Read purchases from FILE instead of INPUT_FILE_NAME. Commands accept any number
+ *              of -i options and report on each file in turn; the menu accepts one. In batch
+ *              mode FILE may also be a directory (every file in it) or a name with * and ?
+ *              wildcards, e.g. -i "sales/store*-2026-09-??.txt".
+ * --threads=N  Count purchases on up to N threads (0 = one per hardware thread). Default 1.
+ * --follow     Follow the input file as registers append to it: each menu selection only reads
+ *              purchases added since the last one. Truncated or replaced files are reread.
+ * --snapshot   Save counts to a snapshot file next to the input file (<input>.idx) and load them
+ *              from it while the input file is unchanged, instead of reading the input file.
+ * --jobs=N     Count up to N input files at once in batch mode (0 = one per hardware thread, the
+ *              default). Each file uses up to --threads threads.
+ * --rollup     In batch mode, also report all input files' purchases together, after the 
+ *              per-file reports.
+ * --pipeline[=N]  In batch mode, read every input at once, one thread each, and report all their
+ *              purchases together, through a queue of N blocks (default 64). Inputs may also be
+ *              FIFOs, or - for standard input, e.g. to merge the feeds of every lane of a store:
+ *              CornerGrocerTracking --pipeline -i lane1.fifo -i lane2.fifo list
+ *              With --stats, the pipeline's backpressure is summarized on standard error. See
+ *              IngestPipeline.cpp.
+ * --topk-capacity=N  Track up to N distinct items when finding best sellers (menu option four
+ *              and the top command). Counts are exact for files with up to N distinct items and
+ *              estimated, with bounds, beyond that. Default 4096.
+ * --chart-width=N   Scale histogram bars to at most N characters, with each exact count after its
+ *              bar, when any count is larger than N (0 = never scale). Default 60.
+ * --chart-format=F  Write histogram files as text (F = text, the default), as CSV rows of 
+ *              source,item,count (F = csv), or in a compact binary form (F = binary). See
+ *              HistogramWriter.cpp. The menu still prints the histogram as text.
+ * --engine=E   Count with the native engine (E = native, the default) or with the functions in
+ *              PythonCode.py (E = python).
+ * --py-workers=N  With --engine=python in batch mode, run the Python functions for list and 
+ *              count in N worker processes at once (0 = one per hardware thread), each with its
+ *              own interpreter, instead of one file at a time. See PyWorkerPool.cpp.
+ * --server-workers=N  With serve, answer requests on N threads (0 = one per hardware thread, the
+ *              default).
+ * --refresh=N  With serve, reread the inputs every N seconds (0 = never). Appended purchases 
+ *              are read incrementally. Default 5.
+ * --py-cache[=N]  With --engine=python, cache up to N results (default 64) of the Python
+ *              functions that only read the input file, so repeating a search doesn't call 
+ *              Python again until the file changes. See PyInterface.cpp.
+ * --stats      Time each phase of the menu options and Python calls (see LatencyStats.cpp), for
+ *              menu option five.
+ * --stats-json=FILE  As --stats, and write the timings to FILE as JSON on exit (- for standard
+ *              output, after any report).
  * 
  * Bugs: 
  * - Python integration is functional but maintenance stands to be troublesome. See 
@@ -21,14 +78,9 @@
  * - Could be slightly tightened up by adding string* vars for in- and out-filenames and passing 
  * them to GrocerMenuFuncs constructor. This would need to accompany modification in 
  * GrocerMenuFuncs to change its corresponding string member fields to const string* fields, and 
- * all corresponding tweaks to refs to those fields. Because C++ does not cast between strings and 
- * const strings, it would also need to accompany implementation of either: 
- * 1. changing global const strings INPUT_FILE_NAME and HISTOGRAM_FILE_NAME to strings (not const)
- * _or_ 
- * 2. adding two more overrides to CallIntFunc in PyInterface.cpp - one to have one const string 
- * param and one to have two const string params. 
- * Option 2 is preferable but would require a certain dedication of time to implement and debug yet
- * more PyInterface function overloads. 
+ * all corresponding tweaks to refs to those fields. PyInterface::Call<R>() takes const string,
+ * string_view, and any other argument types by const reference, so no more PyInterface overloads
+ * are needed for this. 
  * 
  * Other Notes:
  * - PyInterface.cpp and PythonCode.py are both easily extensible. 
@@ -41,13 +93,20 @@
  */
 
 #include "PyInterface.h"
+#include "PyExecutor.h"
+#include "PyWorkerPool.h"
 #include "UserMenu.h"
 #include "GrocerMenuFuncs.h"
+#include "GrocerBatch.h"
+#include "GrocerServer.h"
+#include "LatencyStats.h"
 // Some #includes are redundant. Retained for clarity.
 #include <iostream>
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include <cstring>
+#include <csignal>
 
 /* Remove global def of max() from Windows.h so numeric_limits<streamsize>::max() is accessible.
  * May not be necessary. */
@@ -60,6 +119,8 @@ using namespace std;
 const vector<string> CORNER_GROCER_MENU = { "List today's item purchases",
 											"Find an item's number of purchases today",
 											"Chart today's purchases",
+											"List today's best sellers",
+											"Show timing statistics",
 											//"This is an additional option", // testing UserMenu linked list
 											"Exit" };
 
@@ -68,9 +129,228 @@ const string INPUT_FILE_NAME = "CS210_Project_Three_Input_File.txt";
 /* Change HISTOGRAM_FILE_NAME to write item frequency histogram to different file. */
 const string HISTOGRAM_FILE_NAME = "frequency.dat";
 
-int main() {
-	/* PyInterface interacts with Python script. See PyInterface.cpp for documentation. */
-	PyInterface* pyInterface = new PyInterface();
+/* PythonCode.py functions whose results depend only on their arguments and the input file, and
+ * which print nothing, so --py-cache may cache them. */
+const vector<string> CACHEABLE_PY_FUNCTIONS = { "GetItems", "CountOneItem", "CountAllItems",
+												"CountManyItems" };
+
+/* Usage message printed for unrecognized command-line options. */
+const string USAGE_MESSAGE = 
+	"Usage: CornerGrocerTracking [--threads=N] [--follow] [--snapshot] [--engine=native|python]\n"
+	"                            [--jobs=N] [--rollup] [--topk-capacity=N] [--chart-width=N]\n"
+	"                            [--chart-format=text|csv|binary] [--py-workers=N] [--stats]\n"
+	"                            [--stats-json=FILE] [--server-workers=N] [--refresh=N]\n"
+	"                            [--py-cache[=N]] [--pipeline[=N]] [-i FILE]...\n"
+	"                            [list | count ITEM|@FILE... | chart OUT | top K | serve SOCKET]";
+
+/* Server started by the serve command, for the signal handler to stop. */
+GrocerServer* g_server = nullptr;
+
+/**
+ * Stop the server on SIGINT or SIGTERM, so it removes its socket file before exiting.
+ *
+ * @param signalNumber Signal received.
+ */
+void StopServer(int signalNumber) {
+	(void)signalNumber;
+	if (g_server != nullptr) {
+		g_server->Stop();
+	}
+}
+
+/**
+ * Turn on PyInterface's result cache for CACHEABLE_PY_FUNCTIONS.
+ *
+ * @param pyInterface Interface to the Python functions.
+ * @param capacity Most results to keep.
+ */
+void CachePyResults(PyInterface& pyInterface, size_t capacity) {
+	pyInterface.SetResultCacheCapacity(capacity);
+	for (const string& proc : CACHEABLE_PY_FUNCTIONS) {
+		pyInterface.CacheResults(proc);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	/* Started by a PyWorkerPool as a Python worker process: serve its calls, then exit. */
+	if (argc == 3 && string(argv[1]).compare(0, strlen(PyWorkerPool::WORKER_OPTION),
+											 PyWorkerPool::WORKER_OPTION) == 0) {
+		return PyWorkerPool::RunWorker(argv[1] + strlen(PyWorkerPool::WORKER_OPTION), argv[2]);
+	}
+
+	/* Read command-line options. See top of file for the list. */
+	unsigned int threadCount = 1;
+	bool followInput = false;
+	bool useSnapshots = false;
+	bool useNativeEngine = true;
+	bool usePyWorkers = false;
+	unsigned int pyWorkerCount = 0;
+	size_t pyCacheCapacity = 0;
+	unsigned int jobCount = 0;
+	bool rollup = false;
+	bool usePipeline = false;
+	size_t pipelineBlocks = IngestPipeline::DEFAULT_QUEUE_BLOCKS;
+	size_t topKCapacity = TopKSketch::DEFAULT_CAPACITY;
+	size_t chartWidth = HistogramWriter::DEFAULT_BAR_WIDTH;
+	HistogramWriter::Format chartFormat = HistogramWriter::Format::Text;
+	string statsFileName;
+	unsigned int serverWorkerCount = 0;
+	unsigned int refreshSeconds = GrocerServer::DEFAULT_REFRESH_SECONDS;
+	vector<string> inputFileNames;
+	vector<string> command;
+	for (int i = 1; i < argc; ++i) {
+		string option = argv[i];
+		// The first argument that isn't an option starts the command; the rest are its arguments.
+		if (!command.empty() || option.empty() || option.at(0) != '-') {
+			command.push_back(option);
+			continue;
+		}
+		try {
+			if (option == "-i" && i + 1 < argc) {
+				inputFileNames.push_back(argv[++i]);
+			}
+			else if (option == "--engine=native" || option == "--engine=python") {
+				useNativeEngine = option == "--engine=native";
+			}
+			else if (option.compare(0, 13, "--py-workers=") == 0) {
+				pyWorkerCount = stoul(option.substr(13));
+				usePyWorkers = true;
+			}
+			else if (option.compare(0, 7, "--jobs=") == 0) {
+				jobCount = stoul(option.substr(7));
+			}
+			else if (option == "--rollup") {
+				rollup = true;
+			}
+			else if (option == "--pipeline") {
+				usePipeline = true;
+			}
+			else if (option.compare(0, 11, "--pipeline=") == 0) {
+				pipelineBlocks = stoul(option.substr(11));
+				usePipeline = true;
+			}
+			else if (option.compare(0, 16, "--topk-capacity=") == 0) {
+				topKCapacity = stoul(option.substr(16));
+			}
+			else if (option.compare(0, 14, "--chart-width=") == 0) {
+				chartWidth = stoul(option.substr(14));
+			}
+			else if (option.compare(0, 15, "--chart-format=") == 0) {
+				if (!HistogramWriter::ParseFormat(option.substr(15), chartFormat)) {
+					throw invalid_argument(option);
+				}
+			}
+			else if (option.compare(0, 10, "--threads=") == 0) {
+				threadCount = stoul(option.substr(10));
+			}
+			else if (option == "--follow") {
+				followInput = true;
+			}
+			else if (option == "--snapshot") {
+				useSnapshots = true;
+			}
+			else if (option.compare(0, 17, "--server-workers=") == 0) {
+				serverWorkerCount = stoul(option.substr(17));
+			}
+			else if (option == "--py-cache") {
+				pyCacheCapacity = PyInterface::DEFAULT_RESULT_CACHE_CAPACITY;
+			}
+			else if (option.compare(0, 11, "--py-cache=") == 0) {
+				pyCacheCapacity = stoul(option.substr(11));
+			}
+			else if (option.compare(0, 10, "--refresh=") == 0) {
+				refreshSeconds = stoul(option.substr(10));
+			}
+			else if (option == "--stats") {
+				LatencyStats::SetEnabled(true);
+			}
+			else if (option.compare(0, 13, "--stats-json=") == 0 && option.size() > 13) {
+				statsFileName = option.substr(13);
+				LatencyStats::SetEnabled(true);
+			}
+			else {
+				throw invalid_argument(option);
+			}
+		}
+		// stoul throws invalid_argument or out_of_range for a bad number.
+		catch (logic_error& excpt) {
+			cout << "Didn't recognize option " << option << "." << endl << USAGE_MESSAGE << endl;
+			return GrocerBatch::EXIT_USAGE;
+		}
+	}
+
+	if (!command.empty() && inputFileNames.empty()) {
+		inputFileNames.push_back(INPUT_FILE_NAME);
+	}
+
+	/* Server mode: serve counts from memory until interrupted. Always uses the native engine. */
+	if (!command.empty() && command.at(0) == "serve") {
+		if (command.size() != 2) {
+			cerr << "serve needs a socket path." << endl << USAGE_MESSAGE << endl;
+			return GrocerBatch::EXIT_USAGE;
+		}
+		GrocerServer server(inputFileNames, command.at(1));
+		server.SetThreadCount(threadCount);
+		server.SetWorkerCount(serverWorkerCount);
+		server.SetRefreshSeconds(refreshSeconds);
+		server.SetChartWidth(chartWidth);
+		g_server = &server;
+		signal(SIGINT, StopServer);
+		signal(SIGTERM, StopServer);
+		bool served = server.Run();
+		g_server = nullptr;
+		if (!statsFileName.empty() && !LatencyStats::WriteJson(statsFileName)) {
+			cerr << "Couldn't write to " << statsFileName << "." << endl;
+		}
+		return served ? GrocerBatch::EXIT_OK : GrocerBatch::EXIT_FAILED;
+	}
+
+	/* Batch mode: run the command and exit. The Python interpreter is only started if needed. */
+	if (!command.empty()) {
+		PyInterface* pyInterface = useNativeEngine ? nullptr : new PyInterface();
+		if (pyInterface != nullptr && pyCacheCapacity > 0) {
+			CachePyResults(*pyInterface, pyCacheCapacity);
+		}
+		PyWorkerPool* pyWorkerPool = nullptr;
+		if (!useNativeEngine && usePyWorkers) {
+			pyWorkerPool = new PyWorkerPool(pyWorkerCount);
+		}
+		GrocerBatch batch = GrocerBatch(pyInterface);
+		batch.SetNativeEngine(useNativeEngine);
+		batch.SetPyWorkerPool(pyWorkerPool);
+		batch.SetThreadCount(threadCount);
+		batch.SetUseSnapshots(useSnapshots);
+		batch.SetJobCount(jobCount);
+		batch.SetRollup(rollup);
+		batch.SetPipeline(usePipeline);
+		batch.SetPipelineBlocks(pipelineBlocks);
+		batch.SetTopKCapacity(topKCapacity);
+		batch.SetChartWidth(chartWidth);
+		batch.SetChartFormat(chartFormat);
+		int exitCode = batch.Run(inputFileNames, command);
+		if (exitCode == GrocerBatch::EXIT_USAGE) {
+			cerr << USAGE_MESSAGE << endl;
+		}
+		delete pyWorkerPool;
+		delete pyInterface;
+		if (!statsFileName.empty() && !LatencyStats::WriteJson(statsFileName)) {
+			cerr << "Couldn't write to " << statsFileName << "." << endl;
+		}
+		return exitCode;
+	}
+	if (inputFileNames.size() > 1) {
+		cout << "The menu reads one input file at a time." << endl << USAGE_MESSAGE << endl;
+		return GrocerBatch::EXIT_USAGE;
+	}
+
+	/* PyExecutor interacts with Python script on its own thread, so the menu doesn't freeze during
+	 * long Python calls. See PyExecutor.cpp and PyInterface.cpp for documentation. */
+	PyExecutor* pyExecutor = new PyExecutor();
+	if (!useNativeEngine && pyCacheCapacity > 0) {
+		pyExecutor->Run([pyCacheCapacity](PyInterface& pyInterface) {
+			CachePyResults(pyInterface, pyCacheCapacity);
+		}).get();
+	}
 
 	/* UserMenu creates and displays menu based on above global const vector<string>. 
 	 * See UserMenu.cpp for documentation. */
@@ -78,15 +358,27 @@ int main() {
 
 	/* GrocerMenuFuncs is an interface for calling the functions listed in the UserMenu menu. 
 	 * see GrocerMenuFuncs.cpp for documentation. */
-	GrocerMenuFuncs menuSelection = GrocerMenuFuncs(pyInterface, userMenu, 
-													INPUT_FILE_NAME, HISTOGRAM_FILE_NAME);
+	GrocerMenuFuncs menuSelection = GrocerMenuFuncs(pyExecutor, userMenu, 
+													inputFileNames.empty() ? INPUT_FILE_NAME 
+																		   : inputFileNames.at(0),
+													HISTOGRAM_FILE_NAME);
+	menuSelection.SetNativeEngine(useNativeEngine);
+	menuSelection.SetThreadCount(threadCount);
+	menuSelection.SetFollowInput(followInput);
+	menuSelection.SetUseSnapshots(useSnapshots);
+	menuSelection.SetTopKCapacity(topKCapacity);
+	menuSelection.SetChartWidth(chartWidth);
+	menuSelection.SetChartFormat(chartFormat);
 
 	// Menu loop. menuSelection.MenuSelection() returns false if exit option is chosen.
 	bool loopMenu = true;
 	do { loopMenu = menuSelection.MenuSelection(); } while (loopMenu);
 	
 	// Done. Delete statements for clarity: no other ptrs should be in scope at this point. 
-	delete pyInterface;
+	delete pyExecutor;
 	delete userMenu;
+	if (!statsFileName.empty() && !LatencyStats::WriteJson(statsFileName)) {
+		cerr << "Couldn't write to " << statsFileName << "." << endl;
+	}
 	return 0;
 }
\ No newline at end of file
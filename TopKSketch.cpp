@@ -0,0 +1,283 @@
+/**
+ * TopKSketch.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Finds the best-selling items in a stream of purchases in fixed memory, for catalogs too large
+ * to count exactly (e.g. SKU-level logs with millions of distinct items) on machines with little
+ * RAM. PurchaseIndex keeps every distinct item; this keeps at most GetCapacity().
+ *
+ * Uses the Space-Saving algorithm (Metwally, Agrawal, and El Abbadi, 2005). Each of up to
+ * capacity counters monitors one item. A purchase of a monitored item adds to its counter. A
+ * purchase of any other item, once every counter is in use, takes over the counter with the
+ * smallest count: the new item inherits that count (plus one), and the inherited amount is
+ * recorded as the counter's error. So for every monitored item:
+ *   count - error <= true purchases <= count,
+ * and error is never more than GetTotal() / capacity. Any item bought more often than that is
+ * guaranteed to be monitored. While no counter has been taken over, IsExact() is true and every
+ * count is exact.
+ *
+ * Counters are kept in a binary min-heap by count, indexed by position so a counter can be
+ * adjusted in place, and found by name through a hash map. Each purchase costs one hash lookup
+ * and O(log capacity) heap moves.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "TopKSketch.h"
+#include "MappedFile.h"
+#include "LineScanner.h"
+#include <algorithm>
+
+using namespace std;
+
+/* Width of the dotted item/count lines, as PurchaseIndex::FormatItemCounts(). */
+static const int ITEM_COUNT_WIDTH = 30;
+/* Bytes of a mapped file to scan between releases of already-scanned pages. */
+static const size_t SCAN_RELEASE_BYTES = 16 * 1024 * 1024;
+/* Lines read from the LineScanner per batch. */
+static const size_t SCAN_BATCH_LINES = 256;
+
+/**
+ * Constructor.
+ *
+ * @param capacity Maximum number of items monitored. At least 1.
+ */
+TopKSketch::TopKSketch(size_t capacity) {
+	m_capacity = max<size_t>(capacity, 1);
+	m_total = 0;
+}
+
+/**
+ * Count purchases of an item.
+ *
+ * @param item Name of the purchased item, already stripped of surrounding whitespace.
+ * @param count Number of purchases to add.
+ */
+void TopKSketch::Add(string_view item, unsigned long long count) {
+	m_total += count;
+	m_lookupKey.assign(item);
+
+	auto found = m_lookup.find(m_lookupKey);
+	if (found != m_lookup.end()) {
+		Counter& counter = m_counters[found->second];
+		counter.count += count;
+		SiftDown(counter.heapPosition);
+		return;
+	}
+
+	if (m_counters.size() < m_capacity) {
+		uint32_t index = static_cast<uint32_t>(m_counters.size());
+		m_counters.push_back({ m_lookupKey, count, 0, m_heap.size() });
+		m_heap.push_back(index);
+		m_lookup.emplace(m_lookupKey, index);
+		SiftUp(m_heap.size() - 1);
+		return;
+	}
+
+	// Every counter is in use: the item takes over the counter with the smallest count.
+	uint32_t index = m_heap.front();
+	Counter& counter = m_counters[index];
+	m_lookup.erase(counter.item);
+	counter.item = m_lookupKey;
+	counter.error = counter.count;
+	counter.count += count;
+	m_lookup.emplace(m_lookupKey, index);
+	SiftDown(0);
+}
+
+/**
+ * Count every purchase in a purchase file, one item per line, stripped as PurchaseIndex does.
+ * The file is scanned in one pass without keeping more than the sketch's counters.
+ *
+ * @param fileName Name of the purchase file to read.
+ * @param rollup Another sketch to also add every purchase to, or nullptr. Lets a per-file and a
+ * combined summary be built from one read of each file.
+ *
+ * @return true if the file was read, false if it couldn't be opened.
+ */
+bool TopKSketch::AddFile(const string& fileName, TopKSketch* rollup) {
+	MappedFile inputFile;
+	if (!inputFile.Open(fileName)) {
+		return false;
+	}
+
+	LineScanner scanner(inputFile.View());
+	string_view lines[SCAN_BATCH_LINES];
+	size_t lineCount;
+	size_t releasedTo = 0;
+
+	while ((lineCount = scanner.NextBatch(lines, SCAN_BATCH_LINES)) > 0) {
+		for (size_t i = 0; i < lineCount; ++i) {
+			Add(lines[i]);
+			if (rollup != nullptr) {
+				rollup->Add(lines[i]);
+			}
+		}
+
+		if (scanner.Offset() - releasedTo >= SCAN_RELEASE_BYTES) {
+			inputFile.Release(releasedTo, scanner.Offset() - releasedTo);
+			releasedTo = scanner.Offset();
+		}
+	}
+	return true;
+}
+
+/**
+ * Forget every counter and purchase.
+ */
+void TopKSketch::Clear() {
+	m_total = 0;
+	m_counters.clear();
+	m_heap.clear();
+	m_lookup.clear();
+}
+
+/**
+ * @return Maximum number of items monitored.
+ */
+size_t TopKSketch::GetCapacity() const {
+	return m_capacity;
+}
+
+/**
+ * Set the maximum number of items monitored. Clears the sketch.
+ *
+ * @param capacity Maximum number of items monitored. At least 1.
+ */
+void TopKSketch::SetCapacity(size_t capacity) {
+	Clear();
+	m_capacity = max<size_t>(capacity, 1);
+}
+
+/**
+ * @return Total number of purchases added.
+ */
+unsigned long long TopKSketch::GetTotal() const {
+	return m_total;
+}
+
+/**
+ * @return true if every item added is still monitored, so every count is exact.
+ */
+bool TopKSketch::IsExact() const {
+	for (const Counter& counter : m_counters) {
+		if (counter.error != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Get the best-selling items, by estimated count. Ties are listed by name.
+ *
+ * @param k Maximum number of items to return.
+ *
+ * @return Up to k entries, highest count first.
+ */
+vector<TopKSketch::Entry> TopKSketch::TopItems(size_t k) const {
+	vector<Entry> entries;
+	entries.reserve(m_counters.size());
+	for (const Counter& counter : m_counters) {
+		entries.push_back({ counter.item, counter.count, counter.error });
+	}
+
+	auto isBefore = [](const Entry& first, const Entry& second) {
+		if (first.count != second.count) {
+			return first.count > second.count;
+		}
+		return first.item < second.item;
+	};
+	k = min(k, entries.size());
+	partial_sort(entries.begin(), entries.begin() + k, entries.end(), isBefore);
+	entries.resize(k);
+	return entries;
+}
+
+/**
+ * Build the list printed for the best sellers: one dotted line per item, as menu option one,
+ * highest count first. If a count may be over, the least it can be is added, e.g.:
+ * Peas ........................812 (at least 790)
+ *
+ * @param k Maximum number of items to list.
+ *
+ * @return String containing every line, each ending in '\n'.
+ */
+string TopKSketch::FormatTopItems(size_t k) const {
+	string output;
+
+	for (const Entry& entry : TopItems(k)) {
+		string numStr = to_string(entry.count);
+		int spaceWidth = ITEM_COUNT_WIDTH - static_cast<int>(entry.item.size() + numStr.size());
+
+		output += entry.item;
+		output += ' ';
+		output.append(max(spaceWidth, 0), '.');
+		output += numStr;
+		if (entry.error != 0) {
+			output += " (at least " + to_string(entry.count - entry.error) + ")";
+		}
+		output += '\n';
+	}
+
+	return output;
+}
+
+/* -------------------- Heap helpers -------------------- */
+
+/**
+ * Move a counter toward the root of the min-heap until its parent's count is no larger.
+ *
+ * @param heapPosition Position of the counter in m_heap.
+ */
+void TopKSketch::SiftUp(size_t heapPosition) {
+	while (heapPosition > 0) {
+		size_t parent = (heapPosition - 1) / 2;
+		if (m_counters[m_heap[parent]].count <= m_counters[m_heap[heapPosition]].count) {
+			break;
+		}
+		SwapHeap(parent, heapPosition);
+		heapPosition = parent;
+	}
+}
+
+/**
+ * Move a counter away from the root of the min-heap until neither child's count is smaller.
+ * Counts only grow, so this restores the heap after any update.
+ *
+ * @param heapPosition Position of the counter in m_heap.
+ */
+void TopKSketch::SiftDown(size_t heapPosition) {
+	while (true) {
+		size_t smallest = heapPosition;
+		size_t left = 2 * heapPosition + 1;
+		size_t right = left + 1;
+		if (left < m_heap.size() &&
+			m_counters[m_heap[left]].count < m_counters[m_heap[smallest]].count) {
+			smallest = left;
+		}
+		if (right < m_heap.size() &&
+			m_counters[m_heap[right]].count < m_counters[m_heap[smallest]].count) {
+			smallest = right;
+		}
+		if (smallest == heapPosition) {
+			return;
+		}
+		SwapHeap(smallest, heapPosition);
+		heapPosition = smallest;
+	}
+}
+
+/**
+ * Swap two heap positions and update the counters' positions to match.
+ *
+ * @param first Position in m_heap.
+ * @param second Position in m_heap.
+ */
+void TopKSketch::SwapHeap(size_t first, size_t second) {
+	swap(m_heap[first], m_heap[second]);
+	m_counters[m_heap[first]].heapPosition = first;
+	m_counters[m_heap[second]].heapPosition = second;
+}
@@ -0,0 +1,68 @@
+/**
+ * TopKSketch.h
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * See TopKSketch.cpp for documentation.
+ */
+
+#pragma once
+
+#ifndef TOPKSKETCH_H
+#define TOPKSKETCH_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class TopKSketch {
+public:
+	/* One monitored item: its estimated count and how much the estimate may be over by. */
+	struct Entry {
+		string item;
+		unsigned long long count;
+		unsigned long long error;
+	};
+
+	static const size_t DEFAULT_CAPACITY = 4096;
+
+	TopKSketch(size_t capacity = DEFAULT_CAPACITY);
+
+	void Add(string_view item, unsigned long long count = 1);
+	bool AddFile(const string& fileName, TopKSketch* rollup = nullptr);
+	void Clear();
+
+	size_t GetCapacity() const;
+	void SetCapacity(size_t capacity);
+	unsigned long long GetTotal() const;
+	bool IsExact() const;
+
+	vector<Entry> TopItems(size_t k) const;
+	string FormatTopItems(size_t k) const;
+
+private:
+	/* Counter for one monitored item. heapPosition is its index in m_heap. */
+	struct Counter {
+		string item;
+		unsigned long long count;
+		unsigned long long error;
+		size_t heapPosition;
+	};
+
+	void SiftUp(size_t heapPosition);
+	void SiftDown(size_t heapPosition);
+	void SwapHeap(size_t first, size_t second);
+
+	size_t m_capacity;
+	unsigned long long m_total;
+	vector<Counter> m_counters;
+	vector<uint32_t> m_heap;
+	unordered_map<string, uint32_t> m_lookup;
+	string m_lookupKey;
+};
+
+#endif
@@ -0,0 +1,827 @@
+/**
+ * Corner Grocer Tracking
+ * GrocerBench.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Benchmarks for the Corner Grocer engine, printed as JSON so runs can be saved and compared
+ * between releases. Not part of the Visual Studio project: it has its own main(). Build and run
+ * on Linux from the repository root:
+ *   g++ -std=c++17 -O2 -pthread $(python3-config --includes) -I. tools/GrocerBench.cpp \
+ *       $(ls *.cpp | grep -v '^Source.cpp$') -o GrocerBench $(python3-config --ldflags --embed)
+ *   PYTHONPATH=x64/Release ./GrocerBench > bench.json
+ *
+ * Cases (the "case" field of each result):
+ * - python_call: latency of each kind of PyInterface call, from C++ to a PythonCode.py function
+ *   and back, with an empty input file so the time is call overhead rather than Python's work.
+ *   Also the round trip of the same call through a PyExecutor and through a one-worker
+ *   PyWorkerPool, and of a call answered by PyInterface's result cache. Reports mean, min, p50,
+ *   and p99 microseconds per call.
+ * - menu_option: end-to-end time of GrocerMenuFuncs::OptListItems, OptSearchItem, and
+ *   OptChartItems with each engine, on the sample input file and on a generated file, console
+ *   output discarded. Reports mean, min, p50, and p99 milliseconds per run.
+ * - count_throughput: PurchaseIndex::LoadFile on one thread and on every hardware thread, and
+ *   TopKSketch::AddFile, on generated files of 1K to 100M lines (by powers of ten). Reports the
+ *   best of a few runs in seconds, lines per second, and MB per second (10^6 bytes).
+ * - item_search: ItemSearchIndex::Build on a generated catalog of made-up names, then Search for
+ *   an exact name, a prefix, a name with a typing error, and a name that isn't there. Reports
+ *   build seconds, and mean, min, p50, and p99 microseconds per search.
+ * - sharded_counter: ShardedCounter throughput with 1, 2, 4, 8, and 16 producer threads (and
+ *   one per hardware thread, if more), first counting single purchases, then counting receipts
+ *   of RECEIPT_SIZE purchases as batches while another thread takes snapshots. The second run is
+ *   also a stress test: every snapshot must be a whole number of receipts, no count may go down
+ *   between snapshots, and the final total must be exact ("consistent": false otherwise, and the
+ *   exit status is 1). Reports increments per second, snapshots taken, and snapshot retries.
+ * - pipeline: IngestPipeline::Run over 1, 2, 4, and 8 generated lane files of equal size, with
+ *   a queue of PIPELINE_SMALL_QUEUE blocks and of the default size. Reports the best of a few
+ *   runs in lines per second, with the backpressure of that run: how often and how long the
+ *   sources waited for a free block and the aggregator for a filled one, and the queue depth.
+ *   Every run must count every line ("consistent": false otherwise, and the exit status is 1).
+ *
+ * Options:
+ * --max-lines=N    Largest generated file for count_throughput. Default 100000000 (about 1 GB).
+ * --iterations=N   Calls per python_call result. Default 10000.
+ * --temp-dir=DIR   Directory for generated files, removed afterwards. Default ".".
+ * --search-items=N Names in the item_search catalog. Default 1000000.
+ * --increments=N   Purchases counted per sharded_counter result. Default 100000000.
+ * --pipeline-lines=N  Lines in all the pipeline lane files together. Default 10000000.
+ * --skip-python    Skip every case that needs PythonCode.py.
+ * --only=CASE[,CASE...]  Run only the named cases, e.g. --only=sharded_counter to run just the
+ *                  ShardedCounter stress test in CI: it generates no files and needs no Python.
+ *
+ * Progress goes to cerr and the JSON document to cout:
+ *   { "benchmark": "GrocerBench", "version": 1, "hardware_threads": 8, "results": [ {...}, ... ] }
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "GrocerMenuFuncs.h"
+#include "IngestPipeline.h"
+#include "ItemSearchIndex.h"
+#include "PurchaseIndex.h"
+#include "PyExecutor.h"
+#include "PyWorkerPool.h"
+#include "ShardedCounter.h"
+#include "TopKSketch.h"
+#include "UserMenu.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* Sample input file shipped with the app; its items are the catalog for generated files. */
+const string SAMPLE_FILE_NAME = "CS210_Project_Three_Input_File.txt";
+/* Catalog used if the sample file can't be read. */
+const vector<string> FALLBACK_CATALOG = { "Spinach", "Radishes", "Broccoli", "Peas", "Cranberries",
+										  "Potatoes", "Cucumbers", "Onions", "Yams", "Zucchini" };
+/* Menu options are run until this much time has passed (or MAX_RUNS)... */
+const double MIN_CASE_SECONDS = 0.5;
+/* ...but at least MIN_RUNS and at most MAX_RUNS times. */
+const size_t MIN_RUNS = 3;
+const size_t MAX_RUNS = 1000;
+/* Purchases per receipt in the sharded_counter stress run. */
+const size_t RECEIPT_SIZE = 4;
+/* Most lane files in the pipeline case, and the small queue size it also tries. */
+const size_t PIPELINE_MAX_SOURCES = 8;
+const size_t PIPELINE_SMALL_QUEUE = 4;
+/* Every case, in the order they run. */
+const vector<string> CASE_NAMES = { "python_call", "menu_option", "count_throughput",
+									"item_search", "sharded_counter", "pipeline" };
+
+/* Stream buffer that discards everything, for silencing console output while timing. */
+class NullBuffer : public streambuf {
+protected:
+	int overflow(int c) override {
+		return c;
+	}
+	streamsize xsputn(const char*, streamsize n) override {
+		return n;
+	}
+};
+
+/* Results collected as JSON objects, printed together at the end. */
+vector<string> g_results;
+
+/**
+ * @return Seconds since an arbitrary point, from a monotonic clock.
+ */
+double Now() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @param text Any text.
+ * @return text as a quoted JSON string.
+ */
+string JsonString(const string& text) {
+	ostringstream json;
+	json << '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			json << '\\' << c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			json << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec;
+		}
+		else {
+			json << c;
+		}
+	}
+	json << '"';
+	return json.str();
+}
+
+/**
+ * Add a result with summary statistics of a list of timings.
+ *
+ * @param fields Leading JSON fields, e.g. "\"case\": \"python_call\", \"name\": \"...\"".
+ * @param samples Time of each run, in seconds. Sorted by this function.
+ * @param unitName Unit suffix for the statistic fields, e.g. "us".
+ * @param unitScale Units per second, e.g. 1e6 for microseconds.
+ */
+void AddTimingResult(const string& fields, vector<double>& samples, const string& unitName,
+					 double unitScale) {
+	sort(samples.begin(), samples.end());
+	double total = 0;
+	for (double sample : samples) {
+		total += sample;
+	}
+	auto percentile = [&](double fraction) {
+		return samples[min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+	};
+
+	ostringstream json;
+	json << setprecision(6) << "{ " << fields << ", \"runs\": " << samples.size()
+		 << ", \"mean_" << unitName << "\": " << total / samples.size() * unitScale
+		 << ", \"min_" << unitName << "\": " << samples.front() * unitScale
+		 << ", \"p50_" << unitName << "\": " << percentile(0.50) * unitScale
+		 << ", \"p99_" << unitName << "\": " << percentile(0.99) * unitScale << " }";
+	g_results.push_back(json.str());
+	cerr << "  " << fields << ": " << total / samples.size() * unitScale << " " << unitName
+		 << " mean" << endl;
+}
+
+/**
+ * Time a call a fixed number of times, after a few untimed warm-up calls.
+ *
+ * @param iterations Number of timed calls.
+ * @param call Call to time.
+ * @return Time of each call, in seconds.
+ */
+vector<double> TimeCalls(size_t iterations, const function<void()>& call) {
+	for (size_t i = 0; i < min<size_t>(iterations, 10); ++i) {
+		call();
+	}
+	vector<double> samples;
+	samples.reserve(iterations);
+	for (size_t i = 0; i < iterations; ++i) {
+		double start = Now();
+		call();
+		samples.push_back(Now() - start);
+	}
+	return samples;
+}
+
+/**
+ * Time a run repeatedly, for at least MIN_CASE_SECONDS and between MIN_RUNS and MAX_RUNS times,
+ * after one untimed warm-up run.
+ *
+ * @param run Run to time.
+ * @return Time of each run, in seconds.
+ */
+vector<double> TimeRuns(const function<void()>& run) {
+	run();
+	vector<double> samples;
+	double caseStart = Now();
+	while (samples.size() < MIN_RUNS ||
+		   (samples.size() < MAX_RUNS && Now() - caseStart < MIN_CASE_SECONDS)) {
+		double start = Now();
+		run();
+		samples.push_back(Now() - start);
+	}
+	return samples;
+}
+
+/**
+ * Read the distinct items of the sample file, in the order first purchased.
+ *
+ * @return Item names, or FALLBACK_CATALOG if the sample file can't be read.
+ */
+vector<string> ReadCatalog() {
+	PurchaseIndex sample;
+	if (!sample.LoadFile(SAMPLE_FILE_NAME) || sample.ItemCount() == 0) {
+		return FALLBACK_CATALOG;
+	}
+	return sample.GetItems();
+}
+
+/**
+ * Write a purchase file of random items from a catalog, one per line.
+ *
+ * @param fileName File to write (or overwrite).
+ * @param catalog Items to choose from, uniformly.
+ * @param lineCount Number of lines.
+ * @return Size of the file in bytes, or 0 if it couldn't be written.
+ */
+unsigned long long GenerateFile(const string& fileName, const vector<string>& catalog,
+								unsigned long long lineCount) {
+	FILE* outputFile = fopen(fileName.c_str(), "wb");
+	if (outputFile == nullptr) {
+		return 0;
+	}
+
+	// xorshift64: fast and fixed, so every run benchmarks the same files.
+	unsigned long long state = 0x9E3779B97F4A7C15ULL;
+	string buffer;
+	unsigned long long bytes = 0;
+	for (unsigned long long line = 0; line < lineCount; ++line) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		buffer += catalog[state % catalog.size()];
+		buffer += '\n';
+		if (buffer.size() >= (1 << 20) || line + 1 == lineCount) {
+			if (fwrite(buffer.data(), 1, buffer.size(), outputFile) != buffer.size()) {
+				fclose(outputFile);
+				return 0;
+			}
+			bytes += buffer.size();
+			buffer.clear();
+		}
+	}
+	return (fclose(outputFile) == 0) ? bytes : 0;
+}
+
+/**
+ * python_call cases. Each PyInterface call runs on the PyExecutor's thread, inside one task, so
+ * only the call itself is timed.
+ *
+ * @param pyExecutor Executor whose PyInterface is benchmarked.
+ * @param emptyFileName An empty purchase file.
+ * @param iterations Calls per result.
+ */
+void BenchPythonCalls(PyExecutor& pyExecutor, const string& emptyFileName, size_t iterations) {
+	cerr << "python_call" << endl;
+	vector<string> itemNames(100, "Peas");
+
+	pyExecutor.Run([&](PyInterface& pyInterface) {
+		auto bench = [&](const string& name, const function<void()>& call) {
+			vector<double> samples = TimeCalls(iterations, call);
+			AddTimingResult("\"case\": \"python_call\", \"name\": " + JsonString(name), samples,
+							"us", 1e6);
+		};
+		bench("Call<int>() no arguments", [&] {
+			pyInterface.Call<int>("SummarizeEngineCounts");
+		});
+		bench("CallIntFunc(string)", [&] {
+			pyInterface.CallIntFunc("CountItems", emptyFileName);
+		});
+		bench("CallIntFunc(string, string)", [&] {
+			pyInterface.CallIntFunc("CountOneItem", emptyFileName, "Peas");
+		});
+		bench("Call<int>(string, string_view)", [&] {
+			pyInterface.Call<int>("CountOneItem", emptyFileName, string_view("Peas"));
+		});
+		bench("CallListFunc(string)", [&] {
+			pyInterface.CallListFunc("GetItems", emptyFileName);
+		});
+		bench("Call<map<string, int>>(string)", [&] {
+			pyInterface.Call<map<string, int>>("CountAllItems", emptyFileName);
+		});
+		bench("Call<vector<unsigned long long>>(string, vector<string>[100])", [&] {
+			pyInterface.Call<vector<unsigned long long>>("CountManyItems", emptyFileName,
+														 itemNames);
+		});
+		pyInterface.CacheResults("CountOneItem");
+		bench("Call<int>(string, string_view) cached", [&] {
+			pyInterface.Call<int>("CountOneItem", emptyFileName, string_view("Peas"));
+		});
+		pyInterface.CacheResults("CountOneItem", false);
+	}).get();
+
+	vector<double> samples = TimeCalls(iterations, [&] {
+		pyExecutor.Submit<int>("CountOneItem", emptyFileName, "Peas").get();
+	});
+	AddTimingResult("\"case\": \"python_call\", \"name\": \"PyExecutor::Submit<int>(string, string)\"",
+					samples, "us", 1e6);
+
+	PyWorkerPool pyWorkerPool(1);
+	samples = TimeCalls(iterations, [&] {
+		pyWorkerPool.Submit<int>("CountOneItem", emptyFileName, "Peas").get();
+	});
+	AddTimingResult(
+		"\"case\": \"python_call\", \"name\": \"PyWorkerPool::Submit<int>(string, string)\"",
+		samples, "us", 1e6);
+}
+
+/**
+ * menu_option cases for one input file and engine.
+ *
+ * @param pyExecutor Executor for the Python engine.
+ * @param inputName Name of the input in the results.
+ * @param inputFileName Purchase file to read.
+ * @param chartFileName Histogram file to write.
+ * @param useNativeEngine true for the native engine, false for PythonCode.py.
+ */
+void BenchMenuOptions(PyExecutor& pyExecutor, const string& inputName, const string& inputFileName,
+					  const string& chartFileName, bool useNativeEngine) {
+	UserMenu userMenu(vector<string>{ "List", "Exit" });
+	GrocerMenuFuncs menu(&pyExecutor, &userMenu, inputFileName, chartFileName);
+	menu.SetNativeEngine(useNativeEngine);
+
+	string fields = ", \"engine\": " + JsonString(useNativeEngine ? "native" : "python") +
+					", \"input\": " + JsonString(inputName);
+	NullBuffer nullBuffer;
+	streambuf* coutBuffer = cout.rdbuf(&nullBuffer);
+	streambuf* cinBuffer = cin.rdbuf();
+	vector<double> listSamples = TimeRuns([&] { menu.OptListItems(); });
+	vector<double> searchSamples = TimeRuns([&] {
+		// OptSearchItem ignores one character, then reads the item's name.
+		istringstream selection("\nPeas\n");
+		cin.rdbuf(selection.rdbuf());
+		menu.OptSearchItem();
+		cin.rdbuf(cinBuffer);
+	});
+	vector<double> chartSamples = TimeRuns([&] { menu.OptChartItems(); });
+	cout.rdbuf(coutBuffer);
+
+	AddTimingResult("\"case\": \"menu_option\", \"name\": \"OptListItems\"" + fields,
+					listSamples, "ms", 1e3);
+	AddTimingResult("\"case\": \"menu_option\", \"name\": \"OptSearchItem\"" + fields,
+					searchSamples, "ms", 1e3);
+	AddTimingResult("\"case\": \"menu_option\", \"name\": \"OptChartItems\"" + fields,
+					chartSamples, "ms", 1e3);
+}
+
+/**
+ * Add a count_throughput result.
+ *
+ * @param name What was timed.
+ * @param threads Threads used, 0 if not applicable.
+ * @param lineCount Lines in the file.
+ * @param bytes Bytes in the file.
+ * @param seconds Best time.
+ */
+void AddThroughputResult(const string& name, unsigned int threads, unsigned long long lineCount,
+						 unsigned long long bytes, double seconds) {
+	ostringstream json;
+	json << setprecision(6) << "{ \"case\": \"count_throughput\", \"name\": " << JsonString(name)
+		 << ", \"threads\": " << threads << ", \"lines\": " << lineCount << ", \"bytes\": "
+		 << bytes << ", \"seconds\": " << seconds << ", \"lines_per_second\": "
+		 << lineCount / seconds << ", \"mb_per_second\": " << bytes / seconds / 1e6 << " }";
+	g_results.push_back(json.str());
+	cerr << "  " << name << " (" << threads << " threads) " << lineCount << " lines: "
+		 << bytes / seconds / 1e6 << " MB/s" << endl;
+}
+
+/**
+ * count_throughput cases for one generated file.
+ *
+ * @param fileName Generated purchase file.
+ * @param lineCount Lines in the file.
+ * @param bytes Bytes in the file.
+ */
+void BenchCounting(const string& fileName, unsigned long long lineCount, unsigned long long bytes) {
+	// Fewer runs of big files; always at least two, so the first can warm the page cache.
+	size_t runs = static_cast<size_t>(max(2ULL, min(5ULL, 100000000ULL / max(lineCount, 1ULL))));
+	unsigned int hardwareThreads = max(thread::hardware_concurrency(), 1u);
+
+	for (unsigned int threads : { 1u, hardwareThreads }) {
+		PurchaseIndex index;
+		index.SetThreadCount(threads);
+		double best = 0;
+		for (size_t run = 0; run < runs; ++run) {
+			double start = Now();
+			index.LoadFile(fileName);
+			double seconds = Now() - start;
+			best = (run == 0) ? seconds : min(best, seconds);
+		}
+		AddThroughputResult("PurchaseIndex::LoadFile", threads, lineCount, bytes, best);
+		if (hardwareThreads == 1) {
+			break;
+		}
+	}
+
+	TopKSketch sketch;
+	double best = 0;
+	for (size_t run = 0; run < runs; ++run) {
+		sketch.Clear();
+		double start = Now();
+		sketch.AddFile(fileName);
+		double seconds = Now() - start;
+		best = (run == 0) ? seconds : min(best, seconds);
+	}
+	AddThroughputResult("TopKSketch::AddFile", 1, lineCount, bytes, best);
+}
+
+/**
+ * Make up a catalog of distinct names of four syllables, e.g. "Kobetima".
+ *
+ * @param nameCount Number of names, at most 100000000.
+ * @return Names, in no particular order.
+ */
+vector<string> GenerateNames(size_t nameCount) {
+	const string consonants = "bcdfghjklmnprstvwxyz";
+	const string vowels = "aeiou";
+	vector<string> names;
+	names.reserve(nameCount);
+	for (size_t i = 0; i < nameCount; ++i) {
+		// Spread the names over every syllable combination instead of taking the first ones.
+		unsigned long long code = (i * 2654435761ULL) % 100000000ULL;
+		string name;
+		for (int syllable = 0; syllable < 4; ++syllable) {
+			name += consonants[code % 100 / 5];
+			name += vowels[code % 5];
+			code /= 100;
+		}
+		name[0] = static_cast<char>(toupper(name[0]));
+		names.push_back(name);
+	}
+	return names;
+}
+
+/**
+ * item_search cases.
+ *
+ * @param nameCount Names in the catalog.
+ * @param iterations Searches per result.
+ */
+void BenchItemSearch(size_t nameCount, size_t iterations) {
+	cerr << "item_search" << endl;
+	vector<string> names = GenerateNames(nameCount);
+	ItemSearchIndex index;
+	double start = Now();
+	index.Build(names);
+	double buildSeconds = Now() - start;
+
+	ostringstream json;
+	json << setprecision(6) << "{ \"case\": \"item_search\", \"name\": \"Build\", \"items\": "
+		 << nameCount << ", \"seconds\": " << buildSeconds << " }";
+	g_results.push_back(json.str());
+	cerr << "  Build " << nameCount << " names: " << buildSeconds << " s" << endl;
+
+	string name = names[nameCount / 2];
+	string typo = name;
+	typo[typo.size() / 2] = (typo[typo.size() / 2] == 'q') ? 'z' : 'q';
+	vector<pair<string, string>> queries = {
+		{ "exact", name }, { "prefix", name.substr(0, 3) }, { "typo", typo }, { "missing", "Xyzzyq" }
+	};
+	for (const pair<string, string>& query : queries) {
+		size_t matchCount = 0;
+		vector<double> samples = TimeCalls(iterations, [&] {
+			matchCount = index.Search(query.second, 10).size();
+		});
+		AddTimingResult("\"case\": \"item_search\", \"name\": " + JsonString(query.first) +
+						", \"items\": " + to_string(nameCount) + ", \"matches\": " +
+						to_string(matchCount), samples, "us", 1e6);
+	}
+}
+
+/**
+ * One sharded_counter run: producer threads count purchases of random items into a
+ * ShardedCounter, optionally in receipts of RECEIPT_SIZE while another thread checks snapshots.
+ *
+ * @param threadCount Producer threads.
+ * @param increments Purchases to count in all.
+ * @param receipts true to count receipts as batches and check snapshots, false to count single
+ * purchases with no reader.
+ * @return false if a check failed.
+ */
+bool BenchShardedCounter(unsigned int threadCount, unsigned long long increments, bool receipts) {
+	ShardedCounter counter;
+	vector<uint32_t> itemIds;
+	for (int item = 0; item < 1000; ++item) {
+		itemIds.push_back(counter.Intern("Item" + to_string(item)));
+	}
+	vector<ShardedCounter::Writer> writers;
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		writers.push_back(counter.AddWriter());
+	}
+	unsigned long long perThread = increments / threadCount / RECEIPT_SIZE * RECEIPT_SIZE;
+
+	atomic<bool> writing(true);
+	bool consistent = true;
+	unsigned long long snapshots = 0;
+	thread reader([&] {
+		vector<unsigned long long> previous(itemIds.size(), 0);
+		while (receipts && writing.load()) {
+			vector<unsigned long long> counts = counter.Snapshot();
+			unsigned long long total = 0;
+			for (size_t id = 0; id < counts.size(); ++id) {
+				total += counts[id];
+				consistent = consistent && counts[id] >= previous[id];
+			}
+			consistent = consistent && total % RECEIPT_SIZE == 0;
+			previous = counts;
+			++snapshots;
+		}
+	});
+
+	double start = Now();
+	vector<thread> producers;
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		producers.emplace_back([&, i] {
+			ShardedCounter::Writer& writer = writers[i];
+			// xorshift64, seeded per thread.
+			unsigned long long state = 0x9E3779B97F4A7C15ULL * (i + 1);
+			for (unsigned long long done = 0; done < perThread; done += RECEIPT_SIZE) {
+				if (receipts) {
+					writer.BeginBatch();
+				}
+				for (size_t item = 0; item < RECEIPT_SIZE; ++item) {
+					state ^= state << 13;
+					state ^= state >> 7;
+					state ^= state << 17;
+					writer.Add(itemIds[state % itemIds.size()]);
+				}
+				if (receipts) {
+					writer.EndBatch();
+				}
+			}
+		});
+	}
+	for (thread& producer : producers) {
+		producer.join();
+	}
+	double seconds = Now() - start;
+	writing.store(false);
+	reader.join();
+
+	unsigned long long total = 0;
+	for (unsigned long long count : counter.Snapshot()) {
+		total += count;
+	}
+	consistent = consistent && total == perThread * threadCount;
+
+	ostringstream json;
+	json << setprecision(6) << "{ \"case\": \"sharded_counter\", \"name\": "
+		 << JsonString(receipts ? "receipts with snapshots" : "single purchases")
+		 << ", \"threads\": " << threadCount << ", \"increments\": " << total
+		 << ", \"seconds\": " << seconds << ", \"increments_per_second\": " << total / seconds
+		 << ", \"snapshots\": " << snapshots << ", \"snapshot_retries\": "
+		 << counter.GetSnapshotRetries() << ", \"consistent\": "
+		 << (consistent ? "true" : "false") << " }";
+	g_results.push_back(json.str());
+	cerr << "  " << (receipts ? "receipts with snapshots" : "single purchases") << " ("
+		 << threadCount << " threads): " << total / seconds / 1e6 << " M/s"
+		 << (consistent ? "" : " INCONSISTENT") << endl;
+	return consistent;
+}
+
+/**
+ * pipeline case for one number of sources and one queue size.
+ *
+ * @param laneFileNames Generated lane files; the first sourceCount are read.
+ * @param laneLines Lines in each lane file.
+ * @param sourceCount Number of sources.
+ * @param queueBlocks Blocks in the queue.
+ * @return false if a run didn't count every line.
+ */
+bool BenchPipeline(const vector<string>& laneFileNames, unsigned long long laneLines,
+				   size_t sourceCount, size_t queueBlocks) {
+	vector<string> sourceNames(laneFileNames.begin(), laneFileNames.begin() + sourceCount);
+	IngestPipeline pipeline;
+	pipeline.SetQueueBlocks(queueBlocks);
+	bool consistent = true;
+	IngestPipeline::Stats best;
+	for (size_t run = 0; run < 3; ++run) {
+		PurchaseIndex index;
+		consistent = pipeline.Run(sourceNames, index) && consistent;
+		unsigned long long total = 0;
+		for (unsigned long long count : index.GetCounts()) {
+			total += count;
+		}
+		consistent = consistent && total == laneLines * sourceCount;
+		if (run == 0 || pipeline.GetStats().seconds < best.seconds) {
+			best = pipeline.GetStats();
+		}
+	}
+
+	unsigned long long sourceWaits = 0;
+	double sourceWaitSeconds = 0;
+	unsigned long long bytes = 0;
+	for (const IngestPipeline::SourceStats& source : best.sources) {
+		sourceWaits += source.waits;
+		sourceWaitSeconds += source.waitSeconds;
+		bytes += source.bytes;
+	}
+	ostringstream json;
+	json << setprecision(6) << "{ \"case\": \"pipeline\", \"sources\": " << sourceCount
+		 << ", \"queue_blocks\": " << best.queueBlocks << ", \"lines\": " << best.lines
+		 << ", \"seconds\": " << best.seconds << ", \"lines_per_second\": "
+		 << best.lines / best.seconds << ", \"mb_per_second\": " << bytes / best.seconds / 1e6
+		 << ", \"source_waits\": " << sourceWaits << ", \"source_wait_seconds\": "
+		 << sourceWaitSeconds << ", \"aggregator_waits\": " << best.waits
+		 << ", \"aggregator_wait_seconds\": " << best.waitSeconds << ", \"mean_queue_depth\": "
+		 << best.meanQueueDepth << ", \"max_queue_depth\": " << best.maxQueueDepth
+		 << ", \"consistent\": " << (consistent ? "true" : "false") << " }";
+	g_results.push_back(json.str());
+	cerr << "  " << sourceCount << " sources, queue of " << best.queueBlocks << ": "
+		 << best.lines / best.seconds / 1e6 << " M lines/s, sources waited " << sourceWaits
+		 << " times, aggregator " << best.waits << (consistent ? "" : " INCONSISTENT") << endl;
+	return consistent;
+}
+
+/**
+ * Parse the list of an --only option.
+ *
+ * @param list Case names separated by commas, e.g. "item_search,pipeline".
+ *
+ * @return The names, or an empty vector if any isn't in CASE_NAMES or there are none.
+ */
+vector<string> ParseCases(const string& list) {
+	vector<string> cases;
+	istringstream listStream(list);
+	string caseName;
+	while (getline(listStream, caseName, ',')) {
+		if (find(CASE_NAMES.begin(), CASE_NAMES.end(), caseName) == CASE_NAMES.end()) {
+			return {};
+		}
+		cases.push_back(caseName);
+	}
+	return cases;
+}
+
+int main(int argc, char* argv[]) {
+	/* The PyWorkerPool case starts this program as a Python worker process. */
+	if (argc == 3 && strncmp(argv[1], PyWorkerPool::WORKER_OPTION,
+							 strlen(PyWorkerPool::WORKER_OPTION)) == 0) {
+		return PyWorkerPool::RunWorker(argv[1] + strlen(PyWorkerPool::WORKER_OPTION), argv[2]);
+	}
+
+	unsigned long long maxLines = 100000000;
+	size_t iterations = 10000;
+	string tempDir = ".";
+	bool skipPython = false;
+	size_t searchItems = 1000000;
+	unsigned long long increments = 100000000;
+	unsigned long long pipelineLines = 10000000;
+	vector<string> cases = CASE_NAMES;
+	for (int i = 1; i < argc; ++i) {
+		string option = argv[i];
+		try {
+			if (option.compare(0, 12, "--max-lines=") == 0) {
+				maxLines = stoull(option.substr(12));
+			}
+			else if (option.compare(0, 13, "--iterations=") == 0) {
+				iterations = max<size_t>(stoul(option.substr(13)), 1);
+			}
+			else if (option.compare(0, 11, "--temp-dir=") == 0) {
+				tempDir = option.substr(11);
+			}
+			else if (option.compare(0, 15, "--search-items=") == 0) {
+				searchItems = max<size_t>(min<size_t>(stoul(option.substr(15)), 100000000), 1);
+			}
+			else if (option.compare(0, 13, "--increments=") == 0) {
+				increments = max<unsigned long long>(stoull(option.substr(13)), 1);
+			}
+			else if (option.compare(0, 17, "--pipeline-lines=") == 0) {
+				pipelineLines = max<unsigned long long>(stoull(option.substr(17)),
+														PIPELINE_MAX_SOURCES);
+			}
+			else if (option == "--skip-python") {
+				skipPython = true;
+			}
+			else if (option.compare(0, 7, "--only=") == 0) {
+				cases = ParseCases(option.substr(7));
+				if (cases.empty()) {
+					throw invalid_argument(option);
+				}
+			}
+			else {
+				throw invalid_argument(option);
+			}
+		}
+		// stoul throws invalid_argument or out_of_range for a bad number.
+		catch (logic_error& excpt) {
+			cerr << "Didn't recognize option " << option << "." << endl
+				 << "Usage: GrocerBench [--max-lines=N] [--iterations=N] [--temp-dir=DIR] "
+				 << "[--search-items=N] [--increments=N] [--pipeline-lines=N] [--skip-python] "
+				 << "[--only=CASE[,CASE...]]" << endl << "CASE is one of:";
+			for (const string& caseName : CASE_NAMES) {
+				cerr << " " << caseName;
+			}
+			cerr << endl;
+			return 2;
+		}
+	}
+
+	auto selected = [&cases](const string& caseName) {
+		return find(cases.begin(), cases.end(), caseName) != cases.end();
+	};
+	vector<string> catalog = ReadCatalog();
+
+	if (selected("python_call") || selected("menu_option")) {
+		string emptyFileName = tempDir + "/grocerbench-empty.txt";
+		string mediumFileName = tempDir + "/grocerbench-100000.txt";
+		string chartFileName = tempDir + "/grocerbench-frequency.dat";
+		GenerateFile(emptyFileName, catalog, 0);
+		if (GenerateFile(mediumFileName, catalog, 100000) == 0) {
+			cerr << "Couldn't write to " << tempDir << "." << endl;
+			return 1;
+		}
+
+		PyExecutor pyExecutor;
+		if (!skipPython && selected("python_call")) {
+			// Python's own output would swamp the console; it isn't part of what's measured.
+			pyExecutor.Run([](PyInterface&) {
+				PyRun_SimpleString("import os, sys\nsys.stdout = open(os.devnull, 'w')");
+			}).get();
+			BenchPythonCalls(pyExecutor, emptyFileName, iterations);
+		}
+
+		if (selected("menu_option")) {
+			cerr << "menu_option" << endl;
+			for (bool useNativeEngine : { true, false }) {
+				if (!useNativeEngine && skipPython) {
+					continue;
+				}
+				BenchMenuOptions(pyExecutor, "sample", SAMPLE_FILE_NAME, chartFileName,
+								 useNativeEngine);
+				BenchMenuOptions(pyExecutor, "generated-100000", mediumFileName, chartFileName,
+								 useNativeEngine);
+			}
+		}
+		remove(emptyFileName.c_str());
+		remove(mediumFileName.c_str());
+		remove(chartFileName.c_str());
+	}
+
+	if (selected("count_throughput")) {
+		cerr << "count_throughput" << endl;
+		for (unsigned long long lineCount = 1000; lineCount <= maxLines; lineCount *= 10) {
+			string fileName = tempDir + "/grocerbench-" + to_string(lineCount) + ".txt";
+			unsigned long long bytes = GenerateFile(fileName, catalog, lineCount);
+			if (bytes == 0) {
+				cerr << "Couldn't write " << fileName << "." << endl;
+				break;
+			}
+			BenchCounting(fileName, lineCount, bytes);
+			remove(fileName.c_str());
+		}
+	}
+
+	if (selected("item_search")) {
+		BenchItemSearch(searchItems, iterations);
+	}
+
+	bool consistent = true;
+	if (selected("sharded_counter")) {
+		cerr << "sharded_counter" << endl;
+		vector<unsigned int> threadCounts = { 1, 2, 4, 8, 16 };
+		if (thread::hardware_concurrency() > 16) {
+			threadCounts.push_back(thread::hardware_concurrency());
+		}
+		for (bool receipts : { false, true }) {
+			for (unsigned int threads : threadCounts) {
+				consistent = BenchShardedCounter(threads, increments, receipts) && consistent;
+			}
+		}
+	}
+
+	if (selected("pipeline")) {
+		cerr << "pipeline" << endl;
+		unsigned long long laneLines = pipelineLines / PIPELINE_MAX_SOURCES;
+		vector<string> laneFileNames;
+		for (size_t lane = 0; lane < PIPELINE_MAX_SOURCES; ++lane) {
+			string fileName = tempDir + "/grocerbench-lane" + to_string(lane) + ".txt";
+			if (GenerateFile(fileName, catalog, laneLines) == 0) {
+				cerr << "Couldn't write " << fileName << "." << endl;
+				break;
+			}
+			laneFileNames.push_back(fileName);
+		}
+		if (laneFileNames.size() == PIPELINE_MAX_SOURCES) {
+			for (size_t queueBlocks : { PIPELINE_SMALL_QUEUE,
+										IngestPipeline::DEFAULT_QUEUE_BLOCKS }) {
+				for (size_t sources = 1; sources <= PIPELINE_MAX_SOURCES; sources *= 2) {
+					consistent = BenchPipeline(laneFileNames, laneLines, sources, queueBlocks) &&
+								 consistent;
+				}
+			}
+		}
+		for (const string& fileName : laneFileNames) {
+			remove(fileName.c_str());
+		}
+	}
+
+	cout << "{ \"benchmark\": \"GrocerBench\", \"version\": 1, \"hardware_threads\": "
+		 << thread::hardware_concurrency() << ", \"results\": [" << endl;
+	for (size_t i = 0; i < g_results.size(); ++i) {
+		cout << "  " << g_results[i] << (i + 1 < g_results.size() ? "," : "") << endl;
+	}
+	cout << "] }" << endl;
+	return consistent ? 0 : 1;
+}
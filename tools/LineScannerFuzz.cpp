@@ -0,0 +1,234 @@
+/**
+ * Corner Grocer Tracking
+ * LineScannerFuzz.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Fuzz test for LineScanner: splits and trims random texts with every instruction set the CPU
+ * has (see LineScanner::SetIsa()) and checks the SIMD versions return exactly the scalar
+ * version's lines. Not part of the Visual Studio project: it has its own main(). Build and run
+ * from the repository root:
+ *   g++ -std=c++17 -O2 -I. tools/LineScannerFuzz.cpp LineScanner.cpp -o LineScannerFuzz
+ *   ./LineScannerFuzz --iterations=200000
+ *
+ * Texts are built to hit the SIMD edge cases: runs of every byte str.strip() treats as whitespace
+ * and of bytes just outside that set (\x1b, \x7f, bytes over \x7f), lines just shorter and longer
+ * than 16 and 32 bytes, and texts starting at every alignment within a buffer. Each text is read
+ * with NextBatch() in random batch sizes, and trimmed as a whole with Trim(). Lines must match in
+ * content and also in position within the text.
+ *
+ * Options:
+ * --iterations=N   Texts to test. Default 100000.
+ * --seed=N         Seed for the texts. Default 1; the same seed tests the same texts.
+ *
+ * Prints the instruction sets tested and "ok". On a mismatch, prints the text (escaped), the
+ * instruction set, and both results, and exits with status 1.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include "LineScanner.h"
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Bytes texts are made of: whitespace to str.strip(), near misses, and ordinary text. */
+const string ALPHABET = string(" \t\n\r\v\f\x1c\x1d\x1e\x1f", 10) + "\x1b\x7f\x80\xff" + "ab";
+/* Longest text, and longest offset of a text within its buffer. */
+const size_t MAX_TEXT_SIZE = 300;
+const size_t MAX_OFFSET = 64;
+/* Largest NextBatch() size tried. */
+const size_t MAX_BATCH_LINES = 40;
+
+/**
+ * @param text Any bytes.
+ * @return text with \n, \\, and unprintable bytes escaped, for printing.
+ */
+string Escape(string_view text) {
+	string escaped;
+	char hex[8];
+	for (char c : text) {
+		unsigned char byte = static_cast<unsigned char>(c);
+		if (c == '\\') {
+			escaped += "\\\\";
+		}
+		else if (byte < 0x20 || byte >= 0x7f) {
+			snprintf(hex, sizeof(hex), "\\x%02x", byte);
+			escaped += hex;
+		}
+		else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+/**
+ * Make a random text.
+ *
+ * @param random Random number generator.
+ * @return Text of 0 to MAX_TEXT_SIZE bytes.
+ */
+string MakeText(mt19937_64& random) {
+	string text;
+	size_t size = random() % (MAX_TEXT_SIZE + 1);
+	int style = static_cast<int>(random() % 3);
+	while (text.size() < size) {
+		if (style == 0) {
+			// Any byte of the alphabet.
+			text += ALPHABET[random() % ALPHABET.size()];
+		}
+		else if (style == 1) {
+			// Lines of around 16 or 32 bytes, with whitespace padding.
+			size_t lineSize = (random() % 2 == 0 ? 16 : 32) + random() % 5 - 2;
+			string line(lineSize, 'x');
+			for (size_t i = 0; i < lineSize; ++i) {
+				if (random() % 4 == 0) {
+					line[i] = ALPHABET[random() % ALPHABET.size()];
+				}
+			}
+			text += line + '\n';
+		}
+		else {
+			// Long runs of whitespace between short words.
+			text += string(random() % 40, ALPHABET[random() % 10]);
+			text += (random() % 3 == 0) ? "\n" : "ab";
+		}
+	}
+	text.resize(size);
+	return text;
+}
+
+/**
+ * Split a text into lines with one instruction set.
+ *
+ * @param text Text to split.
+ * @param isa Instruction set to use.
+ * @param batchLines Lines per NextBatch() call.
+ * @return Each line, as returned (pointing into text).
+ */
+vector<string_view> Split(string_view text, LineScanner::Isa isa, size_t batchLines) {
+	LineScanner::SetIsa(isa);
+	LineScanner scanner(text);
+	vector<string_view> batch(batchLines);
+	vector<string_view> lines;
+	size_t lineCount;
+	while ((lineCount = scanner.NextBatch(batch.data(), batchLines)) > 0) {
+		lines.insert(lines.end(), batch.begin(), batch.begin() + lineCount);
+	}
+	return lines;
+}
+
+/**
+ * @param a Lines from one instruction set.
+ * @param b Lines from another.
+ * @return true if the lines are the same bytes at the same places.
+ */
+bool SameLines(const vector<string_view>& a, const vector<string_view>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i] != b[i] || (!a[i].empty() && a[i].data() != b[i].data())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Print a mismatch between the scalar result and an instruction set's.
+ *
+ * @param text Text that was scanned.
+ * @param isa Instruction set that disagreed.
+ * @param expected Scalar lines.
+ * @param actual The instruction set's lines.
+ */
+void PrintMismatch(string_view text, LineScanner::Isa isa, const vector<string_view>& expected,
+				   const vector<string_view>& actual) {
+	cerr << "Mismatch with " << LineScanner::IsaName(isa) << " on \"" << Escape(text) << "\""
+		 << endl;
+	for (const auto& result : { make_pair("scalar", &expected), make_pair("simd", &actual) }) {
+		cerr << "  " << result.first << ":";
+		for (string_view line : *result.second) {
+			cerr << " [" << (line.data() - text.data()) << "] \"" << Escape(line) << "\"";
+		}
+		cerr << endl;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	unsigned long long iterations = 100000;
+	unsigned long long seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		string option = argv[i];
+		try {
+			if (option.compare(0, 13, "--iterations=") == 0) {
+				iterations = stoull(option.substr(13));
+			}
+			else if (option.compare(0, 7, "--seed=") == 0) {
+				seed = stoull(option.substr(7));
+			}
+			else {
+				throw invalid_argument(option);
+			}
+		}
+		// stoull throws invalid_argument or out_of_range for a bad number.
+		catch (logic_error& excpt) {
+			cerr << "Didn't recognize option " << option << "." << endl
+				 << "Usage: LineScannerFuzz [--iterations=N] [--seed=N]" << endl;
+			return 2;
+		}
+	}
+
+	// SetIsa() can't go past what the CPU has, so only those are worth testing.
+	vector<LineScanner::Isa> simdIsas;
+	for (LineScanner::Isa isa : { LineScanner::Isa::Sse2, LineScanner::Isa::Avx2 }) {
+		if (isa <= LineScanner::DetectIsa()) {
+			simdIsas.push_back(isa);
+		}
+	}
+	cout << "Testing scalar";
+	for (LineScanner::Isa isa : simdIsas) {
+		cout << " against " << LineScanner::IsaName(isa);
+	}
+	cout << " (seed " << seed << ")." << endl;
+
+	mt19937_64 random(seed);
+	string buffer;
+	for (unsigned long long iteration = 0; iteration < iterations; ++iteration) {
+		string text = MakeText(random);
+		size_t offset = random() % (MAX_OFFSET + 1);
+		buffer.assign(offset, 'x');
+		buffer += text;
+		string_view view = string_view(buffer).substr(offset);
+
+		vector<string_view> expected = Split(view, LineScanner::Isa::Scalar,
+											 1 + random() % MAX_BATCH_LINES);
+		LineScanner::SetIsa(LineScanner::Isa::Scalar);
+		string_view expectedTrim = LineScanner::Trim(view);
+
+		for (LineScanner::Isa isa : simdIsas) {
+			vector<string_view> actual = Split(view, isa, 1 + random() % MAX_BATCH_LINES);
+			if (!SameLines(expected, actual)) {
+				PrintMismatch(view, isa, expected, actual);
+				return 1;
+			}
+			string_view actualTrim = LineScanner::Trim(view);
+			if (!SameLines({ expectedTrim }, { actualTrim })) {
+				PrintMismatch(view, isa, { expectedTrim }, { actualTrim });
+				cerr << "  (in Trim())" << endl;
+				return 1;
+			}
+		}
+	}
+
+	cout << "ok: " << iterations << " texts." << endl;
+	return 0;
+}
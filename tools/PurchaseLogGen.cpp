@@ -0,0 +1,454 @@
+/**
+ * Corner Grocer Tracking
+ * PurchaseLogGen.cpp
+ *
+ *    Author: James Furman
+ *    Date: 2026-10-17
+ *
+ * Writes synthetic purchase files, one item per line like CS210_Project_Three_Input_File.txt,
+ * of any size, for load testing the scan paths. Not part of the Visual Studio project: it has its
+ * own main() and needs nothing else from the repository. Build from the repository root:
+ *   g++ -std=c++17 -O2 tools/PurchaseLogGen.cpp -o PurchaseLogGen
+ * E.g. a 10 GB file with Zipf-distributed purchases of 5000 items and some messy lines:
+ *   ./PurchaseLogGen --bytes=10G --items=5000 --whitespace=0.05 --crlf=0.01 --out=big.txt
+ *
+ * Items:
+ * - The catalog is read from a purchase file (default CS210_Project_Three_Input_File.txt), and
+ * ranked by how often each item appears in it, most popular first (ties in first-seen order).
+ * - --items=N takes the first N ranked items, or adds numbered variants ("Peas 2", "Peas 3", ...)
+ * if N is more than the catalog has.
+ * - The item of rank k is bought with probability proportional to 1 / k^s, for --skew=s: 0 is
+ * uniform, 1 is classic Zipf, and larger values concentrate purchases on the top few items.
+ * Items are drawn with Vose's alias method, so each line costs O(1) whatever the item count.
+ *
+ * Noise and structure, all off by default:
+ * - --whitespace=P: fraction of lines given 1-3 trailing spaces or tabs.
+ * - --crlf=P: fraction of lines ended with "\r\n" instead of "\n" (1 for a Windows file).
+ * - --transactions=N: group lines into transactions of 1 to 2N-1 items (N on average), each
+ * followed by a --separator line (default empty).
+ * - --timestamps: start each line with an ISO 8601 UTC time and a tab. Times start at
+ * 2026-01-01T08:00:00 and advance 0-59 seconds per transaction (or per line).
+ * The engines read every line as an item name, so separators and timestamps show up as extra
+ * items; they are for testing readers that expect them.
+ *
+ * Output is the same for the same options and --seed. Lines are built in a buffer and written
+ * with large fwrite() calls, so generation normally runs at the speed of the disk.
+ *
+ * Comments in Javadoc style for compatibility with various C++ API tools.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+using namespace std;
+
+/* Default catalog, shipped with the app. */
+const string SAMPLE_FILE_NAME = "CS210_Project_Three_Input_File.txt";
+/* Size of each fwrite(). */
+const size_t WRITE_BUFFER_SIZE = 4 << 20;
+/* Time of the first timestamp: 2026-01-01T08:00:00Z. */
+const time_t FIRST_TIMESTAMP = 1767254400;
+/* Characters used for trailing whitespace noise. */
+const char NOISE_CHARS[] = { ' ', ' ', ' ', '\t' };
+
+const char* USAGE_MESSAGE =
+	"Usage: PurchaseLogGen [--lines=N | --bytes=N[K|M|G]] [--out=FILE] [--catalog=FILE]\n"
+	"                      [--items=N] [--skew=S] [--seed=N] [--whitespace=P] [--crlf=P]\n"
+	"                      [--transactions=N] [--separator=TEXT] [--timestamps]\n"
+	"Default: 1000000 lines to standard output, the sample file's items, skew 1, seed 1.\n";
+
+/* splitmix64: small, fast, and the same everywhere, so a seed always gives the same file. */
+class SplitMix64 {
+public:
+	SplitMix64(uint64_t seed) {
+		m_state = seed;
+	}
+
+	uint64_t Next() {
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	/* True with probability fraction, which is 0 to 1. */
+	bool Chance(double fraction) {
+		return (Next() >> 11) * (1.0 / 9007199254740992.0) < fraction;
+	}
+
+private:
+	uint64_t m_state;
+};
+
+/* Vose's alias table: draws index i with probability weights[i] / sum(weights), in O(1). */
+class AliasTable {
+public:
+	AliasTable(const vector<double>& weights);
+
+	/**
+	 * @param random 64 random bits. The high half picks a column, the low half decides between
+	 * the column and its alias.
+	 * @return Index drawn.
+	 */
+	uint32_t Draw(uint64_t random) const {
+		const Column& column = m_columns[((random >> 32) * m_columns.size()) >> 32];
+		// Select without a branch: skewed tables make the outcome hard to predict.
+		uint32_t keep = static_cast<uint32_t>(0) - static_cast<uint32_t>(
+			static_cast<uint32_t>(random) < column.threshold);
+		return (column.index & keep) | (column.alias & ~keep);
+	}
+
+private:
+	struct Column {
+		uint64_t threshold;		// Keep the column if the low 32 bits are below this.
+		uint32_t index;			// The column's own index.
+		uint32_t alias;			// Index used otherwise.
+	};
+
+	vector<Column> m_columns;
+};
+
+/**
+ * Constructor. Builds the table in O(n).
+ *
+ * @param weights Relative probability of each index. At least one, all positive.
+ */
+AliasTable::AliasTable(const vector<double>& weights) {
+	size_t count = weights.size();
+	double total = 0;
+	for (double weight : weights) {
+		total += weight;
+	}
+
+	// Scale so the average column holds 1; split columns into under- and over-full.
+	vector<double> scaled(count);
+	vector<uint32_t> small;
+	vector<uint32_t> large;
+	for (size_t i = 0; i < count; ++i) {
+		scaled[i] = weights[i] * count / total;
+		(scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+	}
+
+	// Top up each under-full column from an over-full one, which becomes its alias.
+	m_columns.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		m_columns[i] = { 1ULL << 32, static_cast<uint32_t>(i), static_cast<uint32_t>(i) };
+	}
+	while (!small.empty() && !large.empty()) {
+		uint32_t under = small.back();
+		small.pop_back();
+		uint32_t over = large.back();
+		m_columns[under].threshold = static_cast<uint64_t>(scaled[under] * 4294967296.0);
+		m_columns[under].alias = over;
+		scaled[over] -= 1.0 - scaled[under];
+		if (scaled[over] < 1.0) {
+			large.pop_back();
+			small.push_back(over);
+		}
+	}
+	// Whatever is left is full to within rounding, and keeps threshold 2^32 (always itself).
+}
+
+/**
+ * Read a catalog from a purchase file and rank it by popularity.
+ *
+ * @param fileName Purchase file, one item per line. Surrounding whitespace and blank lines are
+ * ignored.
+ * @param catalog Set to the distinct items, most often purchased first, ties in first-seen order.
+ * @return false if the file couldn't be read or has no items.
+ */
+bool ReadCatalog(const string& fileName, vector<string>& catalog) {
+	ifstream inputFile(fileName, ios::binary);
+	if (!inputFile.is_open()) {
+		return false;
+	}
+
+	const char* whitespace = " \t\n\v\f\r";
+	map<string, size_t> itemIndexes;
+	vector<pair<string, unsigned long long>> items;
+	string line;
+	while (getline(inputFile, line)) {
+		size_t first = line.find_first_not_of(whitespace);
+		if (first == string::npos) {
+			continue;
+		}
+		string item = line.substr(first, line.find_last_not_of(whitespace) - first + 1);
+		auto found = itemIndexes.emplace(item, items.size());
+		if (found.second) {
+			items.push_back({ item, 0 });
+		}
+		++items[found.first->second].second;
+	}
+
+	stable_sort(items.begin(), items.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+	});
+	catalog.clear();
+	for (const auto& item : items) {
+		catalog.push_back(item.first);
+	}
+	return !catalog.empty();
+}
+
+/**
+ * Parse a count with an optional K, M, or G (binary) suffix.
+ *
+ * @param text E.g. "250000", "64M", or "10G".
+ * @return The count. Throws invalid_argument or out_of_range if it isn't one.
+ */
+unsigned long long ParseSize(const string& text) {
+	size_t used;
+	unsigned long long size = stoull(text, &used);
+	string suffix = text.substr(used);
+	int shift = (suffix.empty()) ? 0 : (suffix == "K" || suffix == "k") ? 10 :
+				(suffix == "M" || suffix == "m") ? 20 : (suffix == "G" || suffix == "g") ? 30 : -1;
+	if (shift < 0 || (size << shift) >> shift != size) {
+		throw invalid_argument(text);
+	}
+	return size << shift;
+}
+
+/**
+ * Parse a fraction from 0 to 1.
+ *
+ * @param text E.g. "0.05".
+ * @return The fraction. Throws invalid_argument or out_of_range if it isn't one.
+ */
+double ParseFraction(const string& text) {
+	double fraction = stod(text);
+	if (!(fraction >= 0.0 && fraction <= 1.0)) {
+		throw out_of_range(text);
+	}
+	return fraction;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned long long maxLines = 0;
+	unsigned long long maxBytes = 0;
+	string outputFileName;
+	string catalogFileName = SAMPLE_FILE_NAME;
+	size_t itemCount = 0;
+	double skew = 1.0;
+	uint64_t seed = 1;
+	double whitespaceFraction = 0;
+	double crlfFraction = 0;
+	unsigned long long transactionSize = 0;
+	string separator;
+	bool useTimestamps = false;
+
+	for (int i = 1; i < argc; ++i) {
+		string option = argv[i];
+		size_t equals = option.find('=');
+		string name = option.substr(0, equals);
+		string value = (equals == string::npos) ? "" : option.substr(equals + 1);
+		try {
+			if (name == "--lines") {
+				maxLines = ParseSize(value);
+			}
+			else if (name == "--bytes") {
+				maxBytes = ParseSize(value);
+			}
+			else if (name == "--out") {
+				outputFileName = value;
+			}
+			else if (name == "--catalog") {
+				catalogFileName = value;
+			}
+			else if (name == "--items") {
+				itemCount = static_cast<size_t>(ParseSize(value));
+			}
+			else if (name == "--skew") {
+				skew = stod(value);
+				if (!(skew >= 0.0 && skew <= 100.0)) {
+					throw out_of_range(value);
+				}
+			}
+			else if (name == "--seed") {
+				seed = stoull(value);
+			}
+			else if (name == "--whitespace") {
+				whitespaceFraction = ParseFraction(value);
+			}
+			else if (name == "--crlf") {
+				crlfFraction = ParseFraction(value);
+			}
+			else if (name == "--transactions") {
+				transactionSize = ParseSize(value);
+			}
+			else if (name == "--separator") {
+				separator = value;
+			}
+			else if (option == "--timestamps") {
+				useTimestamps = true;
+			}
+			else {
+				throw invalid_argument(option);
+			}
+		}
+		// stoull and stod throw invalid_argument or out_of_range for a bad number.
+		catch (logic_error& excpt) {
+			cerr << "Didn't recognize option " << option << "." << endl << USAGE_MESSAGE;
+			return 2;
+		}
+	}
+	if (maxLines == 0 && maxBytes == 0) {
+		maxLines = 1000000;
+	}
+	if (itemCount > 0xFFFFFFFFULL) {
+		cerr << "--items must be less than 2^32." << endl;
+		return 2;
+	}
+
+	vector<string> catalog;
+	if (!ReadCatalog(catalogFileName, catalog)) {
+		cerr << "Couldn't read any items from " << catalogFileName << "." << endl;
+		return 1;
+	}
+	if (itemCount == 0) {
+		itemCount = catalog.size();
+	}
+	size_t catalogSize = catalog.size();
+	catalog.resize(min(itemCount, catalogSize));
+	for (size_t i = catalogSize; i < itemCount; ++i) {
+		catalog.push_back(catalog[i % catalogSize] + " " + to_string(i / catalogSize + 1));
+	}
+
+	vector<double> weights(itemCount);
+	for (size_t rank = 0; rank < itemCount; ++rank) {
+		weights[rank] = pow(static_cast<double>(rank + 1), -skew);
+	}
+	AliasTable itemTable(weights);
+
+	FILE* outputFile = stdout;
+	if (!outputFileName.empty()) {
+		outputFile = fopen(outputFileName.c_str(), "wb");
+		if (outputFile == nullptr) {
+			cerr << "Couldn't open " << outputFileName << " for writing." << endl;
+			return 1;
+		}
+	}
+#ifdef _WIN32
+	else {
+		// Otherwise Windows would turn every "\n" into "\r\n".
+		_setmode(_fileno(stdout), _O_BINARY);
+	}
+#endif
+
+	char timestampText[32] = "";
+	size_t timestampLength = 0;
+
+	// Items are copied into lines a whole slot at a time: one fixed-size copy is faster than
+	// copying each item's exact length, which varies unpredictably from line to line.
+	size_t slotSize = 16;
+	for (const string& item : catalog) {
+		slotSize = max(slotSize, (item.size() + 15) & ~static_cast<size_t>(15));
+	}
+	vector<char> itemText(slotSize * itemCount);
+	vector<size_t> itemLengths(itemCount);
+	for (size_t i = 0; i < itemCount; ++i) {
+		memcpy(&itemText[i * slotSize], catalog[i].data(), catalog[i].size());
+		itemLengths[i] = catalog[i].size();
+	}
+
+	// Longest possible line: timestamp, slot or separator, noise, and "\r\n".
+	size_t maxLineLength = sizeof(timestampText) + max(slotSize, separator.size()) + 3 + 2;
+
+	double startTime = chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	SplitMix64 random(seed);
+	vector<char> buffer(WRITE_BUFFER_SIZE + maxLineLength);
+	size_t bufferUsed = 0;
+	unsigned long long lineCount = 0;
+	unsigned long long byteCount = 0;
+	unsigned long long transactionLeft = 0;
+	time_t timestamp = FIRST_TIMESTAMP;
+	bool writeFailed = false;
+
+	// Appends one line, unless it would go past --bytes. Returns false when the file is done.
+	auto appendLine = [&](const char* text, size_t textLength, size_t copyLength) {
+		size_t ending = (crlfFraction > 0 && random.Chance(crlfFraction)) ? 2 : 1;
+		size_t noise = (whitespaceFraction > 0 && random.Chance(whitespaceFraction)) ?
+			1 + random.Next() % 3 : 0;
+		size_t length = timestampLength + textLength + noise + ending;
+		if ((maxLines > 0 && lineCount >= maxLines) ||
+			(maxBytes > 0 && byteCount + length > maxBytes)) {
+			return false;
+		}
+
+		char* line = buffer.data() + bufferUsed;
+		memcpy(line, timestampText, timestampLength);
+		line += timestampLength;
+		memcpy(line, text, copyLength);
+		line += textLength;
+		for (size_t i = 0; i < noise; ++i) {
+			*line++ = NOISE_CHARS[random.Next() % sizeof(NOISE_CHARS)];
+		}
+		if (ending == 2) {
+			*line++ = '\r';
+		}
+		*line = '\n';
+		bufferUsed += length;
+		++lineCount;
+		byteCount += length;
+
+		if (bufferUsed >= WRITE_BUFFER_SIZE) {
+			writeFailed = fwrite(buffer.data(), 1, bufferUsed, outputFile) != bufferUsed;
+			bufferUsed = 0;
+		}
+		return !writeFailed;
+	};
+
+	while (true) {
+		if (transactionLeft == 0 && (transactionSize > 0 || useTimestamps)) {
+			timestamp += static_cast<time_t>(random.Next() % 60);
+			if (useTimestamps) {
+				timestampLength = strftime(timestampText, sizeof(timestampText),
+										   "%Y-%m-%dT%H:%M:%S\t", gmtime(&timestamp));
+			}
+			transactionLeft = (transactionSize > 0) ? 1 + random.Next() % (2 * transactionSize - 1)
+													: 1;
+		}
+		uint32_t item = itemTable.Draw(random.Next());
+		if (!appendLine(&itemText[item * slotSize], itemLengths[item], slotSize)) {
+			break;
+		}
+		if (transactionLeft > 0 && --transactionLeft == 0 && transactionSize > 0 &&
+			!appendLine(separator.data(), separator.size(), separator.size())) {
+			break;
+		}
+	}
+
+	if (!writeFailed && bufferUsed > 0) {
+		writeFailed = fwrite(buffer.data(), 1, bufferUsed, outputFile) != bufferUsed;
+	}
+	if (fflush(outputFile) != 0 || writeFailed) {
+		cerr << "Couldn't write " << (outputFileName.empty() ? "to standard output" : outputFileName)
+			 << "." << endl;
+		return 1;
+	}
+	if (outputFile != stdout) {
+		fclose(outputFile);
+	}
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count() -
+					 startTime;
+	cerr << "Wrote " << lineCount << " lines, " << byteCount << " bytes, " << itemCount
+		 << " items in " << seconds << " s (" << byteCount / max(seconds, 1e-9) / 1e6 << " MB/s)."
+		 << endl;
+	return 0;
+}
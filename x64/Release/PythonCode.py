@@ -125,3 +125,68 @@ def GetItems(filenameStr):
             itemsList.append(item)
     
     return itemsList
+
+"""
+Reads items from a file (as other functions) and returns a dict mapping each item to the number
+of times it occurs, so every count can be fetched in one call (e.g. with 
+PyInterface::Call<map<string, int>>). Counts in one pass rather than with list.count().
+"""
+def CountAllItems(filenameStr):
+    f = open(filenameStr, 'r')
+    purchasedList = f.readlines()
+    f.close()
+
+    itemCounts = {}
+    for item in purchasedList:
+        item = item.strip()
+        itemCounts[item] = itemCounts.get(item, 0) + 1
+
+    return itemCounts
+
+"""
+Takes the name of a file to read (as other functions) and a list of strings of items to search 
+for. Counts every listed item in one pass over the file and returns a list of ints, the number of 
+times each listed item occurs, in the order listed. Use instead of calling CountOneItem once per
+item, which rereads the file each time.
+"""
+def CountManyItems(filenameStr, itemSearches):
+    f = open(filenameStr, 'r')
+    purchasedList = f.readlines()
+    f.close()
+
+    itemSearches = [itemSearch.strip() for itemSearch in itemSearches]
+    itemCounts = dict.fromkeys(itemSearches, 0)
+    for item in purchasedList:
+        item = item.strip()
+        if item in itemCounts:
+            itemCounts[item] += 1
+
+    return [itemCounts[itemSearch] for itemSearch in itemSearches]
+
+"""
+Summarizes the counts already loaded by the C++ engine, through the built-in grocer module (see
+GrocerPyModule.cpp), without reading the input file. Prints the number of purchases, the number
+of distinct items, and the best-selling item. A starting point for analytics that build on the
+engine's counts.
+
+Returns 0, or -1 if the engine hasn't shared any counts.
+"""
+def SummarizeEngineCounts():
+    # Imported here so the rest of this file still works outside the app.
+    import grocer
+
+    try:
+        items = grocer.items()
+        counts = grocer.counts()
+    except RuntimeError:
+        print("No counts loaded yet.")
+        return -1
+
+    if len(items) == 0:
+        print("No purchases in " + grocer.source() + ".")
+        return 0
+
+    bestId = max(range(len(counts)), key = counts.__getitem__)
+    print(str(sum(counts)) + " purchases of " + str(len(items)) + " items in " + grocer.source() + 
+          ". Best seller: " + items[bestId] + " (" + str(counts[bestId]) + ").")
+    return 0